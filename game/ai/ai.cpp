@@ -6,6 +6,7 @@
 #include "../../lib/entity.h"
 #include "../player.h"
 #include "../game.h"
+#include "../util.h"
 #include "../pweapon.h"
 #include "ai.h"
 #include "links.h"
@@ -13,6 +14,9 @@
 #include "navigation.h"
 #include "aiweapons.h"
 #include "aiitem.h"
+#include "aivisibility.h"
+#include "aischedule.h"
+#include <chrono>
 
 cvarref bot_showpath;
 cvarref bot_showcombat;
@@ -23,6 +27,21 @@ nav_data nav;
 
 ai_devel AIDevel;
 
+static dynarray<ai_status> ai_statuses;
+
+//==========================================
+// AI_Status
+// Status of the bot in the given client slot
+//==========================================
+ai_status &AI_Status(const entity &self)
+{
+	// maxclients is latched, so this only happens once
+	if (ai_statuses.size() != game.maxclients)
+		ai_statuses.resize(game.maxclients);
+
+	return ai_statuses[self.s.number - 1];
+}
+
 //==========================================
 // BOT_DMclass_Move
 // DMClass is generic bot class
@@ -135,10 +154,10 @@ static void BOT_DMclass_Move(entity &self, usercmd &ucmd)
  	if(VectorLength(self.g.velocity) < 37)
 	{
 		// Keep a random factor just in case....
-		if(random() > 0.1 && AI_SpecialMove(self, ucmd)) //jumps, crouches, turns...
+		if(rng_bots.random() > 0.1 && AI_SpecialMove(self, ucmd)) //jumps, crouches, turns...
 			return;
 
-		self.s.angles[YAW] += random(-90.f, 90.f);
+		self.s.angles[YAW] += rng_bots.random(-90.f, 90.f);
 
 		AI_ChangeAngle(self);
 
@@ -207,7 +226,7 @@ static void BOT_DMclass_Wander(entity &self, usercmd &ucmd)
 
 	if( gi.pointcontents(temp) & (CONTENTS_LAVA|CONTENTS_SLIME) )
 	{
-		self.s.angles[YAW] += random(-180.f, 180.f);
+		self.s.angles[YAW] += rng_bots.random(-180.f, 180.f);
 		ucmd.forwardmove = 400;
 		if(self.g.groundentity.has_value())
 			ucmd.upmove = 400;
@@ -219,10 +238,10 @@ static void BOT_DMclass_Wander(entity &self, usercmd &ucmd)
 	// Check for special movement
  	if(VectorLength(self.g.velocity) < 37)
 	{
-		if(random() > 0.1 && AI_SpecialMove(self,ucmd))	//jumps, crouches, turns...
+		if(rng_bots.random() > 0.1 && AI_SpecialMove(self,ucmd))	//jumps, crouches, turns...
 			return;
 
-		self.s.angles[YAW] += random(-90.f, 90.f);
+		self.s.angles[YAW] += rng_bots.random(-90.f, 90.f);
  
 		if (!self.g.ai.is_step)// if there is ground continue otherwise wait for next move
 			ucmd.forwardmove = 0; //0
@@ -265,7 +284,7 @@ static void BOT_DMclass_CombatMovement(entity &self, usercmd &ucmd)
 	}
 
 	// Randomly choose a movement direction
-	c = random();
+	c = rng_bots.random();
 
 	if(c < 0.2 && AI_CanMove(self,BOT_MOVE_LEFT))
 		ucmd.sidemove -= 400;
@@ -297,7 +316,7 @@ static bool BOT_DMclass_CheckShot(entity &ent, vector point)
 	start = P_ProjectSource (ent, ent.s.origin, offset, forward, right);
 
 	//bloqued, don't shoot
-	trace tr = gi.trace(start, vec3_origin, vec3_origin, point, ent, MASK_AISOLID);
+	trace tr = gi.trace_cached(start, vec3_origin, vec3_origin, point, ent, MASK_AISOLID);
 
 	if (tr.fraction < 0.3) //just enough to prevent self damage (by now)
 		return false;
@@ -315,11 +334,18 @@ static bool BOT_DMclass_FindEnemy(entity &self)
 	float	bestweight = FLT_MAX;
 	float	weight;
 	vector	dist;
+	const ai_status &status = AI_Status(self);
 
 	// we already set up an enemy this frame (reacting to attacks)
 	if(self.g.enemy.has_value())
 		return true;
 
+	// searching can be put off when over budget, unless we're already fighting
+	const ai_decision decision(self, AI_DECISION_ENEMY, self.g.ai.state == BOT_STATE_ATTACK);
+
+	if (!decision)
+		return false;
+
 	// Find Enemy
 	for (const auto &player : entity_range(1, game.maxclients))
 	{
@@ -327,18 +353,17 @@ static bool BOT_DMclass_FindEnemy(entity &self)
 			continue;
 
 		//Ignore players with 0 weight (was set at botstatus)
-		if(!self.g.ai.status.playersWeights.contains(player.s.number))
+		if(!status.playersWeighted[player.s.number - 1])
 			continue;
 
-		if (!player.g.deadflag && visible(self, player) &&
-			gi.inPVS(self.s.origin, player.s.origin))
+		if (!player.g.deadflag && AI_ClientsVisible(self, player))
 		{
 			//(weight enemies from fusionbot) Is enemy visible, or is it too close to ignore 
 			dist = self.s.origin - player.s.origin;
 			weight = VectorLength( dist );
 
 			//modify weight based on precomputed player weights
-			weight *= (1.0f - self.g.ai.status.playersWeights[player.s.number]);
+			weight *= (1.0f - status.playersWeights[player.s.number - 1]);
 
 			if( infront( self, player ) ||
 				(weight < 300 ) )
@@ -357,9 +382,9 @@ static bool BOT_DMclass_FindEnemy(entity &self)
 	if(bestenemy.has_value())
 	{
 		if (AIDevel.debugChased && bot_showcombat)
-			gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: selected %s as enemy.\n",
-			self.client->g.pers.netname.ptr(),
-			bestenemy->client->g.pers.netname.ptr());
+			G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: selected {} as enemy.\n",
+			self.client->g.pers.netname,
+			bestenemy->client->g.pers.netname);
 
 		self.g.enemy = bestenemy;
 		return true;
@@ -490,8 +515,8 @@ static void BOT_DMclass_FireWeapon(entity &self, usercmd &ucmd)
 	}
 
 	// modify attack angles based on accuracy (mess this up to make the bot's aim not so deadly)
-	target[0] += (random()-0.5f) * ((MAX_BOT_SKILL - self.g.ai.pers.skillLevel) *2);
-	target[1] += (random()-0.5f) * ((MAX_BOT_SKILL - self.g.ai.pers.skillLevel) *2);
+	target[0] += (rng_bots.random()-0.5f) * ((MAX_BOT_SKILL - self.g.ai.pers.skillLevel) *2);
+	target[1] += (rng_bots.random()-0.5f) * ((MAX_BOT_SKILL - self.g.ai.pers.skillLevel) *2);
 
 	// Set direction
 	self.g.ai.move_vector = target - self.s.origin;
@@ -500,7 +525,7 @@ static void BOT_DMclass_FireWeapon(entity &self, usercmd &ucmd)
 
 
 	// Set the attack 
-	firedelay = random()*(MAX_BOT_SKILL*1.8f);
+	firedelay = rng_bots.random()*(MAX_BOT_SKILL*1.8f);
 	if (firedelay > (MAX_BOT_SKILL - self.g.ai.pers.skillLevel) && BOT_DMclass_CheckShot(self, target))
 		ucmd.buttons = BUTTON_ATTACK;
 }
@@ -511,8 +536,10 @@ static void BOT_DMclass_FireWeapon(entity &self, usercmd &ucmd)
 //==========================================
 static void BOT_DMclass_WeightPlayers(entity &self)
 {
+	ai_status &status = AI_Status(self);
+
 	//clear
-	self.g.ai.status.playersWeights.clear();
+	status.playersWeighted.reset();
 
 	for (const auto &player : entity_range(1, game.maxclients))
 	{
@@ -528,14 +555,15 @@ static void BOT_DMclass_WeightPlayers(entity &self)
 			if( player.client.resp.ctf_team != self.client.resp.ctf_team )
 			{
 				//being at enemy team gives a small weight, but weight afterall
-				self.g.ai.status.playersWeights[i] = 0.2;
+				status.playersWeights[player.s.number - 1] = 0.2;
+				status.playersWeighted.set(player.s.number - 1);
 
 				//enemy has redflag
 				if( redflag && player.client->g.pers.inventory[redflag->id]
 					&& (self.client.resp.ctf_team == CTF_TEAM1) )
 				{
 					if( !self.client->g.pers.inventory[blueflag->id] ) //don't hunt if you have the other flag, let others do
-						self.g.ai.status.playersWeights[i] = 0.9;
+						status.playersWeights[player.s.number - 1] = 0.9;
 				}
 				
 				//enemy has blueflag
@@ -543,13 +571,16 @@ static void BOT_DMclass_WeightPlayers(entity &self)
 					&& (self.client.resp.ctf_team == CTF_TEAM2) )
 				{
 					if( !self.client->g.pers.inventory[redflag->id] ) //don't hunt if you have the other flag, let others do
-						self.g.ai.status.playersWeights[i] = 0.9;
+						status.playersWeights[player.s.number - 1] = 0.9;
 				}
 			} 
 		}
 		else	//if not at ctf every player has some value
 #endif
-			self.g.ai.status.playersWeights[player.s.number] = 0.3f;
+		{
+			status.playersWeights[player.s.number - 1] = 0.3f;
+			status.playersWeighted.set(player.s.number - 1);
+		}
 	
 	}
 }
@@ -606,9 +637,10 @@ static void BOT_DMclass_WeightInventory(entity &self)
 {
 	float		LowNeedFactor = 0.5;
 	int			i;
+	ai_status	&status = AI_Status(self);
 
 	//reset with persistant values
-	self.g.ai.status.inventoryWeights = self.g.ai.pers.inventoryWeights;
+	status.inventoryWeights = self.g.ai.pers.inventoryWeights;
 	
 
 	//weight ammo down if bot doesn't have the weapon for it,
@@ -618,58 +650,58 @@ static void BOT_DMclass_WeightInventory(entity &self)
 	//AMMO_BULLETS
 
 	if (!AI_CanPick_Ammo (self, GetItemByIndex(AIWeapons[ITEM_MACHINEGUN].ammoItem)) )
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_MACHINEGUN].ammoItem] = 0.0;
+		status.inventoryWeights[AIWeapons[ITEM_MACHINEGUN].ammoItem] = 0.0;
 	//find out if it has a weapon for this amno
 	else if (!self.client->g.pers.inventory[AIWeapons[ITEM_CHAINGUN].weaponItem]
 		&& !self.client->g.pers.inventory[AIWeapons[ITEM_MACHINEGUN].weaponItem] )
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_MACHINEGUN].ammoItem] *= LowNeedFactor;
+		status.inventoryWeights[AIWeapons[ITEM_MACHINEGUN].ammoItem] *= LowNeedFactor;
 
 	//AMMO_SHELLS:
 
 	//find out if it's packed up
 	if (!AI_CanPick_Ammo (self, GetItemByIndex(AIWeapons[ITEM_SHOTGUN].ammoItem)) )
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_SHOTGUN].ammoItem] = 0.0;
+		status.inventoryWeights[AIWeapons[ITEM_SHOTGUN].ammoItem] = 0.0;
 	//find out if it has a weapon for this amno
 	else if (!self.client->g.pers.inventory[AIWeapons[ITEM_SHOTGUN].weaponItem]
 		&& !self.client->g.pers.inventory[AIWeapons[ITEM_SUPER_SHOTGUN].weaponItem] )
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_SHOTGUN].ammoItem] *= LowNeedFactor;
+		status.inventoryWeights[AIWeapons[ITEM_SHOTGUN].ammoItem] *= LowNeedFactor;
 
 	//AMMO_ROCKETS:
 
 	//find out if it's packed up
 	if (!AI_CanPick_Ammo (self, GetItemByIndex(AIWeapons[ITEM_ROCKET_LAUNCHER].ammoItem)))
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_ROCKET_LAUNCHER].ammoItem] = 0.0;
+		status.inventoryWeights[AIWeapons[ITEM_ROCKET_LAUNCHER].ammoItem] = 0.0;
 	//find out if it has a weapon for this amno
 	else if (!self.client->g.pers.inventory[AIWeapons[ITEM_ROCKET_LAUNCHER].weaponItem] )
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_ROCKET_LAUNCHER].ammoItem] *= LowNeedFactor;
+		status.inventoryWeights[AIWeapons[ITEM_ROCKET_LAUNCHER].ammoItem] *= LowNeedFactor;
 
 	//AMMO_GRENADES: 
 
 	//find if it's packed up
 	if (!AI_CanPick_Ammo (self, GetItemByIndex(AIWeapons[ITEM_GRENADES].ammoItem)))
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_GRENADES].ammoItem] = 0.0;
+		status.inventoryWeights[AIWeapons[ITEM_GRENADES].ammoItem] = 0.0;
 	//grenades are also weapons, and are weighted down by LowNeedFactor in weapons group
 	
 	//AMMO_CELLS:
 
 	//find out if it's packed up
 	if (!AI_CanPick_Ammo (self, GetItemByIndex(AIWeapons[ITEM_HYPERBLASTER].ammoItem)))
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_HYPERBLASTER].ammoItem] = 0.0;
+		status.inventoryWeights[AIWeapons[ITEM_HYPERBLASTER].ammoItem] = 0.0;
 	//find out if it has a weapon for this amno
 	else if (!self.client->g.pers.inventory[AIWeapons[ITEM_HYPERBLASTER].weaponItem]
 		&& !self.client->g.pers.inventory[AIWeapons[ITEM_BFG].weaponItem]
 		&& !self.client->g.pers.inventory[ITEM_POWER_SHIELD]
 		&& !self.client->g.pers.inventory[ITEM_POWER_SCREEN])
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_HYPERBLASTER].ammoItem] *= LowNeedFactor;
+		status.inventoryWeights[AIWeapons[ITEM_HYPERBLASTER].ammoItem] *= LowNeedFactor;
 
 	//AMMO_SLUGS:
 
 	//find out if it's packed up
 	if (!AI_CanPick_Ammo (self, GetItemByIndex(AIWeapons[ITEM_RAILGUN].ammoItem)))
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_RAILGUN].ammoItem] = 0.0;
+		status.inventoryWeights[AIWeapons[ITEM_RAILGUN].ammoItem] = 0.0;
 	//find out if it has a weapon for this amno
 	else if (!self.client->g.pers.inventory[AIWeapons[ITEM_RAILGUN].weaponItem] )
-		self.g.ai.status.inventoryWeights[AIWeapons[ITEM_RAILGUN].ammoItem] *= LowNeedFactor;
+		status.inventoryWeights[AIWeapons[ITEM_RAILGUN].ammoItem] *= LowNeedFactor;
 
 
 	//WEAPONS
@@ -678,18 +710,18 @@ static void BOT_DMclass_WeightInventory(entity &self)
 	//weight weapon down if bot already has it
 	for (i=ITEM_WEAPONS_FIRST; i<=ITEM_WEAPONS_LAST; i++)
 		if ( AIWeapons[i].weaponItem && self.client->g.pers.inventory[AIWeapons[i].weaponItem])
-			self.g.ai.status.inventoryWeights[AIWeapons[i].weaponItem] *= LowNeedFactor;
+			status.inventoryWeights[AIWeapons[i].weaponItem] *= LowNeedFactor;
 
 	//ARMOR
 	//-----------------------------------------------------
 	if (!AI_CanUseArmor (GetItemByIndex(ITEM_ARMOR_JACKET), self ))
-		self.g.ai.status.inventoryWeights[ITEM_ARMOR_JACKET] = 0.0;
+		status.inventoryWeights[ITEM_ARMOR_JACKET] = 0.0;
 
 	if (!AI_CanUseArmor ( GetItemByIndex(ITEM_ARMOR_COMBAT), self ))
-		self.g.ai.status.inventoryWeights[ITEM_ARMOR_COMBAT] = 0.0;
+		status.inventoryWeights[ITEM_ARMOR_COMBAT] = 0.0;
 
 	if (!AI_CanUseArmor ( GetItemByIndex(ITEM_ARMOR_BODY), self ))
-		self.g.ai.status.inventoryWeights[ITEM_ARMOR_BODY] = 0.0;
+		status.inventoryWeights[ITEM_ARMOR_BODY] = 0.0;
 
 #ifdef CTF
 	//TECH :
@@ -699,10 +731,10 @@ static void BOT_DMclass_WeightInventory(entity &self)
 		|| self.client->pers.inventory[ITEM_TECH3] 
 		|| self.client->pers.inventory[ITEM_TECH4] )
 	{
-		self.g.ai.status.inventoryWeights[ITEM_TECH1] = 0.0; 
-		self.g.ai.status.inventoryWeights[ITEM_TECH2] = 0.0; 
-		self.g.ai.status.inventoryWeights[ITEM_TECH3] = 0.0;
-		self.g.ai.status.inventoryWeights[ITEM_TECH4] = 0.0;
+		status.inventoryWeights[ITEM_TECH1] = 0.0; 
+		status.inventoryWeights[ITEM_TECH2] = 0.0; 
+		status.inventoryWeights[ITEM_TECH3] = 0.0;
+		status.inventoryWeights[ITEM_TECH4] = 0.0;
 	}
 
 	//CTF: 
@@ -713,9 +745,9 @@ static void BOT_DMclass_WeightInventory(entity &self)
 		
 		//flags have weights defined inside persistant inventory. Remove weight from the unwanted one/s.
 		if (blueflag && blueflag != wantedFlag)
-			self.g.ai.status.inventoryWeights[blueflag->id] = 0.0;
+			status.inventoryWeights[blueflag->id] = 0.0;
 		else if (redflag && redflag != wantedFlag)
-			self.g.ai.status.inventoryWeights[redflag->id] = 0.0;
+			status.inventoryWeights[redflag->id] = 0.0;
 	}
 #endif
 }
@@ -734,13 +766,19 @@ static void BOT_DMclass_UpdateStatus( entity &self )
 	self.client->ps.pmove.set_delta_angles(vec3_origin);
 
 	if (self.client->ps.pmove.pm_flags & PMF_TIME_TELEPORT)
-		self.g.ai.status.TeleportReached = true;
+		AI_Status(self).TeleportReached = true;
 	else
-		self.g.ai.status.TeleportReached = false;
+		AI_Status(self).TeleportReached = false;
+
+	//set up AI status for the upcoming AI_frame; if it's
+	//put off, the last weights stand until then
+	const ai_decision decision(self, AI_DECISION_WEIGHTS);
 
-	//set up AI status for the upcoming AI_frame
-	BOT_DMclass_WeightInventory( self );	//weight items
-	BOT_DMclass_WeightPlayers( self );		//weight players
+	if (decision)
+	{
+		BOT_DMclass_WeightInventory( self );	//weight items
+		BOT_DMclass_WeightPlayers( self );		//weight players
+	}
 }
 
 //==========================================
@@ -876,4 +914,96 @@ void BOT_DMclass_InitPersistant(entity &self)
 }
 
 
+//==========================================
+// AI_BenchmarkStatus
+// Times the player weight and bot roam timeout bookkeeping
+// of a status update against the hashed tables it replaced
+//==========================================
+void AI_BenchmarkStatus(size_t passes)
+{
+	const size_t num_players = game.maxclients;
+	const size_t num_broams = clamp((size_t)16, nav.broams.size(), MAX_BOT_ROAMS);
+	float sum_hashed = 0, sum_dense = 0;
+
+	map<int32_t, float> hashed_weights;
+	map<uint32_t, gtime> hashed_timeouts;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (gtime pass = 0; pass < passes; pass++)
+	{
+		// every fourth player is ignored, like spectators and the dead
+		hashed_weights.clear();
+
+		for (int32_t i = 1; i <= (int32_t)num_players; i++)
+			if (i % 4)
+				hashed_weights[i] = 0.3f;
+
+		for (int32_t i = 1; i <= (int32_t)num_players; i++)
+			if (hashed_weights.contains(i))
+				sum_hashed += hashed_weights[i];
+
+		for (uint32_t b = 0; b < num_broams; b++)
+		{
+			if (hashed_timeouts.contains(b))
+			{
+				if (hashed_timeouts[b] > pass)
+					continue;
+
+				hashed_timeouts.erase(b);
+			}
+
+			if (b % 3 == 0)
+				hashed_timeouts[b] = pass + 2;
+		}
+	}
+
+	const double hashed_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / passes;
+
+	dynarray<ai_status> dense(1);
+	ai_status &status = dense[0];
+
+	start = std::chrono::steady_clock::now();
+
+	for (gtime pass = 0; pass < passes; pass++)
+	{
+		status.playersWeighted.reset();
+
+		for (size_t i = 0; i < num_players; i++)
+			if ((i + 1) % 4)
+			{
+				status.playersWeights[i] = 0.3f;
+				status.playersWeighted.set(i);
+			}
+
+		for (size_t i = 0; i < num_players; i++)
+			if (status.playersWeighted[i])
+				sum_dense += status.playersWeights[i];
+
+		for (size_t b = 0; b < num_broams; b++)
+		{
+			if (status.broam_timeouts[b])
+			{
+				if (status.broam_timeout_framenums[b] > pass)
+					continue;
+
+				status.broam_timeouts.reset(b);
+			}
+
+			if (b % 3 == 0)
+			{
+				status.broam_timeout_framenums[b] = pass + 2;
+				status.broam_timeouts.set(b);
+			}
+		}
+	}
+
+	const double dense_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / passes;
+
+	gi.dprintf("%u players, %u bot roams, %u passes\n", (uint32_t)num_players, (uint32_t)num_broams, (uint32_t)passes);
+	gi.dprintf("hashed: %.3f us per update (checksum %.1f)\n", hashed_time * 1e6, sum_hashed);
+	gi.dprintf("dense:  %.3f us per update (checksum %.1f)\n", dense_time * 1e6, sum_dense);
+	gi.dprintf("speedup: %.1fx\n", dense_time > 0 ? hashed_time / dense_time : 0.0);
+}
+
 #endif
\ No newline at end of file
@@ -3,8 +3,12 @@
 #include "../../lib/types.h"
 #include "../../lib/map.h"
 #include "../../lib/cvar.h"
+#include "../../lib/config_string.h"
 #include "../itemlist.h"
 #include "astar.h"
+#include <bitset>
+
+constexpr size_t MAX_BOT_ROAMS = 128;
 
 struct ai_status
 {
@@ -12,10 +16,22 @@ struct ai_status
 	bool	TeleportReached;
 
 	array<float, ITEM_TOTAL>	inventoryWeights;
-	map<int32_t, float>			playersWeights;
-	map<uint32_t, gtime>		broam_timeout_framenums;	//revisit bot roams
+
+	// weights of other players by client slot; players
+	// without their bit set are ignored altogether
+	array<float, MAX_CLIENTS>		playersWeights;
+	std::bitset<MAX_CLIENTS>		playersWeighted;
+
+	// frame each bot roam can be revisited on, by broam index;
+	// only those with their bit set are timed out
+	array<gtime, MAX_BOT_ROAMS>		broam_timeout_framenums;	//revisit bot roams
+	std::bitset<MAX_BOT_ROAMS>		broam_timeouts;
 };
 
+// bot status is kept by client slot rather than in every entity,
+// since the tables above are bigger than an entity is.
+ai_status &AI_Status(const entity &self);
+
 constexpr int MAX_BOT_SKILL = 5;		//skill levels graduation
 
 using ai_func = void(*)(entity &);
@@ -47,7 +63,6 @@ enum ai_state : uint8_t
 struct ai_t
 {
 	ai_pers		pers;			//persistant definition (class?)
-	ai_status	status;			//player (bot, NPC) status for AI frame
 
 	//NPC state
 	ai_state	state;			// Bot State (WANDER, MOVE, etc)
@@ -132,6 +147,10 @@ extern cvarref bot_showpath;
 extern cvarref bot_showcombat;
 extern cvarref bot_showsrgoal;
 extern cvarref bot_showlrgoal;
+extern cvarref bot_vis_frames;
+extern cvarref bot_vis_matrix;
+extern cvarref bot_think_budget;
+extern cvarref bot_max_latency;
 
 struct ai_devel
 {
@@ -147,3 +166,6 @@ struct ai_devel
 extern ai_devel AIDevel;
 
 void BOT_DMclass_InitPersistant(entity &self);
+
+// time a bot status update's bookkeeping against the hashed tables it replaced
+void AI_BenchmarkStatus(size_t passes);
@@ -4,6 +4,9 @@
 
 #include "../../lib/gi.h"
 #include "aispawn.h"
+#include "ai.h"
+#include "aivisibility.h"
+#include "aischedule.h"
 
 //==========================================
 // BOT_ServerCommand
@@ -17,6 +20,12 @@ bool BOT_ServerCommand()
 		BOT_SpawnBot (gi.argv(2), gi.argv(3), gi.argv(4), nullptr);
     else if(cmd == "removebot")
     	BOT_RemoveBot(gi.argv(2));
+	else if (cmd == "botvis")
+		AI_VisibilityStats();
+	else if (cmd == "botsched")
+		AI_ScheduleStats();
+	else if (cmd == "botbench")
+		AI_BenchmarkStatus(gi.argc() > 2 ? max(1, atoi(gi.argv(2))) : 10000);
    /*
 	else if( !Q_stricmp (cmd, "editnodes") )
 		AITools_InitEditnodes();
@@ -83,7 +83,7 @@ float AI_ItemWeight(entity &self, entity &it)
 		| IT_FLAG
 #endif
 		))
-		return self.g.ai.status.inventoryWeights[it.g.item->id];
+		return AI_Status(self).inventoryWeights[it.g.item->id];
 
 	// IT_HEALTH
 	if (it.g.item->flags & IT_HEALTH)
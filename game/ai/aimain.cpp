@@ -11,6 +11,9 @@
 #include "movement.h"
 #include "aiweapons.h"
 #include "aiitem.h"
+#include "aivisibility.h"
+#include "aischedule.h"
+#include "../profile.h"
 
 //==========================================
 // AI_Init
@@ -23,6 +26,17 @@ void AI_Init()
 	bot_showcombat = gi.cvar("bot_showcombat", "0", CVAR_SERVERINFO);
 	bot_showsrgoal = gi.cvar("bot_showsrgoal", "0", CVAR_SERVERINFO);
 	bot_showlrgoal = gi.cvar("bot_showlrgoal", "0", CVAR_SERVERINFO);
+
+	// how many frames bots share a visibility result before re-tracing it;
+	// at 2 a bot can react to a client one frame late
+	bot_vis_frames = gi.cvar("bot_vis_frames", "2", CVAR_NONE);
+	// 0 goes back to tracing every query, to measure what the matrix saves
+	bot_vis_matrix = gi.cvar("bot_vis_matrix", "1", CVAR_NONE);
+
+	// milliseconds per frame bots can spend on expensive decisions, and
+	// the most frames one can be put off for; a budget of 0 disables it
+	bot_think_budget = gi.cvar("bot_think_budget", "0", CVAR_NONE);
+	bot_max_latency = gi.cvar("bot_max_latency", "5", CVAR_NONE);
 }
 
 //==========================================
@@ -34,6 +48,8 @@ void AI_NewMap()
 	//Load nodes
 	AI_InitNavigationData();
 	AI_InitAIWeapons ();
+	AI_ResetVisibility();
+	AI_ResetSchedule();
 	AIDevel = {};
 }
 
@@ -62,7 +78,7 @@ void AI_SetUpMoveWander(entity &ent)
 void AI_ResetWeights(entity &ent)
 {
 	//restore defaults from bot persistant
-	ent.g.ai.status.inventoryWeights = ent.g.ai.pers.inventoryWeights;
+	AI_Status(ent).inventoryWeights = ent.g.ai.pers.inventoryWeights;
 }
 
 
@@ -90,7 +106,7 @@ void AI_ResetNavigation(entity &ent)
 	ent.g.ai.move_vector = vec3_origin;
 
 	//reset bot_roams timeouts
-	ent.g.ai.status.broam_timeout_framenums.clear();
+	AI_Status(ent).broam_timeouts.reset();
 }
 
 //==========================================
@@ -103,17 +119,24 @@ bool AI_BotRoamForLRGoal(entity &self, node_id current_node)
 	float	best_weight = 0.0;
 	node_id	goal_node = NODE_INVALID;
 	uint32_t best_broam = (uint32_t)-1;
+	ai_status &status = AI_Status(self);
+	static dynarray<uint32_t> candidates;
+	static dynarray<node_id> nodes;
+	static dynarray<float> costs;
+
+	candidates.clear();
+	nodes.clear();
 
 	for (const auto &broam : nav.broams)
 	{
 		const uint32_t broam_index = &broam - nav.broams.data();
 
-		if (self.g.ai.status.broam_timeout_framenums.contains(broam_index))
+		if (status.broam_timeouts[broam_index])
 		{
-			if (self.g.ai.status.broam_timeout_framenums[broam_index] > level.framenum)
+			if (status.broam_timeout_framenums[broam_index] > level.framenum)
 				continue;
 
-			self.g.ai.status.broam_timeout_framenums.erase(broam_index);
+			status.broam_timeouts.reset(broam_index);
 		}
 
 		//limit cost finding by distance
@@ -123,12 +146,23 @@ bool AI_BotRoamForLRGoal(entity &self, node_id current_node)
 		if(dist > 10000)
 			continue;
 
-		//find cost
-		float cost = AI_FindCost(current_node, broam.node, self.g.ai.pers.moveTypesMask);
-		if (cost == NODE_INVALID || cost < 3) // ignore invalid and very short hops
+		candidates.push_back(broam_index);
+		nodes.push_back(broam.node);
+	}
+
+	//find all costs at once
+	AI_FindCosts(current_node, nodes, self.g.ai.pers.moveTypesMask, costs);
+
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		const uint32_t broam_index = candidates[i];
+		const nav_broam &broam = nav.broams[broam_index];
+		float cost = costs[i];
+
+		if (cost < 3) // ignore invalid and very short hops
 			continue;
 
-		cost *= random(); // Allow random variations for broams
+		cost *= rng_bots.random(); // Allow random variations for broams
 		float weight = broam.weight / cost;	// Check against cost of getting there
 
 		if (weight > best_weight)
@@ -147,7 +181,7 @@ bool AI_BotRoamForLRGoal(entity &self, node_id current_node)
 	self.g.ai.tries = 0;	// Reset the count of how many times we tried this goal
 
 	if (AIDevel.debugChased && bot_showlrgoal)
-		gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: selected a bot roam of weight %f at node %d for LR goal.\n", self.client->g.pers.netname.ptr(), nav.broams[best_broam].weight, goal_node);
+		G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: selected a bot roam of weight {:f} at node {} for LR goal.\n", self.client->g.pers.netname, nav.broams[best_broam].weight, goal_node);
 
 	AI_SetGoal(self, goal_node);
 	return true;
@@ -165,6 +199,20 @@ bool AI_BotRoamForLRGoal(entity &self, node_id current_node)
 //==========================================
 void AI_PickLongRangeGoal(entity &self)
 {
+	PROFILE_ZONE("AI_PickLongRangeGoal");
+
+	const ai_decision decision(self, AI_DECISION_LRGOAL);
+
+	// put off for now; wander and ask again next think
+	if (!decision)
+	{
+		if (self.g.ai.state != BOT_STATE_WANDER)
+			AI_SetUpMoveWander(self);
+
+		self.g.ai.wander_timeout_framenum = level.framenum - 1;
+		return;
+	}
+
 	float	best_weight=0.0;
 	node_id	goal_node = NODE_INVALID;
 	entityref goal_ent;
@@ -175,7 +223,7 @@ void AI_PickLongRangeGoal(entity &self)
 
 	if (current_node == NODE_INVALID)	//failed. Go wandering :(
 	{
-		gi.dprintf("%s: LRGOAL: Closest node not found. Tries:%i\n", self.client->g.pers.netname.ptr(), self.g.ai.nearest_node_tries);
+		G_DevPrint("{}: LRGOAL: Closest node not found. Tries:{}\n", self.client->g.pers.netname, self.g.ai.nearest_node_tries);
 
 		if (self.g.ai.state != BOT_STATE_WANDER)
 			AI_SetUpMoveWander( self );
@@ -187,6 +235,23 @@ void AI_PickLongRangeGoal(entity &self)
 
 	self.g.ai.nearest_node_tries = 0;
 
+	// gather everything worth going for, then cost them all in one search
+	struct lr_goal
+	{
+		node_id		node;
+		float		weight;
+		entityref	ent;
+		// anything this close isn't worth the trip
+		float		min_cost;
+	};
+
+	static dynarray<lr_goal> goals;
+	static dynarray<node_id> nodes;
+	static dynarray<float> costs;
+
+	goals.clear();
+	nodes.clear();
+
 	// Items
 	for (const auto &it : nav.items)
 	{
@@ -232,22 +297,13 @@ void AI_PickLongRangeGoal(entity &self)
 			)) && dist > 10000)
 			continue;
 
-		float cost = AI_FindCost(current_node, it.node, self.g.ai.pers.moveTypesMask);
-		if (cost == NODE_INVALID || cost < 3) // ignore invalid and very short hops
-			continue;
-
-		//weight *= random(); // Allow random variations
-		weight /= cost; // Check against cost of getting there
-
-		if(weight > best_weight)
-		{
-			best_weight = weight;
-			goal_node = it.node;
-			goal_ent = it.ent;
-		}
+		goals.push_back({ it.node, weight, it.ent, 3 });
+		nodes.push_back(it.node);
 	}
 
 	// Players: This should be its own function and is for now just finds a player to set as the goal.
+	const ai_status &status = AI_Status(self);
+
 	for (auto &player : entity_range(1, game.maxclients))
 	{
 		//ignore self & spectators
@@ -255,26 +311,33 @@ void AI_PickLongRangeGoal(entity &self)
 			continue;
 
 		//ignore zero weighted players
-		if (!self.g.ai.status.playersWeights.contains(player.s.number))
+		if (!status.playersWeighted[player.s.number - 1])
 			continue;
 
 		node_id node = AI_FindClosestReachableNode(player.s.origin, player, NODE_DENSITY, NODE_ALL);
-		float cost = AI_FindCost(current_node, node, self.g.ai.pers.moveTypesMask);
-
-		if(cost == NODE_INVALID || cost < 4) // ignore invalid and very short hops
-			continue;
 
 		//precomputed player weights
-		float weight = self.g.ai.status.playersWeights[player.s.number];
+		goals.push_back({ node, status.playersWeights[player.s.number - 1], player, 4 });
+		nodes.push_back(node);
+	}
+
+	AI_FindCosts(current_node, nodes, self.g.ai.pers.moveTypesMask, costs);
+
+	for (size_t i = 0; i < goals.size(); i++)
+	{
+		const lr_goal &goal = goals[i];
+
+		if (costs[i] < goal.min_cost) // ignore invalid and very short hops
+			continue;
 
 		//weight *= random(); // Allow random variations
-		weight /= cost; // Check against cost of getting there
+		float weight = goal.weight / costs[i]; // Check against cost of getting there
 
 		if(weight > best_weight)
-		{		
+		{
 			best_weight = weight;
-			goal_node = node;
-			goal_ent = player;
+			goal_node = goal.node;
+			goal_ent = goal.ent;
 		}
 	}
 
@@ -287,7 +350,7 @@ void AI_PickLongRangeGoal(entity &self)
 			self.g.ai.goal_node = NODE_INVALID;
 			self.g.ai.state = BOT_STATE_WANDER;
 			self.g.ai.wander_timeout_framenum = level.framenum + (gtime)(1.0 * BASE_FRAMERATE);
-			gi.dprintf( "%s: did not find a LR goal, wandering.\n",self.client->g.pers.netname.ptr());
+			G_DevPrint("{}: did not find a LR goal, wandering.\n", self.client->g.pers.netname);
 		}
 		return; // no path?
 	}
@@ -297,7 +360,7 @@ void AI_PickLongRangeGoal(entity &self)
 	self.g.ai.tries = 0;	// Reset the count of how many times we tried this goal
 
 	if (goal_ent.has_value())
-		gi.dprintf( "%s: selected a %i at node %d for LR goal.\n",self.client->g.pers.netname.ptr(), goal_ent->g.type, goal_node);
+		G_DevPrint("{}: selected a {} at node {} for LR goal.\n", self.client->g.pers.netname, (int32_t)goal_ent->g.type, goal_node);
 
 	AI_SetGoal(self,goal_node);
 }
@@ -311,6 +374,8 @@ void AI_PickLongRangeGoal(entity &self)
 //==========================================
 void AI_PickShortRangeGoal(entity &self)
 {
+	PROFILE_ZONE("AI_PickShortRangeGoal");
+
 	float		weight, best_weight=0.0;
 	entityref	best = 0;
 
@@ -326,10 +391,10 @@ void AI_PickShortRangeGoal(entity &self)
 		if(target->g.type == ET_ROCKET || target->g.type == ET_GRENADE || target->g.type == ET_HANDGRENADE)
 		{
 			//if player who shoot is a potential enemy
-			if (self.g.ai.status.playersWeights.contains(target->owner->s.number))
+			if (target->owner.has_value() && target->owner->is_client() && AI_Status(self).playersWeighted[target->owner->s.number - 1])
 			{
 				if(AIDevel.debugChased && bot_showcombat)
-					gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: ROCKET ALERT!\n", self.client->g.pers.netname.ptr());
+					G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: ROCKET ALERT!\n", self.client->g.pers.netname);
 				
 				self.g.enemy = target->owner;	// set who fired the rocket as enemy
 				return;
@@ -359,7 +424,7 @@ void AI_PickShortRangeGoal(entity &self)
 		self.g.movetarget = best;
 		self.g.goalentity = best;
 		if(AIDevel.debugChased && bot_showsrgoal && (self.g.goalentity != self.g.movetarget))
-			gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: selected a %i for SR goal.\n",self.client->g.pers.netname.ptr(), self.g.movetarget->g.type);
+			G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: selected a {} for SR goal.\n", self.client->g.pers.netname, (int32_t)self.g.movetarget->g.type);
 	}
 }
 
@@ -424,6 +489,8 @@ inline void AI_CategorizePosition(entity &ent)
 //==========================================
 void AI_Think(entity &self)
 {
+	PROFILE_ZONE("AI_Think");
+
 	//AIDebug_SetChased(self);	//jal:debug shit
 	AI_CategorizePosition(self);
 
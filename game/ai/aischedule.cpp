@@ -0,0 +1,185 @@
+#include "../../lib/types.h"
+
+#ifdef BOTS
+
+#include "../../lib/gi.h"
+#include "../../lib/entity.h"
+#include "../game.h"
+#include "ai.h"
+#include "aischedule.h"
+#include <chrono>
+
+cvarref bot_think_budget;
+cvarref bot_max_latency;
+
+constexpr stringlit ai_decision_names[AI_DECISION_TOTAL] = {
+	"long range goal",
+	"weights",
+	"enemy search"
+};
+
+// share of the budget requests get on the frame they're made
+constexpr double AI_FRESH_BUDGET_SHARE = 0.5;
+
+struct ai_decision_stats
+{
+	uint64_t	requested, run, deferred, forced;
+	// running average of a decision's cost, in ns
+	double		average_ns;
+	gtime		max_latency;
+};
+
+static struct
+{
+	// frame the spent time belongs to
+	gtime	framenum;
+	int64_t	spent_ns;
+
+	// frame each client's request was first put off, or 0
+	array<array<gtime, AI_DECISION_TOTAL>, MAX_CLIENTS>	pending;
+	// frame each client last made each request
+	array<array<gtime, AI_DECISION_TOTAL>, MAX_CLIENTS>	asked;
+
+	array<ai_decision_stats, AI_DECISION_TOTAL>	stats;
+	uint64_t	frames, over_budget_frames;
+	int64_t		max_spent_ns;
+} ai_schedule;
+
+static int64_t AI_ScheduleClock()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//==========================================
+// AI_ScheduleFrame
+// Start a new frame's budget if we've moved on
+//==========================================
+static void AI_ScheduleFrame()
+{
+	if (level.framenum == ai_schedule.framenum)
+		return;
+
+	if (ai_schedule.frames)
+	{
+		const int64_t budget_ns = (int64_t)(bot_think_budget.value * 1e6);
+
+		if (budget_ns > 0 && ai_schedule.spent_ns > budget_ns)
+			ai_schedule.over_budget_frames++;
+
+		ai_schedule.max_spent_ns = max(ai_schedule.max_spent_ns, ai_schedule.spent_ns);
+
+		// a request put off and then not made again on the frame that
+		// just ended is no longer waiting; if it comes back, it's a
+		// fresh one. frames with no requests at all aren't seen here,
+		// so after a gap nothing is still waiting.
+		const bool consecutive = level.framenum == ai_schedule.framenum + 1;
+
+		for (uint32_t i = 0; i < game.maxclients; i++)
+			for (size_t t = 0; t < AI_DECISION_TOTAL; t++)
+				if (!consecutive || ai_schedule.asked[i][t] != ai_schedule.framenum)
+					ai_schedule.pending[i][t] = 0;
+	}
+
+	ai_schedule.framenum = level.framenum;
+	ai_schedule.spent_ns = 0;
+	ai_schedule.frames++;
+}
+
+ai_decision::ai_decision(const entity &self, ai_decision_type type, bool urgent) :
+	slot(self.s.number - 1),
+	type(type)
+{
+	AI_ScheduleFrame();
+
+	ai_decision_stats &stats = ai_schedule.stats[type];
+	gtime &pending = ai_schedule.pending[slot][type];
+	const int64_t budget_ns = (int64_t)(bot_think_budget.value * 1e6);
+	const gtime waited = pending ? level.framenum - pending : 0;
+
+	stats.requested++;
+	ai_schedule.asked[slot][type] = level.framenum;
+
+	if (budget_ns <= 0 || urgent)
+		allowed = true;
+	else if (waited >= (gtime)max(1, (int32_t)bot_max_latency))
+	{
+		allowed = true;
+		stats.forced++;
+	}
+	else
+	{
+		// fresh requests leave room for the ones that have been waiting
+		const double share = waited ? 1.0 : AI_FRESH_BUDGET_SHARE;
+		allowed = ai_schedule.spent_ns + stats.average_ns <= budget_ns * share;
+	}
+
+	if (!allowed)
+	{
+		if (!pending)
+			pending = level.framenum;
+
+		stats.deferred++;
+		return;
+	}
+
+	stats.run++;
+	stats.max_latency = max(stats.max_latency, waited);
+	pending = 0;
+	start = AI_ScheduleClock();
+}
+
+ai_decision::~ai_decision()
+{
+	if (!allowed)
+		return;
+
+	const int64_t elapsed = AI_ScheduleClock() - start;
+	ai_decision_stats &stats = ai_schedule.stats[type];
+
+	ai_schedule.spent_ns += elapsed;
+	stats.average_ns = stats.run == 1 ? elapsed : stats.average_ns + (elapsed - stats.average_ns) * 0.1;
+}
+
+//==========================================
+// AI_ResetSchedule
+//==========================================
+void AI_ResetSchedule()
+{
+	for (auto &slot : ai_schedule.pending)
+		slot.fill(0);
+	for (auto &slot : ai_schedule.asked)
+		slot.fill(0);
+
+	ai_schedule.stats = {};
+	ai_schedule.framenum = level.framenum;
+	ai_schedule.spent_ns = ai_schedule.max_spent_ns = 0;
+	ai_schedule.frames = ai_schedule.over_budget_frames = 0;
+}
+
+//==========================================
+// AI_ScheduleStats
+//==========================================
+void AI_ScheduleStats()
+{
+	if (!ai_schedule.frames)
+	{
+		gi.dprintf("botsched: no decisions yet\n");
+		return;
+	}
+
+	const double frames = (double)ai_schedule.frames;
+
+	gi.dprintf("%u frames, budget %.2f ms, max latency %i frame(s)\n", (uint32_t)ai_schedule.frames, bot_think_budget.value, max(1, (int32_t)bot_max_latency));
+	gi.dprintf("worst frame %.3f ms, %u frame(s) over budget\n", ai_schedule.max_spent_ns / 1e6, (uint32_t)ai_schedule.over_budget_frames);
+	gi.dprintf("%-16s %9s %9s %9s %9s %9s %7s\n", "decision", "requests", "run", "deferred", "forced", "avg us", "latency");
+
+	for (size_t i = 0; i < AI_DECISION_TOTAL; i++)
+	{
+		const ai_decision_stats &stats = ai_schedule.stats[i];
+
+		gi.dprintf("%-16s %9.1f %9.1f %9.1f %9.1f %9.1f %7u\n", ai_decision_names[i], stats.requested / frames, stats.run / frames,
+			stats.deferred / frames, stats.forced / frames, stats.average_ns / 1e3, (uint32_t)stats.max_latency);
+	}
+}
+
+#endif
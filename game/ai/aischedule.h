@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../../lib/types.h"
+
+/*
+==============
+bot decision scheduling
+
+The expensive parts of a bot's think are spread across frames under a
+per-frame time budget (bot_think_budget, in milliseconds). Fresh requests
+only get part of the budget, requests that were already put off get the
+rest, and nothing waits longer than bot_max_latency frames: a request that
+old runs even if it blows the budget. The budget defaults to 0, which
+runs everything when asked as it used to; servers that want the smoother
+frame times opt in with something like "bot_think_budget 2".
+==============
+*/
+
+enum ai_decision_type : uint8_t
+{
+	AI_DECISION_LRGOAL,
+	AI_DECISION_WEIGHTS,
+	AI_DECISION_ENEMY,
+
+	AI_DECISION_TOTAL
+};
+
+// a scheduled decision. check it before doing the work; the
+// time until it goes out of scope is charged to the frame.
+class ai_decision
+{
+	const uint32_t			slot;
+	const ai_decision_type	type;
+	bool					allowed;
+	int64_t					start;
+
+public:
+	// urgent decisions always run, but are still charged
+	ai_decision(const entity &self, ai_decision_type type, bool urgent = false);
+	~ai_decision();
+
+	explicit operator bool() const { return allowed; }
+};
+
+// forget pending requests and stats; called on map change
+void AI_ResetSchedule();
+
+// print the scheduler's stats
+void AI_ScheduleStats();
@@ -55,7 +55,7 @@ static string BOT_SetName(entity &bot, stringref name, stringref skin, stringref
 	stringref bot_name = name ? name : (stringref)va("Bot%d", bot.g.count);
 
 	// skin
-	string bot_skin = skin ? skin : bot_skins[Q_rand_uniform(lengthof(bot_skins))];
+	string bot_skin = skin ? skin : bot_skins[rng_bots.uniform(lengthof(bot_skins))];
 
 	// initialise userinfo
 	return strconcat("\\name\\", bot_name, "\\skin\\", bot_skin, "\\hand\\2");
@@ -80,6 +80,10 @@ void BOT_SpawnBot(stringref team, stringref name, stringref skin, string userinf
 		return;
 	}
 
+	// the slot's status may be left over from whoever had it last
+	entity &bot_ent = bot;
+	AI_Status(bot_ent) = {};
+
 	//init the bot
 	bot->g.ai.is_bot = true;
 	bot->g.yaw_speed = 100;
@@ -92,7 +96,7 @@ void BOT_SpawnBot(stringref team, stringref name, stringref skin, string userinf
 	
 	ClientBegin(bot);
 
-	bot->g.ai.pers.skillLevel = Q_rand_uniform(MAX_BOT_SKILL);
+	bot->g.ai.pers.skillLevel = rng_bots.uniform(MAX_BOT_SKILL);
 
 	bot->g.think = AI_Think;
 	bot->g.nextthink = level.framenum + 1;
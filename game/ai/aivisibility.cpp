@@ -0,0 +1,131 @@
+#include "../../lib/types.h"
+
+#ifdef BOTS
+
+#include "../../lib/gi.h"
+#include "../../lib/entity.h"
+#include "../game.h"
+#include "../util.h"
+#include "ai.h"
+#include "aivisibility.h"
+#include <bitset>
+
+cvarref bot_vis_frames;
+cvarref bot_vis_matrix;
+
+// symmetric matrix of client pairs. a pair is only traced when either
+// side asks about it, so clients nobody looks for cost nothing, and the
+// answer is kept for bot_vis_frames frames.
+static struct
+{
+	// frame of the last query, for counting frames with queries
+	gtime	queryframe;
+
+	array<std::bitset<MAX_CLIENTS>, MAX_CLIENTS>	known, visible;
+	// frame each pair was traced; a pair's first stamp is backdated by
+	// up to bot_vis_frames - 1 so pairs don't all expire together
+	array<array<gtime, MAX_CLIENTS>, MAX_CLIENTS>	traced;
+
+	uint64_t	frames, queries, traces;
+} ai_vis;
+
+//==========================================
+// AI_CountVisibilityFrame
+//==========================================
+static void AI_CountVisibilityFrame()
+{
+	if (level.framenum == ai_vis.queryframe)
+		return;
+
+	ai_vis.queryframe = level.framenum;
+	ai_vis.frames++;
+}
+
+//==========================================
+// AI_ClientsVisible
+// Cached, symmetric visible() + inPVS() for two clients
+//==========================================
+bool AI_ClientsVisible(const entity &a, const entity &b)
+{
+	AI_CountVisibilityFrame();
+
+	ai_vis.queries++;
+
+	// the check FindEnemy used to make, one trace per query
+	if (!(bool)bot_vis_matrix)
+	{
+		ai_vis.traces++;
+		return visible(a, b) && gi.inPVS(a.s.origin, b.s.origin);
+	}
+
+	// always trace from the lower numbered client, so the
+	// result doesn't depend on who asked first
+	const entity &lo = a.s.number < b.s.number ? a : b;
+	const entity &hi = a.s.number < b.s.number ? b : a;
+	const size_t i = lo.s.number - 1, j = hi.s.number - 1;
+	const gtime frames = (gtime)max(1, (int32_t)bot_vis_frames);
+
+	// unsigned, so a backdated stamp near frame 0 still ages correctly
+	if (ai_vis.known[i][j] && level.framenum - ai_vis.traced[i][j] < frames)
+		return ai_vis.visible[i][j];
+
+	bool can_see = gi.inPVS(lo.s.origin, hi.s.origin);
+
+	if (can_see)
+	{
+		vector spot1 = lo.s.origin;
+		spot1.z += lo.g.viewheight;
+		vector spot2 = hi.s.origin;
+		spot2.z += hi.g.viewheight;
+		trace tr = gi.traceline(spot1, spot2, lo, MASK_OPAQUE);
+
+		ai_vis.traces++;
+		can_see = tr.fraction == 1.0f || tr.ent == hi;
+	}
+
+	gtime stamp = level.framenum;
+
+	if (!ai_vis.known[i][j])
+		stamp -= (i + j) % frames;
+
+	ai_vis.known[i][j] = ai_vis.known[j][i] = true;
+	ai_vis.visible[i][j] = ai_vis.visible[j][i] = can_see;
+	ai_vis.traced[i][j] = ai_vis.traced[j][i] = stamp;
+
+	return can_see;
+}
+
+//==========================================
+// AI_ResetVisibility
+//==========================================
+void AI_ResetVisibility()
+{
+	for (auto &row : ai_vis.known)
+		row.reset();
+
+	ai_vis.queryframe = level.framenum;
+	ai_vis.frames = ai_vis.queries = ai_vis.traces = 0;
+}
+
+//==========================================
+// AI_VisibilityStats
+//==========================================
+void AI_VisibilityStats()
+{
+	if (!ai_vis.frames)
+	{
+		gi.dprintf("botvis: no queries yet\n");
+		return;
+	}
+
+	const double frames = (double)ai_vis.frames;
+
+	if ((bool)bot_vis_matrix)
+		gi.dprintf("%u frames, matrix kept for %i frame(s)\n", (uint32_t)ai_vis.frames, max(1, (int32_t)bot_vis_frames));
+	else
+		gi.dprintf("%u frames, matrix off\n", (uint32_t)ai_vis.frames);
+	gi.dprintf("queries per frame: %.1f\n", ai_vis.queries / frames);
+	gi.dprintf("traces per frame:  %.1f (%.1f%% of queries)\n", ai_vis.traces / frames, ai_vis.queries ? ai_vis.traces * 100.0 / ai_vis.queries : 0.0);
+}
+
+#endif
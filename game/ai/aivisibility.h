@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../../lib/types.h"
+
+// whether clients a and b can see each other: in each other's PVS and
+// with nothing opaque between their eyes. each pair is traced at most
+// once every bot_vis_frames frames, and both directions share the answer,
+// so a result can be up to bot_vis_frames - 1 frames old.
+// with bot_vis_matrix 0 every query traces, as FindEnemy used to.
+bool AI_ClientsVisible(const entity &a, const entity &b);
+
+// forget everything; called on map change
+void AI_ResetVisibility();
+
+// print traces and queries per frame
+void AI_VisibilityStats();
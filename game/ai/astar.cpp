@@ -3,8 +3,11 @@
 #ifdef BOTS
 
 #include "../../lib/gi.h"
+#include "../../lib/entity.h"
 #include "astar.h"
 #include "ai.h"
+#include "../util.h"
+#include <algorithm>
 
 enum astar_node_list : uint8_t
 {
@@ -118,7 +121,7 @@ static inline void AStar_PutAdjacentsInOpen(node_id node)
 			int plinkDist = AStar_PLinkDistance(node, addnode);
 
 			if (plinkDist == -1)
-				gi.dprintf("WARNING: AStar_PutAdjacentsInOpen - Couldn't find distance between nodes\n");
+				G_DevPrint("WARNING: AStar_PutAdjacentsInOpen - Couldn't find distance between nodes\n");
 			//compare G distances and choose best parent
 			else if (paddnode.G > (pstarnode.G + plinkDist))
 			{
@@ -136,7 +139,7 @@ static inline void AStar_PutAdjacentsInOpen(node_id node)
 					plinkDist = 999;//jalFIXME
 
 				//ERROR
-				gi.dprintf("WARNING: AStar_PutAdjacentsInOpen - Couldn't find distance between nodes\n");
+				G_DevPrint("WARNING: AStar_PutAdjacentsInOpen - Couldn't find distance between nodes\n");
 			}
 
 			//put in global list
@@ -224,4 +227,125 @@ bool AStar_GetPath(node_id origin, node_id goal, ai_link_type movetypes, astar_p
 	return true;
 }
 
+struct sweepnode
+{
+	// nodes from another sweep are unvisited
+	uint32_t	sweep;
+	uint32_t	dist;
+	uint32_t	hops;
+	bool		settled;
+	bool		goal;
+};
+
+static dynarray<sweepnode> sweepnodes;
+static uint32_t sweepnum;
+
+// open set as a min-heap on distance; stale entries are skipped when popped
+static dynarray<std::pair<uint32_t, node_id>> sweepheap;
+
+static inline sweepnode &AStar_SweepNode(node_id node)
+{
+	sweepnode &snode = sweepnodes[node];
+
+	if (snode.sweep != sweepnum)
+		snode = { sweepnum, (uint32_t)-1, 0, false, false };
+
+	return snode;
+}
+
+void AStar_GetHops(node_id origin, const dynarray<node_id> &goals, ai_link_type movetypes, dynarray<uint32_t> &hops)
+{
+	hops.assign(goals.size(), NODE_INVALID);
+
+	if (origin == NODE_INVALID || goals.empty())
+		return;
+
+	ValidLinksMask = movetypes;
+	if (!ValidLinksMask)
+		ValidLinksMask = DEFAULT_MOVETYPES_MASK;
+
+	if (sweepnodes.size() != nav.nodes.size())
+	{
+		sweepnodes.clear();
+		sweepnodes.resize(nav.nodes.size());
+	}
+
+	// on wrap, everything has to be forgotten by hand
+	if (!++sweepnum)
+	{
+		for (auto &snode : sweepnodes)
+			snode.sweep = 0;
+		sweepnum = 1;
+	}
+
+	size_t remaining = 0;
+
+	for (const node_id goal : goals)
+	{
+		if (goal == NODE_INVALID)
+			continue;
+
+		sweepnode &snode = AStar_SweepNode(goal);
+
+		if (!snode.goal)
+		{
+			snode.goal = true;
+			remaining++;
+		}
+	}
+
+	constexpr auto further = [](const std::pair<uint32_t, node_id> &a, const std::pair<uint32_t, node_id> &b) { return a.first > b.first; };
+
+	sweepheap.clear();
+	AStar_SweepNode(origin).dist = 0;
+	sweepheap.push_back({ 0, origin });
+
+	while (remaining && !sweepheap.empty())
+	{
+		std::pop_heap(sweepheap.begin(), sweepheap.end(), further);
+		const auto [dist, node] = sweepheap.back();
+		sweepheap.pop_back();
+
+		sweepnode &snode = sweepnodes[node];
+
+		if (snode.settled || dist > snode.dist)
+			continue;
+
+		snode.settled = true;
+
+		if (snode.goal)
+			remaining--;
+
+		for (const auto &link : nav.nodes[node].links)
+		{
+			//ignore invalid links and self
+			if (!(ValidLinksMask & link.moveType) || link.node == node)
+				continue;
+
+			sweepnode &next = AStar_SweepNode(link.node);
+			const uint32_t next_dist = dist + link.dist;
+
+			if (next.settled || next_dist >= next.dist)
+				continue;
+
+			next.dist = next_dist;
+			next.hops = snode.hops + 1;
+			sweepheap.push_back({ next_dist, link.node });
+			std::push_heap(sweepheap.begin(), sweepheap.end(), further);
+		}
+	}
+
+	for (size_t i = 0; i < goals.size(); i++)
+	{
+		// like A*, the origin isn't a path to itself
+		if (goals[i] == NODE_INVALID || goals[i] == origin)
+			continue;
+
+		const sweepnode &snode = sweepnodes[goals[i]];
+
+		if (snode.sweep == sweepnum && snode.settled)
+			hops[i] = snode.hops;
+	}
+}
+
 #endif
\ No newline at end of file
@@ -79,3 +79,8 @@ struct astar_path
 bool AStar_ResolvePath(node_id n1, node_id n2, ai_link_type movetypes);
 
 bool AStar_GetPath(node_id origin, node_id goal, ai_link_type movetypes, astar_path &path);
+
+// one Dijkstra sweep from origin to every node in goals, stopping once
+// they're all settled. hops receives the number of nodes on the shortest
+// path to each goal, or NODE_INVALID if it can't be reached.
+void AStar_GetHops(node_id origin, const dynarray<node_id> &goals, ai_link_type movetypes, dynarray<uint32_t> &hops);
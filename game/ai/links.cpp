@@ -3,7 +3,10 @@
 #ifdef BOTS
 
 #include "../../lib/gi.h"
+#include "../../lib/entity.h"
+#include "../../lib/vector_batch.h"
 #include "ai.h"
+#include "../util.h"
 #include "navigation.h"
 
 //==========================================
@@ -35,18 +38,20 @@ node_id AI_findNodeInRadius(node_id from, vector org, float rad, bool ignoreHeig
 	else
 		from++;
 
-	for( ; from < numNodes; from++)
+	// test the node origins a batch at a time
+	vector_batch<64> origins;
+
+	while( from < numNodes )
 	{
-		const nav_node &node = nav.nodes[from];
-		vector eorg = org - node.origin;
-		
-		if (ignoreHeight)
-			eorg[2] = 0;
-		
-		if (VectorLength(eorg) > rad)
-			continue;
+		const node_id first = from;
+
+		for( origins.clear(); from < numNodes && !origins.full(); from++ )
+			origins.push(nav.nodes[from].origin);
+
+		const size_t hit = VectorBatch_FindInRadius(origins, org, rad, ignoreHeight);
 
-		return from;
+		if( hit != origins.count )
+			return (node_id)(first + hit);
 	}
 
 	return NODE_INVALID;
@@ -584,7 +589,7 @@ static node_id AI_LadderLink_FindUpperNode(node_id node)
 	}
 
 	if( candidate != -1 )
-		gi.dprintf( "LADDER: FOUND upper node in ladder\n");
+		G_DevPrint("LADDER: FOUND upper node in ladder\n");
 
 	return candidate;
 }
@@ -631,7 +636,7 @@ static node_id AI_LadderLink_FindLowerNode(node_id node)
 	}
 
 	if( candidate != -1 )
-		gi.dprintf( "LADDER: FOUND lower node in ladder\n");
+		G_DevPrint("LADDER: FOUND lower node in ladder\n");
 
 	return candidate;
 }
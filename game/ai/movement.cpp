@@ -312,10 +312,10 @@ bool AI_MoveToGoalEntity(entity &self, usercmd &ucmd)
 		AI_ChangeAngle(self);
 
 		if(AIDevel.debugChased && bot_showcombat)
-			gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: Oh crap a rocket!\n", self.client->g.pers.netname.ptr());
+			G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: Oh crap a rocket!\n", self.client->g.pers.netname);
 
 		// strafe left/right
-		if(Q_rand()%1 && AI_CanMove(self, BOT_MOVE_LEFT))
+		if(rng_bots()%1 && AI_CanMove(self, BOT_MOVE_LEFT))
 			ucmd.sidemove = -400;
 		else if(AI_CanMove(self, BOT_MOVE_RIGHT))
 			ucmd.sidemove = 400;
@@ -5,6 +5,7 @@
 #include "../../lib/gi.h"
 #include "../../lib/entity.h"
 #include "../game.h"
+#include "../util.h"
 #include "ai.h"
 #include "astar.h"
 #include "links.h"
@@ -28,6 +29,23 @@ float AI_FindCost(node_id from, node_id to, ai_link_type movetypes)
 	return (float)path.nodes.size();
 }
 
+//==========================================
+// AI_FindCosts
+// Determine the costs of moving from one node to
+// many others, as AI_FindCost would, in one search
+//==========================================
+void AI_FindCosts(node_id from, const dynarray<node_id> &to, ai_link_type movetypes, dynarray<float> &costs)
+{
+	static dynarray<uint32_t> hops;
+
+	AStar_GetHops(from, to, movetypes, hops);
+
+	costs.resize(to.size());
+
+	for (size_t i = 0; i < to.size(); i++)
+		costs[i] = hops[i] == NODE_INVALID ? -1 : (float)hops[i];
+}
+
 
 //==========================================
 // AI_FindClosestReachableNode
@@ -108,7 +126,7 @@ void AI_SetGoal(entity &self, node_id goal_node)
 	//-------------------------
 
 	if (AIDevel.debugChased && bot_showlrgoal)
-		gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: GOAL: new START NODE selected %d\n", self.client->g.pers.netname.ptr(), node);
+		G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: GOAL: new START NODE selected {}\n", self.client->g.pers.netname, node);
 
 	self.g.ai.next_node = self.g.ai.current_node; // make sure we get to the nearest node first
 	self.g.ai.node_timeout = 0;
@@ -154,8 +172,8 @@ bool AI_FollowPath(entity &self)
 		dist = 16;
 
 	if ((dist < 32 && pnextNode.flags != NODEFLAGS_JUMPPAD && pnextNode.flags != NODEFLAGS_TELEPORTER_IN)
-		|| (self.g.ai.status.jumpadReached && (pnextNode.flags & NODEFLAGS_JUMPPAD))
-		|| (self.g.ai.status.TeleportReached && (pnextNode.flags & NODEFLAGS_TELEPORTER_IN)))
+		|| (AI_Status(self).jumpadReached && (pnextNode.flags & NODEFLAGS_JUMPPAD))
+		|| (AI_Status(self).TeleportReached && (pnextNode.flags & NODEFLAGS_TELEPORTER_IN)))
 	{
 		// reset timeout
 		self.g.ai.node_timeout = 0;
@@ -163,7 +181,7 @@ bool AI_FollowPath(entity &self)
 		if (self.g.ai.next_node == self.g.ai.goal_node)
 		{
 			if(AIDevel.debugChased && bot_showlrgoal)
-				gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: GOAL REACHED!\n", self.client->g.pers.netname.ptr());
+				G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: GOAL REACHED!\n", self.client->g.pers.netname);
 			
 			//if botroam, setup a timeout for it
 			if(pnextNode.flags & NODEFLAGS_BOTROAM)
@@ -174,8 +192,12 @@ bool AI_FollowPath(entity &self)
 						continue;
 
 					if(AIDevel.debugChased && bot_showlrgoal)
-						gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: BotRoam Time Out set up for node %i\n", self.client->g.pers.netname.ptr(), broam.node);
-					self.g.ai.status.broam_timeout_framenums[&broam - nav.broams.data()] = level.framenum + (gtime)(15.0 * BASE_FRAMERATE);
+						G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: BotRoam Time Out set up for node {}\n", self.client->g.pers.netname, broam.node);
+					ai_status &status = AI_Status(self);
+					const size_t broam_index = &broam - nav.broams.data();
+
+					status.broam_timeout_framenums[broam_index] = level.framenum + (gtime)(15.0 * BASE_FRAMERATE);
+					status.broam_timeouts.set(broam_index);
 					break;
 				}
 			}
@@ -189,7 +211,7 @@ bool AI_FollowPath(entity &self)
 			self.g.ai.next_node = self.g.ai.path.nodes[self.g.ai.path_position++];
 
 			if(AIDevel.debugChased && (int32_t)bot_showpath > 1)
-				gi.cprintf(AIDevel.chaseguy, PRINT_HIGH, "%s: CurrentNode(%i):%i NextNode(%i):%i\n", self.client->g.pers.netname.ptr(), self.g.ai.current_node, nav.nodes[self.g.ai.current_node].flags, self.g.ai.next_node, nav.nodes[self.g.ai.next_node].flags);
+				G_ClientPrint(AIDevel.chaseguy, PRINT_HIGH, "{}: CurrentNode({}):{} NextNode({}):{}\n", self.client->g.pers.netname, self.g.ai.current_node, (uint32_t)nav.nodes[self.g.ai.current_node].flags, self.g.ai.next_node, (uint32_t)nav.nodes[self.g.ai.next_node].flags);
 		}
 	}
 
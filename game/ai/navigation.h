@@ -6,6 +6,8 @@ node_id AI_FindClosestReachableNode(vector origin, entityref passent, int32_t ra
 
 float AI_FindCost(node_id from, node_id to, ai_link_type movetypes);
 
+void AI_FindCosts(node_id from, const dynarray<node_id> &to, ai_link_type movetypes, dynarray<float> &costs);
+
 void AI_SetGoal(entity &self, node_id goal_node);
 
 bool AI_FollowPath(entity &self);
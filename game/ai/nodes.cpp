@@ -106,7 +106,7 @@ inline bool AI_PredictJumpadDestity(entity &ent, vector &outvec)
 	tr = gi.trace(target_origin, { -15, -15, -8 }, { 15, 15, 8 }, floor_target_origin, 0, MASK_NODESOLID);
 	if ((tr.fraction == 1.0 && tr.startsolid) || (tr.allsolid && tr.startsolid))
 	{
-		gi.dprintf("JUMPAD LAND: ERROR: trace was in solid.\n"); //started inside solid (target should never be inside solid, this is a mapper error)
+		G_DevPrint("JUMPAD LAND: ERROR: trace was in solid.\n"); //started inside solid (target should never be inside solid, this is a mapper error)
 		return false;
 	}
 	else if ( tr.fraction == 1.0 )
@@ -350,10 +350,13 @@ static node_id AI_AddNode_BotRoam( entity &ent )
 	else
 		weight = 0.3f;
 	
-	nav.broams.push_back({
-		newest,
-		weight
-	});
+	if (nav.broams.size() < MAX_BOT_ROAMS)
+		nav.broams.push_back({
+			newest,
+			weight
+		});
+	else
+		G_DevPrint("AI: more than {} bot roams, ignoring the one at {} {} {}\n", MAX_BOT_ROAMS, ent.s.origin.x, ent.s.origin.y, ent.s.origin.z);
 
 	return newest-1; // return the node added
 }
@@ -419,8 +422,19 @@ void AI_CreateNodesForEntities()
 
 	//visit world nodes first, and put in list what we find in there
 	for (const auto &node : nav.nodes)
-		if (node.flags & NODEFLAGS_BOTROAM)
-			nav.broams.push_back({ NodeIDFromNode(node), 0.3f });
+	{
+		if (!(node.flags & NODEFLAGS_BOTROAM))
+			continue;
+
+		// bots keep their roam timeouts in fixed tables
+		if (nav.broams.size() == MAX_BOT_ROAMS)
+		{
+			gi.dprintf("AI: more than %u bot roams, ignoring the rest\n", (uint32_t)MAX_BOT_ROAMS);
+			break;
+		}
+
+		nav.broams.push_back({ NodeIDFromNode(node), 0.3f });
+	}
 
 	//now add bot roams from entities
 	for (auto &ent : entity_range(0, num_entities))
@@ -4,29 +4,56 @@
 #include "chase.h"
 #include "game.h"
 
-void UpdateChaseCam(entity &ent)
+void SetChaseTarget(entity &ent, entityref target)
 {
-	entityref targ = ent.client->g.chase_target;
+	gclient &cl = ent.client->g;
 
-	// is our chase target gone?
-	if (!targ->inuse || targ->client->g.resp.spectator)
+	if (cl.chase_target == target)
+		return;
+
+	// leave the old target's list
+	if (cl.chase_target.has_value())
 	{
-		ChaseNext(ent);
+		if (cl.chase_prev.has_value())
+			cl.chase_prev->client->g.chase_next = cl.chase_next;
+		else
+			cl.chase_target->client->g.chasers = cl.chase_next;
 
-		if (ent.client->g.chase_target == targ)
-		{
-			ent.client->g.chase_target = nullptr;
-			ent.client->ps.pmove.pm_flags &= ~PMF_NO_PREDICTION;
-			return;
-		}
+		if (cl.chase_next.has_value())
+			cl.chase_next->client->g.chase_prev = cl.chase_prev;
 
-		targ = ent.client->g.chase_target;
+		cl.chase_next = cl.chase_prev = null_entity;
 	}
 
-	vector ownerv = targ->s.origin;
-	ownerv.z += targ->g.viewheight;
+	cl.chase_target = target;
+
+	// and join the front of the new one's
+	if (target.has_value())
+	{
+		gclient &tcl = target->client->g;
+
+		cl.chase_next = tcl.chasers;
+
+		if (tcl.chasers.has_value())
+			tcl.chasers->client->g.chase_prev = ent;
+
+		tcl.chasers = ent;
+	}
+}
+
+// where a chase camera following targ sits; this only depends on
+// the target, so everyone chasing the same player can share it
+struct chase_view
+{
+	vector	origin;
+};
+
+static chase_view ChaseCam_View(entity &targ)
+{
+	vector ownerv = targ.s.origin;
+	ownerv.z += targ.g.viewheight;
 
-	vector angles = targ->client->g.v_angle;
+	vector angles = targ.client->g.v_angle;
 	if (angles[PITCH] > 56)
 		angles[PITCH] = 56.f;
 
@@ -35,11 +62,11 @@ void UpdateChaseCam(entity &ent)
 	VectorNormalize(forward);
 	vector o = ownerv + (-30 * forward);
 
-	if (o.z < targ->s.origin[2] + 20.f)
-		o.z = targ->s.origin[2] + 20.f;
+	if (o.z < targ.s.origin[2] + 20.f)
+		o.z = targ.s.origin[2] + 20.f;
 
 	// jump animation lifts
-	if (!targ->g.groundentity.has_value())
+	if (!targ.g.groundentity.has_value())
 		o.z += 16;
 
 	trace tr = gi.traceline(ownerv, o, targ, MASK_SOLID);
@@ -65,24 +92,29 @@ void UpdateChaseCam(entity &ent)
 		goal.z += 6;
 	}
 
-	if (targ->g.deadflag)
+	return { goal };
+}
+
+static void ChaseCam_Apply(entity &ent, entity &targ, const chase_view &view)
+{
+	if (targ.g.deadflag)
 		ent.client->ps.pmove.pm_type = PM_DEAD;
 	else
 		ent.client->ps.pmove.pm_type = PM_FREEZE;
 
-	ent.s.origin = goal;
-	ent.client->ps.pmove.set_delta_angles(targ->client->g.v_angle - ent.client->g.resp.cmd_angles);
+	ent.s.origin = view.origin;
+	ent.client->ps.pmove.set_delta_angles(targ.client->g.v_angle - ent.client->g.resp.cmd_angles);
 
-	if (targ->g.deadflag)
+	if (targ.g.deadflag)
 	{
 		ent.client->ps.viewangles[ROLL] = 40.f;
 		ent.client->ps.viewangles[PITCH] = -15.f;
-		ent.client->ps.viewangles[YAW] = targ->client->g.killer_yaw;
+		ent.client->ps.viewangles[YAW] = targ.client->g.killer_yaw;
 	}
 	else
 	{
-		ent.client->ps.viewangles = targ->client->g.v_angle;
-		ent.client->g.v_angle = targ->client->g.v_angle;
+		ent.client->ps.viewangles = targ.client->g.v_angle;
+		ent.client->g.v_angle = targ.client->g.v_angle;
 	}
 
 	ent.g.viewheight = 0;
@@ -101,11 +133,65 @@ void UpdateChaseCam(entity &ent)
 	{
 		ent.client->g.update_chase = false;
 		gi.WriteByte(svc_layout);
-		gi.WriteString(strconcat("xv 0 yb -68 string2 \"Chasing ", targ->client->g.pers.netname, "\""));
+		gi.WriteString(strconcat("xv 0 yb -68 string2 \"Chasing ", targ.client->g.pers.netname, "\""));
 		gi.unicast(ent, false);
 	}
 }
 
+// whether a chase target can't be followed any more
+static inline bool ChaseCam_TargetGone(entity &targ)
+{
+	return !targ.inuse || targ.client->g.resp.spectator;
+}
+
+void UpdateChaseCam(entity &ent)
+{
+	entityref targ = ent.client->g.chase_target;
+
+	// is our chase target gone?
+	if (ChaseCam_TargetGone(targ))
+	{
+		ChaseNext(ent);
+
+		if (ent.client->g.chase_target == targ)
+		{
+			SetChaseTarget(ent, null_entity);
+			ent.client->ps.pmove.pm_flags &= ~PMF_NO_PREDICTION;
+			return;
+		}
+
+		targ = ent.client->g.chase_target;
+	}
+
+	ChaseCam_Apply(ent, targ, ChaseCam_View(targ));
+}
+
+void UpdateChasers(entity &ent)
+{
+	// a target that's gone sends each chaser off to find
+	// someone else, so they take the long way round
+	const bool gone = ChaseCam_TargetGone(ent);
+	chase_view view {};
+
+	if (!gone && ent.client->g.chasers.has_value())
+		view = ChaseCam_View(ent);
+
+	// the next link is fetched first, since moving a
+	// chaser to someone else takes it out of this list
+	for (entityref other = ent.client->g.chasers, next; other.has_value(); other = next)
+	{
+		next = other->client->g.chase_next;
+
+		if (!other->inuse)
+			continue;
+
+		if (gone)
+			UpdateChaseCam(other);
+		else
+			ChaseCam_Apply(other, ent, view);
+	}
+}
+
 void ChaseNext(entity &ent)
 {
 	if (!ent.client->g.chase_target.has_value())
@@ -126,7 +212,7 @@ void ChaseNext(entity &ent)
 			break;
 	} while (e != ent.client->g.chase_target);
 
-	ent.client->g.chase_target = e;
+	SetChaseTarget(ent, e);
 	ent.client->g.update_chase = true;
 }
 
@@ -150,19 +236,28 @@ void ChasePrev(entity &ent)
 			break;
 	} while (e != ent.client->g.chase_target);
 	
-	ent.client->g.chase_target = e;
+	SetChaseTarget(ent, e);
 	ent.client->g.update_chase = true;
 }
 
 void GetChaseTarget(entity &ent)
 {
+	// in broadcast mode, start on whoever is on air
+	if ((bool)g_chase_broadcast && level.chase_broadcast.has_value() && !ChaseCam_TargetGone(level.chase_broadcast))
+	{
+		SetChaseTarget(ent, level.chase_broadcast);
+		ent.client->g.update_chase = true;
+		UpdateChaseCam(ent);
+		return;
+	}
+
 	for (uint32_t i = 1; i <= game.maxclients; i++)
 	{
 		entity &other = itoe(i);
 		
 		if (other.inuse && !other.client->g.resp.spectator)
 		{
-			ent.client->g.chase_target = other;
+			SetChaseTarget(ent, other);
 			ent.client->g.update_chase = true;
 			UpdateChaseCam(ent);
 			return;
@@ -171,3 +266,56 @@ void GetChaseTarget(entity &ent)
 
 	gi.centerprintf(ent, "No other players to chase.");
 }
+
+// the number of clients chasing targ
+static uint32_t ChaseCam_Count(entity &targ)
+{
+	uint32_t count = 0;
+
+	for (entityref other = targ.client->g.chasers; other.has_value(); other = other->client->g.chase_next)
+		count++;
+
+	return count;
+}
+
+void ChaseBroadcast()
+{
+	if (gi.argc() < 3)
+	{
+		if (level.chase_broadcast.has_value())
+			gi.dprintf("on air: %s (%u chasing)\n", level.chase_broadcast->client->g.pers.netname.ptr(), ChaseCam_Count(level.chase_broadcast));
+		else
+			gi.dprintf("nobody is on air\n");
+
+		gi.dprintf("usage: sv chase <client number>\n");
+		return;
+	}
+
+	const uint32_t num = (uint32_t)atoi(gi.argv(2));
+
+	if (num >= game.maxclients || ChaseCam_TargetGone(itoe(num + 1)))
+	{
+		gi.dprintf("client %u isn't a player in the game\n", num);
+		return;
+	}
+
+	entity &target = itoe(num + 1);
+	level.chase_broadcast = target;
+
+	// move everyone already watching a chase camera over
+	if ((bool)g_chase_broadcast)
+	{
+		for (uint32_t i = 1; i <= game.maxclients; i++)
+		{
+			entity &other = itoe(i);
+
+			if (!other.inuse || !other.client->g.chase_target.has_value() || other.client->g.chase_target == target)
+				continue;
+
+			SetChaseTarget(other, target);
+			other.client->g.update_chase = true;
+		}
+	}
+
+	gi.dprintf("on air: %s (%u chasing)\n", target.client->g.pers.netname.ptr(), ChaseCam_Count(target));
+}
@@ -2,7 +2,21 @@
 
 #include "../lib/types.h"
 
+// change who ent is chasing; this keeps every target's list of
+// chasers in step, so chase_target must not be set directly
+void SetChaseTarget(entity &ent, entityref target);
+
 void UpdateChaseCam(entity &ent);
+
+// move the chase cameras of everyone chasing ent; the camera
+// position is worked out once and shared between them
+void UpdateChasers(entity &ent);
+
 void ChaseNext(entity &ent);
 void ChasePrev(entity &ent);
 void GetChaseTarget(entity &ent);
+
+// "sv chase [client number]"; put a player on air for g_chase_broadcast.
+// spectators starting a chase camera follow them, and anyone already
+// chasing someone is moved over.
+void ChaseBroadcast();
@@ -827,16 +827,12 @@ static void Cmd_Say_f(entity &ent, bool team, bool arg0)
 	if (dedicated)
 		gi.dprintf("%s", text.ptr());
 
-	for (size_t i = 1; i <= game.maxclients; i++)
-	{
-		entity &other = itoe(i);
-		if (!other.inuse)
-			continue;
-		if (team && !OnSameTeam(ent, other))
-			continue;
+	const client_message msg = { MESSAGE_PRINT, PRINT_CHAT, text };
 
-		gi.cprintf(other, PRINT_CHAT, "%s", text.ptr());
-	}
+	if (team)
+		G_Broadcast(msg, team_filter { ent });
+	else
+		G_Broadcast(msg, [](entity &) { return true; });
 }
 
 static void Cmd_PlayerList_f(entity &ent)
@@ -903,6 +899,142 @@ static void Cmd_Spawn_f(entity &ent)
 #include "grapple.h"
 #endif
 
+/*
+=================
+Command limiting
+
+Each client has a token bucket per command class, refilled at
+flood_<class>_rate commands per second up to flood_<class>_burst.
+A bucket is kept as the level.time it will be full again, so a
+zeroed one is full and refilling costs nothing until it's used.
+=================
+*/
+struct command_limit
+{
+	stringlit	name;
+	cvarref		&rate, &burst;
+};
+
+static const array<command_limit, CMD_CLASS_TOTAL> command_limits = {{
+	{ "chat", flood_chat_rate, flood_chat_burst },
+	{ "info", flood_info_rate, flood_info_burst },
+	{ "item", flood_item_rate, flood_item_burst },
+	{ "other", flood_other_rate, flood_other_burst }
+}};
+
+static const struct
+{
+	stringlit		name;
+	command_class	cls;
+} command_classes[] = {
+	{ "say", CMD_CLASS_CHAT },
+	{ "say_team", CMD_CLASS_CHAT },
+
+	{ "players", CMD_CLASS_INFO },
+	{ "score", CMD_CLASS_INFO },
+	{ "help", CMD_CLASS_INFO },
+	{ "inven", CMD_CLASS_INFO },
+	{ "playerlist", CMD_CLASS_INFO },
+	{ "id", CMD_CLASS_INFO },
+
+	{ "use", CMD_CLASS_ITEM },
+	{ "drop", CMD_CLASS_ITEM },
+	{ "invnext", CMD_CLASS_ITEM },
+	{ "invprev", CMD_CLASS_ITEM },
+	{ "invnextw", CMD_CLASS_ITEM },
+	{ "invprevw", CMD_CLASS_ITEM },
+	{ "invnextp", CMD_CLASS_ITEM },
+	{ "invprevp", CMD_CLASS_ITEM },
+	{ "invuse", CMD_CLASS_ITEM },
+	{ "invdrop", CMD_CLASS_ITEM },
+	{ "weapprev", CMD_CLASS_ITEM },
+	{ "weapnext", CMD_CLASS_ITEM },
+	{ "weaplast", CMD_CLASS_ITEM },
+	{ "putaway", CMD_CLASS_ITEM },
+
+	{ "spawn", CMD_CLASS_OTHER },
+	{ "give", CMD_CLASS_OTHER },
+	{ "god", CMD_CLASS_OTHER },
+	{ "notarget", CMD_CLASS_OTHER },
+	{ "noclip", CMD_CLASS_OTHER },
+	{ "kill", CMD_CLASS_OTHER },
+	{ "wave", CMD_CLASS_OTHER },
+	{ "team", CMD_CLASS_OTHER },
+	{ "observer", CMD_CLASS_OTHER },
+	{ "hook", CMD_CLASS_OTHER }
+};
+
+static array<uint64_t, CMD_CLASS_TOTAL> command_passed, command_dropped;
+
+static command_class Cmd_Class(const string &cmd)
+{
+	for (auto &entry : command_classes)
+		if (cmd == entry.name)
+			return entry.cls;
+
+	// anything that doesn't match a command will be a chat
+	return CMD_CLASS_CHAT;
+}
+
+static bool Cmd_Allowed(entity &ent, command_class cls)
+{
+	const command_limit &limit = command_limits[cls];
+	const float rate = (float)limit.rate;
+
+	if (rate <= 0)
+	{
+		command_passed[cls]++;
+		return true;
+	}
+
+	const float interval = 1.f / rate;
+	const float burst = max(1.f, (float)limit.burst);
+	float &full_time = ent.client->g.cmd_full_time[cls];
+
+	// level.time starts over with each level, leaving the
+	// bucket looking emptier than empty
+	if (full_time - level.time > burst * interval)
+		full_time = level.time;
+
+	// less than one token left
+	if (full_time - level.time > (burst - 1) * interval)
+	{
+		command_dropped[cls]++;
+		ent.client->g.cmd_dropped++;
+		return false;
+	}
+
+	full_time = max(full_time, level.time) + interval;
+	command_passed[cls]++;
+	return true;
+}
+
+void Cmd_LimitReport()
+{
+	gi.dprintf("%-8s %6s %6s %10s %10s\n", "class", "rate", "burst", "passed", "dropped");
+
+	for (size_t i = 0; i < CMD_CLASS_TOTAL; i++)
+		gi.dprintf("%-8s %6g %6g %10llu %10llu\n", command_limits[i].name, (float)command_limits[i].rate, (float)command_limits[i].burst,
+			(unsigned long long)command_passed[i], (unsigned long long)command_dropped[i]);
+
+	for (uint32_t i = 1; i <= game.maxclients; i++)
+	{
+		entity &e = itoe(i);
+
+		if (e.inuse && e.client->g.cmd_dropped)
+			gi.dprintf("%s: %u dropped\n", e.client->g.pers.netname.ptr(), e.client->g.cmd_dropped);
+	}
+}
+
+void Cmd_LimitReset()
+{
+	command_passed.fill(0);
+	command_dropped.fill(0);
+
+	for (uint32_t i = 1; i <= game.maxclients; i++)
+		itoe(i).client->g.cmd_dropped = 0;
+}
+
 /*
 =================
 ClientCommand
@@ -915,6 +1047,9 @@ void ClientCommand(entity &ent)
 
 	string cmd = strlwr(gi.argv(0));
 
+	if (!Cmd_Allowed(ent, Cmd_Class(cmd)))
+		return;
+
 	// allowed any time
 	if (cmd == "players")
 		return Cmd_Players_f (ent);
@@ -6,4 +6,9 @@ bool OnSameTeam(entity &ent1, entity &ent2);
 
 void ValidateSelectedItem(entity &ent);
 
-void ClientCommand(entity &ent);
\ No newline at end of file
+void ClientCommand(entity &ent);
+
+// "sv cmdlimit": commands passed and dropped by the limiter
+void Cmd_LimitReport();
+
+void Cmd_LimitReset();
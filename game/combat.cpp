@@ -6,6 +6,7 @@
 #include "itemlist.h"
 #include "cmds.h"
 #include "util.h"
+#include "profile.h"
 
 means_of_death meansOfDeath;
 
@@ -15,7 +16,7 @@ bool CanDamage(entity &targ, entity &inflictor)
 	if (targ.g.movetype == MOVETYPE_PUSH)
 	{
 		const vector dest = (targ.absmin + targ.absmax) * 0.5f;
-		trace tr = gi.traceline(inflictor.s.origin, dest, inflictor, MASK_SOLID);
+		trace tr = gi.traceline_cached(inflictor.s.origin, dest, inflictor, MASK_SOLID);
 
 		if (tr.fraction == 1.0f)
 			return true;
@@ -25,35 +26,35 @@ bool CanDamage(entity &targ, entity &inflictor)
 		return false;
 	}
 
-	trace tr = gi.traceline(inflictor.s.origin, targ.s.origin, inflictor, MASK_SOLID);
+	trace tr = gi.traceline_cached(inflictor.s.origin, targ.s.origin, inflictor, MASK_SOLID);
 	if (tr.fraction == 1.0f)
 		return true;
 
 	vector dest = targ.s.origin;
 	dest.x += 15.0f;
 	dest.y += 15.0f;
-	tr = gi.traceline(inflictor.s.origin, dest, inflictor, MASK_SOLID);
+	tr = gi.traceline_cached(inflictor.s.origin, dest, inflictor, MASK_SOLID);
 	if (tr.fraction == 1.0f)
 		return true;
 
 	dest = targ.s.origin;
 	dest.x += 15.0f;
 	dest.y -= 15.0f;
-	tr = gi.traceline(inflictor.s.origin, dest, inflictor, MASK_SOLID);
+	tr = gi.traceline_cached(inflictor.s.origin, dest, inflictor, MASK_SOLID);
 	if (tr.fraction == 1.0f)
 		return true;
 
 	dest = targ.s.origin;
 	dest.x -= 15.0f;
 	dest.y += 15.0f;
-	tr = gi.traceline(inflictor.s.origin, dest, inflictor, MASK_SOLID);
+	tr = gi.traceline_cached(inflictor.s.origin, dest, inflictor, MASK_SOLID);
 	if (tr.fraction == 1.0f)
 		return true;
 
 	dest = targ.s.origin;
 	dest.x -= 15.0f;
 	dest.y -= 15.0f;
-	tr = gi.traceline(inflictor.s.origin, dest, inflictor, MASK_SOLID);
+	tr = gi.traceline_cached(inflictor.s.origin, dest, inflictor, MASK_SOLID);
 	if (tr.fraction == 1.0f)
 		return true;
 
@@ -446,6 +447,8 @@ bool CheckTeamDamage(means_of_death mod [[maybe_unused]])
 
 void T_Damage(entity &targ, entity &inflictor, entity &attacker, vector dir, vector point, vector normal, int32_t damage, int32_t knockback, damage_flags dflags, means_of_death mod)
 {
+	PROFILE_ZONE("T_Damage");
+
 	int32_t	take;
 	int32_t	save;
 	int32_t	asave;
@@ -650,6 +653,8 @@ void T_Damage(entity &targ, entity &inflictor, entity &attacker, vector dir, vec
 
 void T_RadiusDamage(entity &inflictor, entity &attacker, float damage, entityref ignore, float radius, means_of_death mod)
 {
+	PROFILE_ZONE("T_RadiusDamage");
+
 	entityref	ent;
 
 	while ((ent = findradius(ent, inflictor.s.origin, radius)).has_value())
@@ -33,5 +33,15 @@
 /*@@ { "macro": "KMQUAKE2_EXTENSIONS", "desc": "KMQuake2-specific features. This gives you access to certain additions that KMQuake2 adds, such as extra modelindex slots or gunindexes. These features will not work on non-KMQuake2 engines, but your mod will still function." } @@*/
 //#define KMQUAKE2_EXTENSIONS
 
-/*@@ { "macro": "CUSTOM_PMOVE", "desc": "By default, this codebase uses the PMove export from the engine; if you wish to create a custom player movement system, you can use Y here and edit pmove.cpp." } @@*/
+/*@@ { "macro": "CUSTOM_PMOVE", "desc": "By default, this codebase uses the PMove export from the engine; if you wish to create a custom player movement system, you can use Y here and edit pmove.cpp. It starts out bit-identical to the stock engine pmove; \"sv pmove record\" and \"sv pmove check\" compare it against the engine's." } @@*/
 //#define CUSTOM_PMOVE
+
+
+/*@@ { "macro": "SIMD_VECTORS", "desc": "Runs the batch vector kernels (findradius, the pusher overlap scan, bot node searches) four at a time with SSE2 or NEON where the target has it. The results are bit-identical to the scalar versions; \"sv benchvec\" checks that and times both." } @@*/
+#define SIMD_VECTORS
+
+/*@@ { "macro": "PROFILE", "desc": "Enables the zone profiler and the \"sv profile\" command. Without it, PROFILE_ZONE compiles to nothing." } @@*/
+//#define PROFILE
+
+/*@@ { "macro": "ENGINE_CALL_STATS", "desc": "Charges every trace, pointcontents, PVS/PHS, link and BoxEdicts call to the source line that made it, reported by the \"sv engcalls\" command. Without it, the import wrappers carry no extra arguments or timing." } @@*/
+//#define ENGINE_CALL_STATS
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "../lib/entity.h"
 #include "../lib/gi.h"
+#include "../lib/entity_mirror.h"
 #include "game.h"
 #include "view.h"
 #include "player.h"
@@ -7,6 +8,9 @@
 #include "hud.h"
 #include "phys.h"
 #include "spawn.h"
+#include "replay.h"
+#include "profile.h"
+#include "ipfilter.h"
 #ifdef BOTS
 #include "ai/aimain.h"
 #include "ai/aispawn.h"
@@ -36,6 +40,7 @@ cvarref	needpass;
 cvarref	maxspectators;
 cvarref	g_select_empty;
 cvarref	dedicated;
+cvarref	developer;
 
 cvarref	filterban;
 
@@ -57,13 +62,39 @@ cvarref	flood_msgs;
 cvarref	flood_persecond;
 cvarref	flood_waitdelay;
 
+cvarref	flood_chat_rate;
+cvarref	flood_chat_burst;
+cvarref	flood_info_rate;
+cvarref	flood_info_burst;
+cvarref	flood_item_rate;
+cvarref	flood_item_burst;
+cvarref	flood_other_rate;
+cvarref	flood_other_burst;
+
 cvarref	sv_maplist;
 
 cvarref	sv_features;
 
+cvarref	g_spawn_cache;
+
+cvarref	g_debris_max;
+cvarref	g_debris_per_frame;
+
+cvarref	g_seed;
+
+cvarref	g_trace_cache;
+
+cvarref	g_chase_broadcast;
+
+#ifdef CUSTOM_PMOVE
+cvarref	sv_airaccelerate;
+#endif
+
 model_index sm_meat_index;
 sound_index snd_fry;
 
+static void CheckNeedPass(cvarref &);
+
 void InitGame()
 {
 	gi.dprintf("===== %s =====\n", __func__);
@@ -77,6 +108,9 @@ void InitGame()
 	
 	// noset vars
 	dedicated = gi.cvar("dedicated", "0", CVAR_NOSET);
+
+	// the engine's; gates G_DevPrint
+	developer = gi.cvar("developer", "0", CVAR_NONE);
 	
 	// latched vars
 	sv_cheats = gi.cvar("cheats", "0", CVAR_SERVERINFO | CVAR_LATCH);
@@ -107,6 +141,8 @@ void InitGame()
 	password = gi.cvar("password", "", CVAR_USERINFO);
 	spectator_password = gi.cvar("spectator_password", "", CVAR_USERINFO);
 	needpass = gi.cvar("needpass", "0", CVAR_SERVERINFO);
+	Cvar_OnChange(password, CheckNeedPass);
+	Cvar_OnChange(spectator_password, CheckNeedPass);
 	filterban = gi.cvar("filterban", "1", CVAR_NONE);
 	
 	g_select_empty = gi.cvar("g_select_empty", "0", CVAR_ARCHIVE);
@@ -121,12 +157,44 @@ void InitGame()
 	flood_msgs = gi.cvar("flood_msgs", "4", CVAR_NONE);
 	flood_persecond = gi.cvar("flood_persecond", "4", CVAR_NONE);
 	flood_waitdelay = gi.cvar("flood_waitdelay", "10", CVAR_NONE);
+
+	// per-class command limits, in commands per second and the most
+	// that can be sent at once; a rate of 0 disables the limit
+	flood_chat_rate = gi.cvar("flood_chat_rate", "2", CVAR_NONE);
+	flood_chat_burst = gi.cvar("flood_chat_burst", "6", CVAR_NONE);
+	flood_info_rate = gi.cvar("flood_info_rate", "2", CVAR_NONE);
+	flood_info_burst = gi.cvar("flood_info_burst", "5", CVAR_NONE);
+	flood_item_rate = gi.cvar("flood_item_rate", "20", CVAR_NONE);
+	flood_item_burst = gi.cvar("flood_item_burst", "40", CVAR_NONE);
+	flood_other_rate = gi.cvar("flood_other_rate", "5", CVAR_NONE);
+	flood_other_burst = gi.cvar("flood_other_burst", "10", CVAR_NONE);
 	
 	// dm map list
 	sv_maplist = gi.cvar("sv_maplist", "", CVAR_NONE);
 	
 	// obtain server features
 	sv_features = gi.cvar("sv_features", "", CVAR_NONE);
+
+	// number of parsed entity lumps to keep around for map restarts
+	g_spawn_cache = gi.cvar("g_spawn_cache", "8", CVAR_NONE);
+
+	// gib and debris budgets; anything over them is drawn as a temp entity
+	g_debris_max = gi.cvar("g_debris_max", "64", CVAR_NONE);
+	g_debris_per_frame = gi.cvar("g_debris_per_frame", "24", CVAR_NONE);
+
+	// fixed RNG seed for every level; empty picks a new one each time
+	g_seed = gi.cvar("g_seed", "", CVAR_NONE);
+
+	// memoize repeated traces from cache-safe call sites within a frame
+	g_trace_cache = gi.cvar("g_trace_cache", "0", CVAR_NONE);
+
+	// new spectators chase whoever "sv chase" put on air
+	g_chase_broadcast = gi.cvar("g_chase_broadcast", "0", CVAR_NONE);
+
+#ifdef CUSTOM_PMOVE
+	// the engine's; pmove needs it to match the engine's air control
+	sv_airaccelerate = gi.cvar("sv_airaccelerate", "0", CVAR_LATCH);
+#endif
 	
 	// export our own features
 	gi.cvar_forceset("g_features", va("%i", G_FEATURES));
@@ -141,9 +209,14 @@ void InitGame()
 		e.client = gi.TagMalloc<client>(1, TAG_GAME);
 		::new(e.client) client;
 	}
+
+	// pick up the client bits just assigned
+	Mirror_Rebuild();
 	
 	InitItems();
 
+	IPFilter_Load();
+
 #ifdef CTF
 	CTFInit();
 #endif
@@ -156,6 +229,8 @@ void InitGame()
 void ShutdownGame()
 {
 	gi.dprintf("===== %s =====\n", __func__);
+
+	Replay_Stop();
 }
 
 /*
@@ -165,6 +240,8 @@ ClientEndServerFrames
 */
 static void ClientEndServerFrames()
 {
+	PROFILE_ZONE("ClientEndServerFrames");
+
     // calc the player views now that all pushing
     // and damage has been added
 	for (uint32_t i = 0; i < game.maxclients; i++)
@@ -254,22 +331,18 @@ void EndDMLevel()
 CheckNeedPass
 =================
 */
-static void CheckNeedPass()
+static void CheckNeedPass(cvarref &)
 {
-	// if password or spectator_password has changed, update needpass
-	// as needed
-	if (password.modified || spectator_password.modified)
-	{
-		password.modified = spectator_password.modified = false;
-		int need = 0;
+	// password or spectator_password has changed, so
+	// update needpass as needed
+	int need = 0;
 
-		if (password && password != "none")
-			need |= 1;
-		if (spectator_password && spectator_password != "none")
-			need |= 2;
+	if (password && password != "none")
+		need |= 1;
+	if (spectator_password && spectator_password != "none")
+		need |= 2;
 
-		gi.cvar_set("needpass", va("%d", need));
-	}
+	gi.cvar_set("needpass", va("%d", need));
 }
 
 /*
@@ -299,7 +372,7 @@ static void CheckDMRules()
 	{
 		if (level.time >= (int32_t)timelimit * 60)
 		{
-			gi.bprintf(PRINT_HIGH, "Timelimit hit.\n");
+			G_Broadcast({ MESSAGE_PRINT, PRINT_HIGH, "Timelimit hit.\n" });
 			EndDMLevel();
 			return;
 		}
@@ -316,7 +389,7 @@ static void CheckDMRules()
 
 			if (cl.client->g.resp.score >= (int32_t)fraglimit)
 			{
-				gi.bprintf(PRINT_HIGH, "Fraglimit hit.\n");
+				G_Broadcast({ MESSAGE_PRINT, PRINT_HIGH, "Fraglimit hit.\n" });
 				EndDMLevel();
 				return;
 			}
@@ -358,9 +431,16 @@ static void ExitLevel()
 
 void RunFrame()
 {
+	PROFILE_ZONE("RunFrame");
+
 	level.framenum++;
 	level.time = level.framenum * FRAMETIME;
 
+	// refresh cached cvars and let anything watching them know
+	Cvar_Update();
+
+	TraceCache_BeginFrame((bool)g_trace_cache);
+
 #ifdef SINGLE_PLAYER
 	// choose a client for monsters to target this frame
 	AI_SetSightClient();
@@ -401,16 +481,19 @@ void RunFrame()
 #endif
 	
 		if (i > 0 && i <= game.maxclients)
+		{
+			PROFILE_ZONE("ClientBeginServerFrame");
 			ClientBeginServerFrame(ent);
+		}
 	
 		G_RunEntity(ent);
 	}
 	
 	// see if it is time to end a deathmatch
-	CheckDMRules();
-	
-	// see if needpass needs updated
-	CheckNeedPass();
+	{
+		PROFILE_ZONE("CheckDMRules");
+		CheckDMRules();
+	}
 	
 	// build the playerstate_t structures for all players
 	ClientEndServerFrames();
@@ -116,6 +116,7 @@ extern cvarref	needpass;
 extern cvarref	maxspectators;
 extern cvarref	g_select_empty;
 extern cvarref	dedicated;
+extern cvarref	developer;
 
 extern cvarref	filterban;
 
@@ -137,10 +138,34 @@ extern cvarref	flood_msgs;
 extern cvarref	flood_persecond;
 extern cvarref	flood_waitdelay;
 
+extern cvarref	flood_chat_rate;
+extern cvarref	flood_chat_burst;
+extern cvarref	flood_info_rate;
+extern cvarref	flood_info_burst;
+extern cvarref	flood_item_rate;
+extern cvarref	flood_item_burst;
+extern cvarref	flood_other_rate;
+extern cvarref	flood_other_burst;
+
 extern cvarref	sv_maplist;
 
 extern cvarref	sv_features;
 
+extern cvarref	g_spawn_cache;
+
+extern cvarref	g_debris_max;
+extern cvarref	g_debris_per_frame;
+
+extern cvarref	g_seed;
+
+extern cvarref	g_trace_cache;
+
+extern cvarref	g_chase_broadcast;
+
+#ifdef CUSTOM_PMOVE
+extern cvarref	sv_airaccelerate;
+#endif
+
 // spawn_temp_t is only used to hold entity field values that
 // can be set from the editor, but aren't actualy present
 // in edict_t during gameplay.
@@ -222,6 +247,8 @@ struct level_locals
 
 	entityref	current_entity;	// entity running from G_RunFrame
 
+	entityref	chase_broadcast;	// player "sv chase" put on air
+
 	int32_t	body_que;           // dead bodies
 };
 
@@ -3,6 +3,7 @@
 import usercmd;
 
 #include "items.h"
+#include "../lib/print_level.h"
 
 // handedness values
 enum handedness : uint8_t
@@ -12,12 +13,24 @@ enum handedness : uint8_t
 	CENTER_HANDED
 };
 
+// client commands are rate limited per class
+enum command_class : uint8_t
+{
+	CMD_CLASS_CHAT,		// say, say_team and anything unrecognized
+	CMD_CLASS_INFO,		// scoreboards, inventory and player lists
+	CMD_CLASS_ITEM,		// item and weapon selection
+	CMD_CLASS_OTHER,
+
+	CMD_CLASS_TOTAL
+};
+
 // client data that stays across multiple level loads
 struct client_persistant
 {
 	string		userinfo;
 	string		netname;
 	handedness	hand;
+	print_level	messagelevel;	// the engine drops prints below this
 	
 	bool	connected = false;	// a loadgame will leave valid entities that
 								// just don't have a connection yet
@@ -214,12 +227,20 @@ struct gclient
 	float				flood_locktill;     // locked from talking
 	array<float, 10>	flood_when;     // when messages were said
 	size_t				flood_whenhead;     // head pointer for when said
+
+	array<float, CMD_CLASS_TOTAL>	cmd_full_time;	// when each command bucket is full again
+	uint32_t						cmd_dropped;	// commands dropped by the limiter
 	
 	gtime	respawn_framenum;   // can respawn when time > this
 	
 	entityref	chase_target;      // player we are chasing
 	bool		update_chase;       // need to update chase info?
 
+	// the clients chasing us, linked through their chase_next/chase_prev.
+	// only change chase_target with SetChaseTarget so these stay right.
+	entityref	chasers;
+	entityref	chase_next, chase_prev;
+
 #ifdef THE_RECKONING
 	gtime	quadfire_framenum;
 	gtime	trap_framenum;
@@ -33,6 +33,7 @@ enum entity_type : uint32_t
 	ET_ROCKET,
 	ET_BFG_BLAST,
 	ET_DEBRIS,
+	ET_GIB,
 	ET_PLAYER,
 	ET_DISCONNECTED_PLAYER,
 	ET_DELAYED_USE,
@@ -289,6 +289,8 @@ static void Weapon_Grapple_Fire(entity &ent)
 	ent.client->ps.gunframe++;
 }
 
+static constexpr weapon_frames grapple_frames(5, 9, 31, 36, { 10, 18, 27 }, { 6 }, Weapon_Grapple_Fire);
+
 void CTFWeapon_Grapple(entity &ent)
 {
 	// if the the attack button is still down, stay in the firing frame
@@ -313,7 +315,7 @@ void CTFWeapon_Grapple(entity &ent)
 	}
 
 	const weapon_state prevstate = ent.client->g.weaponstate;
-	Weapon_Generic (ent, 5, 9, 31, 36, { 10, 18, 27 }, { 6 }, Weapon_Grapple_Fire);
+	Weapon_Generic(ent, grapple_frames);
 
 	// if we just switched back to grapple, immediately go to fire frame
 	if (prevstate == WEAPON_ACTIVATING &&
@@ -1,6 +1,7 @@
 #include "../lib/types.h"
 #include "../lib/entity.h"
 #include "../lib/gi.h"
+#include "../lib/entity_mirror.h"
 #include "combat.h"
 #include "util.h"
 #include "cmds.h"
@@ -755,6 +756,8 @@ static void bfg_touch(entity &self, entity &other, vector normal, const surface
 	self.g.touch = 0;
 	self.s.origin += ((-1 * FRAMETIME) * self.g.velocity);
 	self.g.velocity = vec3_origin;
+	// not relinked until it explodes
+	Mirror_Update(self);
 	self.s.modelindex = gi.modelindex("sprites/s_bfg3.sp2");
 	self.s.frame = 0;
 	self.s.sound = SOUND_NONE;
@@ -18,12 +18,10 @@ void DeathmatchScoreboardMessage(entity &ent, entityref killer)
 	}
 #endif
 
-	string entry;
-	string str;
-	size_t stringlength;
+	// the layout is limited to 1024 characters
+	format_buffer<1024 + 1> str;
 	dynarray<entityref> sorted;
 	int	x, y;
-	uint32_t j;
 	stringlit tag;
 
 	// sort the clients by score
@@ -38,7 +36,6 @@ void DeathmatchScoreboardMessage(entity &ent, entityref killer)
 	}
 
 	// print level name and exit rules
-	stringlength = 0;
 
 	std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b)
 	{
@@ -70,29 +67,25 @@ void DeathmatchScoreboardMessage(entity &ent, entityref killer)
 
 		if (tag)
 		{
-			entry = va("xv %i yv %i picn %s ", x + 32, y, tag);
-			j = strlen(entry);
-			if (stringlength + j > 1024)
+			const auto entry = strformat<64>("xv {} yv {} picn {} ", x + 32, y, tag);
+			if (str.size() + entry.size() > 1024)
 				break;
-			str = strconcat(str, entry);
-			stringlength += j;
+			str.append("{}", entry.view());
 		}
 
 		// send the layout
-		entry = va("client %i %i %i %i %i %i ", x, y, sorted[i]->s.number - 1, cl_ent->client->g.resp.score, cl_ent->client->ping, ((level.framenum - cl_ent->client->g.resp.enterframe) / 600));
-		j = strlen(entry);
+		const auto entry = strformat<64>("client {} {} {} {} {} {} ", x, y, sorted[i]->s.number - 1, cl_ent->client->g.resp.score, cl_ent->client->ping, ((level.framenum - cl_ent->client->g.resp.enterframe) / 600));
 
-		if (stringlength + j > 1024)
+		if (str.size() + entry.size() > 1024)
 			break;
 
-		str = strconcat(str, entry);
-		stringlength += j;
+		str.append("{}", entry.view());
 
 		i++;
 	}
 
 	gi.WriteByte(svc_layout);
-	gi.WriteString(str);
+	gi.WriteString(str.ptr());
 }
 
 /*
@@ -574,12 +567,11 @@ void G_SetSpectatorStats(entity &ent)
 
 void G_CheckChaseStats(entity &ent)
 {
-	for (uint32_t i = 1; i <= game.maxclients; i++)
+	for (entityref cl = ent.client->g.chasers; cl.has_value(); cl = cl->client->g.chase_next)
 	{
-		entity &cl = itoe(i);
-		if (!cl.inuse || cl.client->g.chase_target != ent)
+		if (!cl->inuse)
 			continue;
-		cl.client->ps.stats = ent.client->ps.stats;
+		cl->client->ps.stats = ent.client->ps.stats;
 		G_SetSpectatorStats(cl);
 	}
 }
@@ -0,0 +1,502 @@
+#include "../lib/types.h"
+#include "../lib/gi.h"
+#include "../lib/dynarray.h"
+#include "../lib/entity.h"
+#include "game.h"
+#include "util.h"
+#include "ipfilter.h"
+#include <bit>
+#include <cstdio>
+#include <ctime>
+
+/*
+==============
+The trie stores one node per distinct prefix length along a path, with
+single-child chains collapsed: every node either holds a filter or
+branches two ways. Node 0 is the root, the zero-length prefix that every
+address falls under; it holds a filter only if "0.0.0.0/0" was added.
+Child links are node indices, with 0 meaning none since the root can't be
+anyone's child.
+==============
+*/
+struct ip_node
+{
+	uint32_t	prefix;
+	uint8_t		bits;
+	bool		listed;
+	// time() the filter lapses at; 0 for never
+	int64_t		expires;
+	uint32_t	child[2];
+};
+
+static dynarray<ip_node> ip_nodes;
+static dynarray<uint32_t> ip_free_nodes;
+static uint32_t ip_num_filters;
+
+static constexpr uint32_t IP_Mask(uint8_t bits)
+{
+	return bits ? ~0u << (32 - bits) : 0;
+}
+
+static constexpr uint32_t IP_Bit(uint32_t addr, uint8_t bit)
+{
+	return (addr >> (31 - bit)) & 1;
+}
+
+static inline int64_t IP_Now()
+{
+	return (int64_t)std::time(nullptr);
+}
+
+static inline bool IP_Active(const ip_node &node, int64_t now)
+{
+	return node.listed && (!node.expires || node.expires > now);
+}
+
+static uint32_t IP_NewNode(uint32_t prefix, uint8_t bits)
+{
+	uint32_t index;
+
+	if (ip_free_nodes.size())
+	{
+		index = ip_free_nodes.back();
+		ip_free_nodes.pop_back();
+	}
+	else
+	{
+		index = (uint32_t)ip_nodes.size();
+		ip_nodes.emplace_back();
+	}
+
+	ip_nodes[index] = { prefix & IP_Mask(bits), bits, false, 0, { 0, 0 } };
+	return index;
+}
+
+static void IP_FreeNode(uint32_t index)
+{
+	ip_nodes[index].listed = false;
+	ip_free_nodes.push_back(index);
+}
+
+static void IP_Insert(uint32_t prefix, uint8_t bits, int64_t expires)
+{
+	if (ip_nodes.empty())
+		IP_NewNode(0, 0);
+
+	prefix &= IP_Mask(bits);
+
+	uint32_t n = 0;
+	uint32_t target;
+
+	while (true)
+	{
+		// n's prefix is a prefix of ours
+		if (ip_nodes[n].bits == bits)
+		{
+			target = n;
+			break;
+		}
+
+		const uint32_t side = IP_Bit(prefix, ip_nodes[n].bits);
+		const uint32_t c = ip_nodes[n].child[side];
+
+		if (!c)
+		{
+			target = IP_NewNode(prefix, bits);
+			ip_nodes[n].child[side] = target;
+			break;
+		}
+
+		const ip_node &child = ip_nodes[c];
+		const uint8_t common = (uint8_t)min(min((uint32_t)std::countl_zero(prefix ^ child.prefix), (uint32_t)bits), (uint32_t)child.bits);
+
+		if (common == child.bits)
+		{
+			n = c;
+			continue;
+		}
+
+		// we diverge from the child partway down its edge, so
+		// it needs a new parent where that happens
+		const uint32_t split = IP_NewNode(prefix, common);
+		ip_nodes[split].child[IP_Bit(ip_nodes[c].prefix, common)] = c;
+		ip_nodes[n].child[side] = split;
+
+		if (common == bits)
+			target = split;
+		else
+		{
+			target = IP_NewNode(prefix, bits);
+			ip_nodes[split].child[IP_Bit(prefix, common)] = target;
+		}
+		break;
+	}
+
+	ip_node &node = ip_nodes[target];
+
+	if (!node.listed)
+		ip_num_filters++;
+
+	node.listed = true;
+	node.expires = expires;
+}
+
+static bool IP_Erase(uint32_t prefix, uint8_t bits)
+{
+	if (ip_nodes.empty())
+		return false;
+
+	prefix &= IP_Mask(bits);
+
+	// the path down, so emptied nodes can be unlinked on the way back
+	array<uint32_t, 34> path;
+	size_t depth = 0;
+	uint32_t n = 0;
+
+	while (true)
+	{
+		const ip_node &node = ip_nodes[n];
+
+		if (node.bits > bits || ((prefix ^ node.prefix) & IP_Mask(node.bits)))
+			return false;
+
+		path[depth++] = n;
+
+		if (node.bits == bits)
+			break;
+
+		if (!(n = node.child[IP_Bit(prefix, node.bits)]))
+			return false;
+	}
+
+	if (!ip_nodes[n].listed)
+		return false;
+
+	ip_nodes[n].listed = false;
+	ip_num_filters--;
+
+	// collapse anything left neither holding a filter nor branching
+	while (depth > 1)
+	{
+		const uint32_t index = path[--depth];
+		const ip_node &node = ip_nodes[index];
+
+		if (node.listed || (node.child[0] && node.child[1]))
+			break;
+
+		ip_node &parent = ip_nodes[path[depth - 1]];
+		parent.child[parent.child[1] == index] = node.child[0] | node.child[1];
+		IP_FreeNode(index);
+	}
+
+	return true;
+}
+
+// whether any unexpired filter covers addr
+static bool IP_Matches(uint32_t addr)
+{
+	if (ip_nodes.empty())
+		return false;
+
+	const int64_t now = IP_Now();
+	uint32_t n = 0;
+
+	while (true)
+	{
+		const ip_node &node = ip_nodes[n];
+
+		if ((addr ^ node.prefix) & IP_Mask(node.bits))
+			return false;
+		else if (IP_Active(node, now))
+			return true;
+		else if (node.bits == 32 || !(n = node.child[IP_Bit(addr, node.bits)]))
+			return false;
+	}
+}
+
+template<typename TFunc>
+static void IP_Walk(uint32_t n, TFunc &&func)
+{
+	const ip_node &node = ip_nodes[n];
+
+	if (node.listed)
+		func(node);
+
+	for (const uint32_t c : node.child)
+		if (c)
+			IP_Walk(c, func);
+}
+
+// remove every filter that has lapsed
+static void IP_Prune()
+{
+	if (ip_nodes.empty())
+		return;
+
+	const int64_t now = IP_Now();
+	dynarray<std::pair<uint32_t, uint8_t>> expired;
+
+	IP_Walk(0, [&](const ip_node &node) {
+		if (!IP_Active(node, now))
+			expired.push_back({ node.prefix, node.bits });
+	});
+
+	for (auto &filter : expired)
+		IP_Erase(filter.first, filter.second);
+}
+
+// parse up to four dotted octets; returns how many were read
+static uint32_t IP_ParseOctets(std::string_view &s, uint32_t &addr)
+{
+	uint32_t octets = 0;
+	addr = 0;
+
+	while (octets < 4 && s.size() && s[0] >= '0' && s[0] <= '9')
+	{
+		uint32_t value = 0;
+		size_t len = 0;
+
+		for (; len < s.size() && s[len] >= '0' && s[len] <= '9'; len++)
+			if ((value = value * 10 + (s[len] - '0')) > 255)
+				return 0;
+
+		addr |= value << (24 - octets++ * 8);
+		s.remove_prefix(len);
+
+		if (s.size() && s[0] == '.')
+			s.remove_prefix(1);
+		else
+			break;
+	}
+
+	return octets;
+}
+
+/*
+==============
+IP_ParseFilter
+
+"a.b.c.d/n", or up to four octets with each missing
+one matching anything, as the stock addip does. The stock
+game also treats 0 octets as wildcards, so "192.168.0.0" is
+a /16; trailing zeros are dropped from the prefix to match.
+==============
+*/
+static bool IP_ParseFilter(std::string_view s, uint32_t &prefix, uint8_t &bits)
+{
+	const uint32_t octets = IP_ParseOctets(s, prefix);
+
+	if (!octets)
+		return false;
+
+	bits = (uint8_t)(octets * 8);
+
+	if (s.size() && s[0] == '/')
+	{
+		s.remove_prefix(1);
+
+		uint32_t value = 0;
+		size_t len = 0;
+
+		for (; len < s.size() && len < 2 && s[len] >= '0' && s[len] <= '9'; len++)
+			value = value * 10 + (s[len] - '0');
+
+		if (!len || value > 32)
+			return false;
+
+		bits = (uint8_t)value;
+		s.remove_prefix(len);
+	}
+	else
+	{
+		while (bits && !((prefix >> (32 - bits)) & 255))
+			bits -= 8;
+	}
+
+	return s.empty();
+}
+
+static string IP_FilterString(uint32_t prefix, uint8_t bits)
+{
+	return va("%u.%u.%u.%u/%u", prefix >> 24, (prefix >> 16) & 255, (prefix >> 8) & 255, prefix & 255, bits);
+}
+
+bool IPFilter_Rejected(const std::string_view &ip)
+{
+	std::string_view s = ip;
+	uint32_t addr;
+
+	// loopback and anything else that isn't a plain address
+	// is never filtered
+	if (IP_ParseOctets(s, addr) != 4 || (s.size() && s[0] != ':'))
+		return false;
+
+	return IP_Matches(addr) == (bool)filterban;
+}
+
+void IPFilter_Add()
+{
+	if (gi.argc() < 3)
+	{
+		gi.dprintf("usage: sv addip <ip-mask> [minutes]\n");
+		return;
+	}
+
+	uint32_t prefix;
+	uint8_t bits;
+
+	if (!IP_ParseFilter(gi.argv(2), prefix, bits))
+	{
+		gi.dprintf("Bad filter address: %s\n", gi.argv(2));
+		return;
+	}
+
+	const int32_t minutes = gi.argc() > 3 ? atoi(gi.argv(3)) : 0;
+
+	IP_Insert(prefix, bits, minutes > 0 ? IP_Now() + minutes * 60 : 0);
+}
+
+void IPFilter_Remove()
+{
+	if (gi.argc() < 3)
+	{
+		gi.dprintf("usage: sv removeip <ip-mask>\n");
+		return;
+	}
+
+	uint32_t prefix;
+	uint8_t bits;
+
+	if (!IP_ParseFilter(gi.argv(2), prefix, bits))
+	{
+		gi.dprintf("Bad filter address: %s\n", gi.argv(2));
+		return;
+	}
+
+	if (IP_Erase(prefix, bits))
+		gi.dprintf("Removed.\n");
+	else
+		gi.dprintf("Didn't find %s.\n", gi.argv(2));
+}
+
+void IPFilter_List()
+{
+	IP_Prune();
+
+	gi.dprintf("Filter list: %u filters, %u nodes\n", ip_num_filters, (uint32_t)(ip_nodes.size() - ip_free_nodes.size()));
+
+	if (!ip_num_filters)
+		return;
+
+	const int64_t now = IP_Now();
+
+	IP_Walk(0, [now](const ip_node &node) {
+		if (node.expires)
+			gi.dprintf("%-18s %i min\n", IP_FilterString(node.prefix, node.bits).ptr(), (int32_t)((node.expires - now + 59) / 60));
+		else
+			gi.dprintf("%s\n", IP_FilterString(node.prefix, node.bits).ptr());
+	});
+}
+
+/*
+==============
+listip.dat
+
+The magic and version, then a uint32 count of filters and the filters
+themselves, each a uint32 prefix, a uint8 length and an int64 expiry
+time, little-endian and unpadded.
+==============
+*/
+constexpr size_t IPFILTER_RECORD_SIZE = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(int64_t);
+
+void IPFilter_Write()
+{
+	IP_Prune();
+
+	dynarray<uint8_t> buffer;
+	buffer.reserve(sizeof(uint32_t) * 3 + ip_num_filters * IPFILTER_RECORD_SIZE);
+
+	auto write = [&buffer](const auto &value) {
+		buffer.insert(buffer.end(), (const uint8_t *)&value, (const uint8_t *)&value + sizeof(value));
+	};
+
+	write(IPFILTER_MAGIC);
+	write(IPFILTER_VERSION);
+	write(ip_num_filters);
+
+	if (ip_num_filters)
+		IP_Walk(0, [&write](const ip_node &node) {
+			write(node.prefix);
+			write(node.bits);
+			write(node.expires);
+		});
+
+	string filename = G_GamePath("listip", "dat");
+	std::FILE *fp;
+
+	if (fopen_s(&fp, filename.ptr(), "wb") || !fp)
+	{
+		gi.dprintf("Couldn't open %s\n", filename.ptr());
+		return;
+	}
+
+	const bool ok = std::fwrite(buffer.data(), 1, buffer.size(), fp) == buffer.size();
+	std::fclose(fp);
+
+	if (ok)
+		gi.dprintf("Writing %s.\n", filename.ptr());
+	else
+		gi.dprintf("Couldn't write %s\n", filename.ptr());
+}
+
+void IPFilter_Load()
+{
+	string filename = G_GamePath("listip", "dat");
+	std::FILE *fp;
+
+	if (fopen_s(&fp, filename.ptr(), "rb") || !fp)
+		return;
+
+	uint32_t magic, version, count;
+
+	if (std::fread(&magic, sizeof(magic), 1, fp) != 1 || magic != IPFILTER_MAGIC ||
+		std::fread(&version, sizeof(version), 1, fp) != 1 || version != IPFILTER_VERSION ||
+		std::fread(&count, sizeof(count), 1, fp) != 1)
+	{
+		gi.dprintf("%s isn't a filter list, ignoring it\n", filename.ptr());
+		std::fclose(fp);
+		return;
+	}
+
+	const int64_t now = IP_Now();
+	uint32_t loaded = 0;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		array<uint8_t, IPFILTER_RECORD_SIZE> record;
+
+		if (std::fread(record.data(), record.size(), 1, fp) != 1)
+		{
+			gi.dprintf("%s is truncated\n", filename.ptr());
+			break;
+		}
+
+		uint32_t prefix;
+		uint8_t bits;
+		int64_t expires;
+
+		memcpy(&prefix, record.data(), sizeof(prefix));
+		memcpy(&bits, record.data() + sizeof(prefix), sizeof(bits));
+		memcpy(&expires, record.data() + sizeof(prefix) + sizeof(bits), sizeof(expires));
+
+		if (bits > 32 || (expires && expires <= now))
+			continue;
+
+		IP_Insert(prefix, bits, expires);
+		loaded++;
+	}
+
+	std::fclose(fp);
+
+	gi.dprintf("Loaded %u IP filters from %s\n", loaded, filename.ptr());
+}
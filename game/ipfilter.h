@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../lib/types.h"
+#include <string_view>
+
+/*
+==============
+IP filtering
+
+Filters are IPv4 prefixes, either classic partial addresses ("192.168"
+or "192.168.0.0" filters 192.168.0.0/16) or CIDR ("10.0.0.0/8"), optionally expiring after
+a number of minutes. They're kept in a compressed radix trie, so checking
+an address walks at most 32 bits no matter how many thousands of entries
+an imported blocklist adds, which matters because it happens on every
+connection attempt.
+
+As with the stock game, filterban 1 rejects addresses that match a
+filter and filterban 0 only lets matching addresses in.
+
+"sv addip <ip> [minutes]", "sv removeip <ip>", "sv listip" and
+"sv writeip" manage the list; writeip saves it to listip.dat in the game
+directory, which is read back whenever the game starts.
+==============
+*/
+
+constexpr uint32_t IPFILTER_MAGIC = 'L' << 24 | 'P' << 16 | 'I' << 8 | 'Q';
+constexpr uint32_t IPFILTER_VERSION = 1;
+
+// whether a client connecting from the given userinfo "ip" value
+// should be turned away
+bool IPFilter_Rejected(const std::string_view &ip);
+
+// load listip.dat, if there is one
+void IPFilter_Load();
+
+// "sv addip <ip> [minutes]"
+void IPFilter_Add();
+
+// "sv removeip <ip>"
+void IPFilter_Remove();
+
+// "sv listip"
+void IPFilter_List();
+
+// "sv writeip"
+void IPFilter_Write();
@@ -65,27 +65,29 @@ inline const gitem_t &GetItemByIndex(const gitem_id &id)
 /*
 ===============
 FindItemByClassname
+
+Case-insensitive lookup through a perfect hash
+built by InitItems.
 ===============
 */
-inline itemref FindItemByClassname(const stringref &classname)
-{
-	for (const gitem_t &item : item_list())
-		if (striequals(item.classname, classname))
-			return item;
-
-	return nullptr;
-}
+itemref FindItemByClassname(const stringref &classname);
 
 /*
 ===============
 FindItem
+
+Case-insensitive lookup through a perfect hash
+built by InitItems.
 ===============
 */
-inline itemref FindItem(const stringref &pickup_name)
-{
-	for (const gitem_t &item : item_list())
-		if (striequals(item.pickup_name, pickup_name))
-			return item;
+itemref FindItem(const stringref &pickup_name);
 
-	return nullptr;
-}
\ No newline at end of file
+/*
+===============
+BenchmarkItemLookups
+
+Times spawn-time item resolution against a synthetic
+map with the specified number of entities.
+===============
+*/
+void BenchmarkItemLookups(size_t num_entities);
\ No newline at end of file
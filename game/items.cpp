@@ -8,6 +8,8 @@
 #ifdef GRAPPLE
 #include "grapple.h"
 #endif
+#include <bit>
+#include <chrono>
 
 // forward declarations from this file
 
@@ -1475,6 +1477,162 @@ const array<gitem_t, ITEM_TOTAL> &item_list()
 	return itemlist;
 }
 
+/*
+==============================================================================
+
+ITEM LOOKUP
+
+The item list never changes after startup, so classname and pickup_name
+lookups go through perfect hash tables: a seed is searched for in InitItems
+that maps every name in the list to its own slot. A lookup is then one hash,
+one slot load and one string compare.
+
+==============================================================================
+*/
+
+// big enough that a collision-free seed is found within a few dozen tries
+constexpr size_t ITEM_HASH_SIZE = std::bit_ceil((size_t)ITEM_TOTAL * 4);
+
+struct item_hash
+{
+	uint32_t						seed;
+	array<gitem_id, ITEM_HASH_SIZE>	slots;
+};
+
+static item_hash classname_hash, pickup_name_hash;
+
+// case-insensitive FNV-1a
+static inline uint32_t ItemHash_Key(stringlit name, const uint32_t &seed)
+{
+	uint32_t hash = 2166136261u ^ seed;
+
+	for (; *name; name++)
+		hash = (hash ^ (uint8_t)tolower(*name)) * 16777619u;
+
+	return hash & (ITEM_HASH_SIZE - 1);
+}
+
+static void ItemHash_Build(item_hash &table, stringlit gitem_t::*member, stringlit name)
+{
+	for (table.seed = 0; table.seed < 65536; table.seed++)
+	{
+		table.slots.fill(ITEM_NONE);
+
+		bool collided = false;
+
+		for (auto &it : itemlist)
+		{
+			stringlit key = it.*member;
+
+			if (!it.id || !key || !*key)
+				continue;
+
+			gitem_id &slot = table.slots[ItemHash_Key(key, table.seed)];
+
+			if (slot != ITEM_NONE)
+			{
+				// two items with the same name; the linear search always picked
+				// the first one, so keep doing that
+				if (!stricmp(itemlist[slot].*member, key))
+					continue;
+
+				collided = true;
+				break;
+			}
+
+			slot = it.id;
+		}
+
+		if (!collided)
+			return;
+	}
+
+	gi.error("%s: couldn't build perfect hash for %s", __func__, name);
+}
+
+static inline itemref ItemHash_Find(const item_hash &table, stringlit gitem_t::*member, const stringref &name)
+{
+	if (!name)
+		return nullptr;
+
+	const gitem_id id = table.slots[ItemHash_Key(name.ptr(), table.seed)];
+
+	if (id == ITEM_NONE || stricmp(itemlist[id].*member, name))
+		return nullptr;
+
+	return itemlist[id];
+}
+
+itemref FindItemByClassname(const stringref &classname)
+{
+	return ItemHash_Find(classname_hash, &gitem_t::classname, classname);
+}
+
+itemref FindItem(const stringref &pickup_name)
+{
+	return ItemHash_Find(pickup_name_hash, &gitem_t::pickup_name, pickup_name);
+}
+
+void BenchmarkItemLookups(size_t num_entities)
+{
+	// a rough mix of a real DM map: about a third items, the rest
+	// spawn points, brush models, triggers and lights
+	static constexpr stringlit other_classnames[] = {
+		"info_player_deathmatch", "func_door", "func_plat", "trigger_multiple",
+		"light", "target_speaker", "misc_teleporter", "path_corner"
+	};
+
+	dynarray<stringlit> classnames;
+	classnames.reserve(num_entities);
+
+	for (size_t i = 0; i < num_entities; i++)
+	{
+		if (i % 3 == 0)
+		{
+			const gitem_t &it = itemlist[1 + (i / 3) % (ITEM_TOTAL - 1)];
+
+			if (it.classname)
+			{
+				classnames.push_back(it.classname);
+				continue;
+			}
+		}
+
+		classnames.push_back(other_classnames[i % lengthof(other_classnames)]);
+	}
+
+	constexpr size_t passes = 100;
+	size_t found_linear = 0, found_hashed = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t pass = 0; pass < passes; pass++)
+		for (stringlit classname : classnames)
+			for (const gitem_t &it : itemlist)
+				if (it.classname && !stricmp(it.classname, classname))
+				{
+					found_linear++;
+					break;
+				}
+
+	const double linear_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / passes;
+
+	start = std::chrono::steady_clock::now();
+
+	for (size_t pass = 0; pass < passes; pass++)
+		for (stringlit classname : classnames)
+			if (FindItemByClassname(classname).has_value())
+				found_hashed++;
+
+	const double hashed_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / passes;
+
+	gi.dprintf("item lookup, %u entities (%u items): linear %.3fms, hashed %.3fms\n", (uint32_t)num_entities,
+		(uint32_t)(found_hashed / passes), linear_time * 1000, hashed_time * 1000);
+
+	if (found_linear != found_hashed)
+		gi.dprintf("WARNING: linear search found %u items, hash found %u\n", (uint32_t)(found_linear / passes), (uint32_t)(found_hashed / passes));
+}
+
 void InitItems()
 {
 	uint8_t weapon_id = 1;
@@ -1486,6 +1644,9 @@ void InitItems()
 		if (it.vwep_model)
 			it.vwep_id = weapon_id++;
 	}
+
+	ItemHash_Build(classname_hash, &gitem_t::classname, "classname");
+	ItemHash_Build(pickup_name_hash, &gitem_t::pickup_name, "pickup_name");
 }
 
 static gtime quad_drop_timeout_hack;
@@ -1,6 +1,7 @@
 #include "../lib/types.h"
 #include "../lib/entity.h"
 #include "../lib/gi.h"
+#include "../lib/entity_mirror.h"
 #include "misc.h"
 #include "game.h"
 #include "util.h"
@@ -50,6 +51,145 @@ void ClipGibVelocity(entity &ent)
 }
 
 
+/*
+=================
+debris pool
+
+Gibs and debris chunks are purely cosmetic, but a single explosion can
+throw dozens of them. Every live chunk is tracked in a fixed ring, oldest
+first; once g_debris_max are alive the oldest one is recycled, and once
+g_debris_per_frame have been thrown in a frame the rest are drawn as
+temp entity effects instead of being spawned.
+=================
+*/
+constexpr size_t MAX_DEBRIS = 256;
+
+struct debris_slot
+{
+	uint32_t	number;
+	gtime		spawned;
+};
+
+static struct
+{
+	array<debris_slot, MAX_DEBRIS>	slots;
+	size_t							head, count;
+	gtime							frame;
+	uint32_t						thrown;
+} debris_pool;
+
+static struct
+{
+	uint32_t	spawned, evicted, culled, peak;
+} debris_counters;
+
+static inline debris_slot &Debris_Slot(size_t index)
+{
+	return debris_pool.slots[(debris_pool.head + index) % MAX_DEBRIS];
+}
+
+// a slot is only live if the entity it points to is still the
+// chunk that was thrown into it; anything freed by its own think
+// or by being shot is dropped
+static bool Debris_Live(const debris_slot &slot)
+{
+	const entity &e = itoe(slot.number);
+	return e.inuse && (e.g.type == ET_GIB || e.g.type == ET_DEBRIS) && e.g.timestamp == slot.spawned;
+}
+
+// squeeze dead slots out of the ring, keeping spawn order
+static void Debris_Compact()
+{
+	size_t live = 0;
+
+	for (size_t i = 0; i < debris_pool.count; i++)
+	{
+		const debris_slot slot = Debris_Slot(i);
+
+		if (Debris_Live(slot))
+			Debris_Slot(live++) = slot;
+	}
+
+	debris_pool.count = live;
+}
+
+static void Debris_Effect(vector origin, temp_event effect)
+{
+	gi.WriteByte(svc_temp_entity);
+	gi.WriteByte(effect);
+	gi.WritePosition(origin);
+	gi.WriteDir(MOVEDIR_UP);
+	gi.multicast(origin, MULTICAST_PVS);
+}
+
+// returns a fresh entity for a gib or debris chunk, or an empty
+// reference if the budget is spent and the effect was drawn instead
+static entityref Debris_Spawn(entity_type type, vector origin, temp_event fallback)
+{
+	if (debris_pool.frame != level.framenum)
+	{
+		debris_pool.frame = level.framenum;
+		debris_pool.thrown = 0;
+	}
+
+	const size_t limit = (size_t)clamp(0, (int32_t)g_debris_max, (int32_t)MAX_DEBRIS);
+	const int32_t per_frame = (int32_t)g_debris_per_frame;
+
+	if (!limit || (per_frame > 0 && debris_pool.thrown >= (uint32_t)per_frame))
+	{
+		debris_counters.culled++;
+		Debris_Effect(origin, fallback);
+		return nullptr;
+	}
+
+	debris_pool.thrown++;
+
+	if (debris_pool.count >= limit)
+		Debris_Compact();
+
+	// recycle the oldest chunks
+	while (debris_pool.count >= limit)
+	{
+		const debris_slot &oldest = Debris_Slot(0);
+
+		if (Debris_Live(oldest))
+		{
+			G_FreeEdict(itoe(oldest.number));
+			debris_counters.evicted++;
+		}
+
+		debris_pool.head = (debris_pool.head + 1) % MAX_DEBRIS;
+		debris_pool.count--;
+	}
+
+	entity &e = G_Spawn();
+	e.s.origin = origin;
+	e.g.type = type;
+	e.g.timestamp = level.framenum;
+
+	Debris_Slot(debris_pool.count++) = { (uint32_t)e.s.number, level.framenum };
+
+	debris_counters.spawned++;
+	debris_counters.peak = max(debris_counters.peak, (uint32_t)debris_pool.count);
+
+	return e;
+}
+
+void Debris_Clear()
+{
+	debris_pool.head = debris_pool.count = 0;
+	debris_pool.thrown = 0;
+}
+
+void Debris_Stats()
+{
+	Debris_Compact();
+
+	gi.dprintf("debris: %u live (limit %i, %i per frame), peak %u\n", (uint32_t)debris_pool.count, (int32_t)g_debris_max,
+		(int32_t)g_debris_per_frame, debris_counters.peak);
+	gi.dprintf("%u spawned, %u evicted, %u culled to effects\n", debris_counters.spawned, debris_counters.evicted, debris_counters.culled);
+}
+
 /*
 =================
 gibs
@@ -63,7 +203,7 @@ static void gib_think(entity &self)
 	if (self.s.frame == 10)
 	{
 		self.g.think = G_FreeEdict;
-		self.g.nextthink = level.framenum + (gtime)(random(8.f, 18.f) * BASE_FRAMERATE);
+		self.g.nextthink = level.framenum + (gtime)(rng_effects.random(8.f, 18.f) * BASE_FRAMERATE);
 	}
 }
 
@@ -98,11 +238,15 @@ void gib_die(entity &self, entity &, entity &, int32_t, vector)
 
 void ThrowGib(entity &self, stringlit gibname, int32_t damage, gib_type type)
 {
-	entity &gib = G_Spawn();
-
 	vector sz = self.size * 0.5f;
-	vector origin = self.absmin + sz;
-	gib.s.origin = origin + randomv(-sz, sz);
+	vector origin = self.absmin + sz + randomv(-sz, sz, rng_effects);
+
+	entityref spawned = Debris_Spawn(ET_GIB, origin, type == GIB_ORGANIC ? TE_BLOOD : TE_SPARKS);
+
+	if (!spawned.has_value())
+		return;
+
+	entity &gib = spawned;
 
 	gi.setmodel(gib, gibname);
 	gib.solid = SOLID_NOT;
@@ -127,10 +271,10 @@ void ThrowGib(entity &self, stringlit gibname, int32_t damage, gib_type type)
 
 	gib.g.velocity = self.g.velocity + (vscale * VelocityForDamage(damage));
 	ClipGibVelocity(gib);
-	gib.g.avelocity = randomv({ 600, 600, 600 });
+	gib.g.avelocity = randomv({ 600, 600, 600 }, rng_effects);
 
 	gib.g.think = G_FreeEdict;
-	gib.g.nextthink = level.framenum + (gtime)(random(10.f, 20.f) * BASE_FRAMERATE);
+	gib.g.nextthink = level.framenum + (gtime)(rng_effects.random(10.f, 20.f) * BASE_FRAMERATE);
 
 	gi.linkentity(gib);
 }
@@ -170,10 +314,10 @@ void ThrowHead(entity &self, stringlit gibname, int32_t damage, gib_type type)
 	self.g.velocity += (vscale * VelocityForDamage(damage));
 	ClipGibVelocity(self);
 
-	self.g.avelocity[YAW] = random(-600.f, 600.f);
+	self.g.avelocity[YAW] = rng_effects.random(-600.f, 600.f);
 
 	self.g.think = G_FreeEdict;
-	self.g.nextthink = level.framenum + (gtime)(random(10.f, 20.f) * BASE_FRAMERATE);
+	self.g.nextthink = level.framenum + (gtime)(rng_effects.random(10.f, 20.f) * BASE_FRAMERATE);
 
 	gi.linkentity(self);
 }
@@ -182,7 +326,7 @@ void ThrowClientHead(entity &self, int32_t damage)
 {
 	stringlit	gibname;
 
-	if (Q_rand() & 1)
+	if (rng_effects() & 1)
 	{
 		gibname = "models/objects/gibs/head2/tris.md2";
 		self.s.skinnum = 1;        // second skin is player
@@ -231,21 +375,24 @@ void ThrowDebris(entity &self, stringlit modelname, float speed, vector origin)
 {
 	vector v;
 
-	entity &chunk = G_Spawn();
-	chunk.s.origin = origin;
+	entityref spawned = Debris_Spawn(ET_DEBRIS, origin, TE_SPARKS);
+
+	if (!spawned.has_value())
+		return;
+
+	entity &chunk = spawned;
 	gi.setmodel(chunk, modelname);
-	v.x = random(-100.f, 100.f);
-	v.y = random(-100.f, 100.f);
-	v.z = random(0.f, 200.f);
+	v.x = rng_effects.random(-100.f, 100.f);
+	v.y = rng_effects.random(-100.f, 100.f);
+	v.z = rng_effects.random(0.f, 200.f);
 	chunk.g.velocity = self.g.velocity + (speed * v);
 	chunk.g.movetype = MOVETYPE_BOUNCE;
 	chunk.solid = SOLID_NOT;
-	chunk.g.avelocity = randomv({ 600, 600, 600 });
+	chunk.g.avelocity = randomv({ 600, 600, 600 }, rng_effects);
 	chunk.g.think = G_FreeEdict;
-	chunk.g.nextthink = level.framenum + (gtime)(random(5.f, 10.f) * BASE_FRAMERATE);
+	chunk.g.nextthink = level.framenum + (gtime)(rng_effects.random(5.f, 10.f) * BASE_FRAMERATE);
 	chunk.s.frame = 0;
 	chunk.g.flags = FL_NONE;
-	chunk.g.type = ET_DEBRIS;
 	chunk.g.takedamage = true;
 	chunk.g.die = gib_die;
 	gi.linkentity(chunk);
@@ -422,6 +569,7 @@ static void SP_info_notnull(entity &self)
 {
 	self.absmin = self.s.origin;
 	self.absmax = self.s.origin;
+	Mirror_Update(self);
 }
 
 REGISTER_ENTITY(info_notnull, ET_INFO_NOTNULL);
@@ -683,7 +831,7 @@ static void(entity self, entity inflictor, entity attacker, int damage, vector p
 		if (count > 8)
 			count = 8;
 		while (count--) {
-			chunkorigin = origin + randomv(-csize, csize);
+			chunkorigin = origin + randomv(-csize, csize, rng_effects);
 			ThrowDebris(self, "models/objects/debris1/tris.md2", 1, chunkorigin);
 		}
 	}
@@ -693,7 +841,7 @@ static void(entity self, entity inflictor, entity attacker, int damage, vector p
 	if (count > 16)
 		count = 16;
 	while (count--) {
-		chunkorigin = origin + randomv(-csize, csize);
+		chunkorigin = origin + randomv(-csize, csize, rng_effects);
 		ThrowDebris(self, "models/objects/debris2/tris.md2", 2, chunkorigin);
 	}
 
@@ -858,9 +1006,9 @@ static void(entity self) barrel_explode =
 
 	// a few big chunks
 	spd = 1.5f * (float)self.dmg / 200.0f;
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris1/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris1/tris.md2", spd, org);
 
 	// bottom corners
@@ -880,21 +1028,21 @@ static void(entity self) barrel_explode =
 
 	// a bunch of little chunks
 	spd = 2f * self.dmg / 200f;
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
-	org = self.s.origin + randomv(-self.size, self.size);
+	org = self.s.origin + randomv(-self.size, self.size, rng_effects);
 	ThrowDebris(self, "models/objects/debris2/tris.md2", spd, org);
 
 	self.s.origin = save;
@@ -4,7 +4,7 @@
 
 inline vector VelocityForDamage(int damage)
 {
-	return randomv({ -100, -100, 200 }, { 100, 100, 300 }) * ((damage < 50) ? 0.7f : 1.2f);
+	return randomv({ -100, -100, 200 }, { 100, 100, 300 }, rng_effects) * ((damage < 50) ? 0.7f : 1.2f);
 }
 
 void ClipGibVelocity(entity &ent);
@@ -28,6 +28,12 @@ void ThrowClientHead(entity &self, int32_t damage);
 
 void ThrowDebris(entity &self, stringlit modelname, float speed, vector origin);
 
+// forget every tracked gib and debris chunk; called when a new level starts
+void Debris_Clear();
+
+// print the gib and debris pool counters
+void Debris_Stats();
+
 void misc_viper_use(entity &self, entity &other, entity &cactivator);
 
 void misc_strogg_ship_use(entity &self, entity &other, entity &cactivator);
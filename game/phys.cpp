@@ -2,9 +2,11 @@
 #include "../lib/entity.h"
 #include "../lib/gi.h"
 #include "../lib/set.h"
+#include "../lib/entity_mirror.h"
 #include "game.h"
 #include "phys.h"
 #include "util.h"
+#include "profile.h"
 
 /*
 
@@ -337,11 +339,23 @@ static bool SV_Push(entity &pusher, vector move, vector amove)
 	pusher.s.angles += amove;
 	gi.linkentity(pusher);
 
-// see if any solid entities are inside the final position
+// see if any solid entities are inside the final position. the mirror
+// has everyone's linked bounds, so they're all tested against the move in
+// one go; moving one only relinks that entity, so bounds tested ahead of
+// time are still the ones the check would have read.
+	static array<uint8_t, MAX_EDICTS> overlaps;
+
+	VectorBatch_BoxesOverlap(ent_mirror.absmins(0, num_entities), ent_mirror.absmaxs(0, num_entities), mins, maxs, overlaps.data());
+
 	for (uint32_t e = 1; e < num_entities; e++)
 	{
+		if (!ent_mirror.has(e, MIRROR_INUSE | MIRROR_LINKED))
+			continue;
+
 		entity &check = itoe(e);
-		if (!check.inuse)
+
+		// riders get moved whether they overlap or not
+		if (!overlaps[e] && check.g.groundentity != pusher)
 			continue;
 		if (check.g.movetype == MOVETYPE_PUSH
 			|| check.g.movetype == MOVETYPE_STOP
@@ -349,21 +363,9 @@ static bool SV_Push(entity &pusher, vector move, vector amove)
 			|| check.g.movetype == MOVETYPE_NOCLIP)
 			continue;
 
-		if (!check.is_linked())
-			continue;       // not linked in anywhere
-
 		// if the entity is standing on the pusher, it will definitely be moved
 		if (check.g.groundentity != pusher)
 		{
-			// see if the ent needs to be tested
-			if (check.absmin.x >= maxs.x
-				|| check.absmin.y >= maxs.y
-				|| check.absmin.z >= maxs.z
-				|| check.absmax.x <= mins.x
-				|| check.absmax.y <= mins.y
-				|| check.absmax.z <= mins.z)
-				continue;
-
 			// see if the ent's bbox is inside the pusher's final position
 			if (!SV_TestEntityPosition(check))
 				continue;
@@ -830,6 +832,8 @@ G_RunEntity
 */
 void G_RunEntity(entity &ent)
 {
+	PROFILE_ZONE("G_RunEntity");
+
 	if (ent.g.prethink)
 		ent.g.prethink(ent);
 
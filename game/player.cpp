@@ -2,6 +2,7 @@
 #include "../lib/entity.h"
 #include "../lib/info.h"
 #include "../lib/gi.h"
+#include "../lib/entity_mirror.h"
 #include "combat.h"
 #include "game.h"
 #include "itemlist.h"
@@ -15,6 +16,9 @@
 #include "view.h"
 #include "spawn.h"
 #include "m_player.h"
+#include "profile.h"
+#include "pmove.h"
+#include "ipfilter.h"
 #ifdef BOTS
 #include "ai/aimain.h"
 #endif
@@ -310,7 +314,7 @@ static void ClientObituary(entity &self, entity &attacker)
 
 	if (message)
 	{
-		gi.bprintf(PRINT_MEDIUM, "%s %s.\n", self.client->g.pers.netname.ptr(), message.ptr());
+		G_Broadcast(G_PrintMessage(PRINT_MEDIUM, "%s %s.\n", self.client->g.pers.netname.ptr(), message.ptr()));
 #ifdef SINGLE_PLAYER
 		if (deathmatch.intVal)
 #endif
@@ -447,7 +451,7 @@ static void ClientObituary(entity &self, entity &attacker)
 
 		if (message)
 		{
-			gi.bprintf(PRINT_MEDIUM, "%s %s %s%s\n", self.client->g.pers.netname.ptr(), message.ptr(), attacker.client->g.pers.netname.ptr(), message2.ptr());
+			G_Broadcast(G_PrintMessage(PRINT_MEDIUM, "%s %s %s%s\n", self.client->g.pers.netname.ptr(), message.ptr(), attacker.client->g.pers.netname.ptr(), message2.ptr()));
 #ifdef SINGLE_PLAYER
 
 			if (deathmatch.intVal)
@@ -709,7 +713,7 @@ void player_die(entity &self, entity &inflictor, entity &attacker, int32_t damag
 			break;
 		}
 
-		gi.sound(self, CHAN_VOICE, gi.soundindex(va("*death%i.wav", (Q_rand() % 4) + 1)), 1, ATTN_NORM, 0);
+		gi.sound(self, CHAN_VOICE, gi.soundindex(va("*death%i.wav", (rng_effects() % 4) + 1)), 1, ATTN_NORM, 0);
 	}
 
 	self.g.deadflag = DEAD_DEAD;
@@ -1371,10 +1375,14 @@ void PutClientInServer(entity &ent)
 
 	ent.client->ps = {};
 	
-	// clear everything but the persistant data
+	// clear everything but the persistant data and who's chasing us;
+	// our own chase ends, so leave that list before it's wiped
+	SetChaseTarget(ent, null_entity);
 	client_persistant saved = std::move(ent.client->g.pers);
+	entityref chasers = ent.client->g.chasers;
 	ent.client->g = {};
 	ent.client->g.pers = std::move(saved);
+	ent.client->g.chasers = chasers;
 #ifdef SINGLE_PLAYER
 	if (ent.client->g.pers.health <= 0)
 		InitClientPersistant(ent);
@@ -1392,6 +1400,7 @@ void PutClientInServer(entity &ent)
 	ent.g.movetype = MOVETYPE_WALK;
 	ent.g.viewheight = 22;
 	ent.inuse = true;
+	Mirror_Update(ent);
 	ent.g.type = ET_PLAYER;
 	ent.g.mass = 200;
 	ent.solid = SOLID_BBOX;
@@ -1439,7 +1448,7 @@ void PutClientInServer(entity &ent)
 	// spawn a spectator
 	if (ent.client->g.pers.spectator)
 	{
-		ent.client->g.chase_target = null_entity;
+		SetChaseTarget(ent, null_entity);
 		ent.client->g.resp.spectator = true;
 
 		ent.g.movetype = MOVETYPE_NOCLIP;
@@ -1535,6 +1544,51 @@ void ClientBegin(entity &ent)
 void(entity, string) CTFAssignSkin;
 #endif
 
+// the userinfo keys the game reads, picked out in a single walk over
+// the string. the views point into the string it was parsed from.
+struct client_userinfo
+{
+	std::string_view	name, skin, spectator, password, fov, hand, msg, ip;
+	// the string passed Info_Validate's checks
+	bool				valid;
+};
+
+static client_userinfo ParseUserinfo(const string &userinfo)
+{
+	client_userinfo info {};
+	info_tokenizer tokens(userinfo.ptr());
+	info_pair pair;
+
+	// the first of any repeated key wins, like Info_ValueForKey
+	auto take = [&pair](std::string_view &field) {
+		if (!field.data())
+			field = pair.value;
+	};
+
+	while (tokens.next(pair))
+	{
+		if (pair.key == "name")
+			take(info.name);
+		else if (pair.key == "skin")
+			take(info.skin);
+		else if (pair.key == "spectator")
+			take(info.spectator);
+		else if (pair.key == "password")
+			take(info.password);
+		else if (pair.key == "fov")
+			take(info.fov);
+		else if (pair.key == "hand")
+			take(info.hand);
+		else if (pair.key == "msg")
+			take(info.msg);
+		else if (pair.key == "ip")
+			take(info.ip);
+	}
+
+	info.valid = tokens.valid();
+	return info;
+}
+
 /*
 ===========
 ClientUserInfoChanged
@@ -1547,29 +1601,28 @@ The game can override any of the settings in place
 */
 void ClientUserinfoChanged(entity &ent, string userinfo)
 {
+	client_userinfo info = ParseUserinfo(userinfo);
+
 	// check for malformed or illegal info strings
-	if (!Info_Validate(userinfo))
+	if (!info.valid)
+	{
 		userinfo = "\\name\\badinfo\\skin\\male/grunt";
+		info = ParseUserinfo(userinfo);
+	}
 	
 	// set name
-	string str = Info_ValueForKey(userinfo, "name");
-	ent.client->g.pers.netname = str;
+	ent.client->g.pers.netname = Info_String(info.name);
 	
 	// set spectator
-	str = Info_ValueForKey(userinfo, "spectator");
-
 	// spectators are only supported in deathmatch
 	if (
 #ifdef SINGLE_PLAYER
 		deathmatch.intVal &&
 #endif
-		!strempty(str) && str != "0")
+		!info.spectator.empty() && info.spectator != "0")
 		ent.client->g.pers.spectator = true;
 	else
 		ent.client->g.pers.spectator = false;
-	
-	// set skin
-	str = Info_ValueForKey(userinfo, "skin");
 
 	// combine name and skin into a configstring
 #ifdef CTF
@@ -1577,18 +1630,20 @@ void ClientUserinfoChanged(entity &ent, string userinfo)
 	gi.configstring (CS_GENERAL + ent.s.number - 1, ent.client.pers.netname);
 
 	if (ctf.intVal)
-		CTFAssignSkin(ent, str);
+		CTFAssignSkin(ent, Info_String(info.skin));
 	else
 #endif
-		gi.configstring((config_string)(CS_PLAYERSKINS + ent.s.number - 1), va("%s\\%s", ent.client->g.pers.netname.ptr(), str.ptr()));
+		gi.configstring((config_string)(CS_PLAYERSKINS + ent.s.number - 1), va("%s\\%.*s", ent.client->g.pers.netname.ptr(), (int32_t)info.skin.size(), info.skin.data()));
 	
 	// fov
-	ent.client->ps.fov = clamp(1.f, (float)atof(Info_ValueForKey(userinfo, "fov")), 160.f);
+	ent.client->ps.fov = clamp(1.f, Info_Float(info.fov), 160.f);
 	
 	// handedness
-	str = Info_ValueForKey(userinfo, "hand");
-	if (!strempty(str))
-		ent.client->g.pers.hand = clamp(RIGHT_HANDED, (handedness)atoi(str), CENTER_HANDED);
+	if (!info.hand.empty())
+		ent.client->g.pers.hand = clamp(RIGHT_HANDED, (handedness)Info_Int(info.hand), CENTER_HANDED);
+
+	// message level, which the engine reads from the same key
+	ent.client->g.pers.messagelevel = (print_level)clamp(0, Info_Int(info.msg), 255);
 	
 	// save off the userinfo in case we want to check something later
 	ent.client->g.pers.userinfo = userinfo;
@@ -1608,27 +1663,25 @@ loadgames will.
 */
 bool ClientConnect(entity &ent, string &userinfo)
 {
+	const client_userinfo info = ParseUserinfo(userinfo);
+
 	// check to see if they are on the banned IP list
-	/*string value = Info_ValueForKey(userinfo, "ip");
-	
-	if (SV_FilterPacket(value))
+	if (IPFilter_Rejected(info.ip))
 	{
 		Info_SetValueForKey(userinfo, "rejmsg", "Banned.");
 		return false;
-	}*/
+	}
 
 	// check for a spectator
-	string value = Info_ValueForKey(userinfo, "spectator");
-
 	if (
 #ifdef SINGLE_PLAYER
 		deathmatch.intVal &&
 #endif
-		value == "1")
+		info.spectator == "1")
 	{
 		if (spectator_password &&
 			spectator_password != "none" &&
-			spectator_password != value)
+			std::string_view((stringlit)spectator_password) != info.spectator)
 		{
 			Info_SetValueForKey(userinfo, "rejmsg", "Spectator password required or incorrect.");
 			return false;
@@ -1654,11 +1707,9 @@ bool ClientConnect(entity &ent, string &userinfo)
 	else
 	{
 		// check for a password
-		value = Info_ValueForKey(userinfo, "password");
-
 		if (password &&
 			password != "none" &&
-			password != value)
+			std::string_view((stringlit)password) != info.password)
 		{
 			Info_SetValueForKey(userinfo, "rejmsg", "Password required or incorrect.");
 			return false;
@@ -1735,6 +1786,13 @@ void ClientDisconnect(entity &ent)
 	ent.s.effects = EF_NONE;
 	ent.solid = SOLID_NOT;
 	ent.inuse = false;
+	Mirror_Update(ent);
+	SetChaseTarget(ent, null_entity);
+
+	// take them off air so whoever gets the slot next isn't broadcast
+	if (level.chase_broadcast == ent)
+		level.chase_broadcast = null_entity;
+
 	ent.g.type = ET_DISCONNECTED_PLAYER;
 	ent.client->g.pers.connected = false;
 }
@@ -1759,126 +1817,196 @@ void(entity, vector, player_noise_t) PlayerNoise;
 void(entity) CTFApplyRegeneration;
 #endif
 
-void ClientThink(entity &ent, const usercmd &ucmd)
+/*
+==============
+client movement
+
+A move is split in four. ClientPrepareMove fills in the pmove from the
+client, ClientRunMove runs it, ClientFinishMove copies the results back
+into the client and works out what the move set off, and
+ClientMoveEffects does that to the world: the jump sound, linking,
+triggers and touches, always in that order and straight after the move.
+
+pmove_t's callbacks carry no context, so the entity being moved and its
+clip mask reach them through a pointer that ClientRunMove sets for the
+length of the move.
+==============
+*/
+struct pmove_collision
 {
-	level.current_entity = ent;
+	entityref		passent;
+	content_flags	mask;
+};
 
-	if (level.intermission_framenum)
-	{
-		ent.client->ps.pmove.pm_type = PM_FREEZE;
-		// can exit intermission after five seconds
-		if (level.framenum > level.intermission_framenum + 5.0f * BASE_FRAMERATE
-			&& (ucmd.buttons & BUTTON_ANY))
-			level.exitintermission = true;
-		return;
-	}
+static const pmove_collision *pmove_context;
 
-	if (ent.client->g.chase_target.has_value())
-		ent.client->g.resp.cmd_angles = ucmd.get_angles();
-	else
-	{
-		pmove_t	pm = {};
-		
-		static entityref passent;
-		static content_flags mask;
+static trace ClientMoveTrace(const vector &start, const vector &mins, const vector &maxs, const vector &end)
+{
+	return gi.trace(start, mins, maxs, end, pmove_context->passent, pmove_context->mask);
+}
 
-		passent = ent;
-		mask = (ent.g.health > 0) ? MASK_PLAYERSOLID : MASK_DEADSOLID;
-		
-		pm.trace = [](auto start, auto mins, auto maxs, auto end) { return gi.trace(start, mins, maxs, end, passent, mask); };
-		pm.pointcontents = [](auto point) { return gi.pointcontents(point); };
-
-		// set up for pmove
-		if (ent.g.movetype == MOVETYPE_NOCLIP)
-			ent.client->ps.pmove.pm_type = PM_SPECTATOR;
-		else if (ent.s.modelindex != MODEL_PLAYER)
-			ent.client->ps.pmove.pm_type = PM_GIB;
-		else if (ent.g.deadflag)
-			ent.client->ps.pmove.pm_type = PM_DEAD;
-		else
-			ent.client->ps.pmove.pm_type = PM_NORMAL;
+static content_flags ClientMovePointContents(const vector &point)
+{
+	return gi.pointcontents(point);
+}
+
+struct client_move
+{
+	pmove_t			pm;
+	pmove_collision	collision;
+	// the move left the ground by jumping
+	bool			jumped;
+};
+
+static void ClientPrepareMove(entity &ent, const usercmd &ucmd, client_move &move)
+{
+	pmove_t &pm = move.pm;
+
+	pm = {};
+	move.collision = { ent, (ent.g.health > 0) ? MASK_PLAYERSOLID : MASK_DEADSOLID };
+	move.jumped = false;
+
+	pm.trace = ClientMoveTrace;
+	pm.pointcontents = ClientMovePointContents;
+
+	// set up for pmove
+	if (ent.g.movetype == MOVETYPE_NOCLIP)
+		ent.client->ps.pmove.pm_type = PM_SPECTATOR;
+	else if (ent.s.modelindex != MODEL_PLAYER)
+		ent.client->ps.pmove.pm_type = PM_GIB;
+	else if (ent.g.deadflag)
+		ent.client->ps.pmove.pm_type = PM_DEAD;
+	else
+		ent.client->ps.pmove.pm_type = PM_NORMAL;
 
 #ifdef GROUND_ZERO
-		ent.client.ps.pmove.gravity = (int16_t)sv_gravity * ent.gravity;
+	ent.client.ps.pmove.gravity = (int16_t)sv_gravity * ent.gravity;
 #else
-		ent.client->ps.pmove.gravity = (int16_t)sv_gravity;
+	ent.client->ps.pmove.gravity = (int16_t)sv_gravity;
 #endif
-		pm.s = ent.client->ps.pmove;
+	pm.s = ent.client->ps.pmove;
 
-		pm.s.set_origin(ent.s.origin);
-		pm.s.set_velocity(ent.g.velocity);
+	pm.s.set_origin(ent.s.origin);
+	pm.s.set_velocity(ent.g.velocity);
 
-		pm.snapinitial = !!memcmp(&ent.client->g.old_pmove, &pm.s, sizeof(pm.s));
+	pm.snapinitial = !!memcmp(&ent.client->g.old_pmove, &pm.s, sizeof(pm.s));
 
-		pm.cmd = ucmd;
+	pm.cmd = ucmd;
+}
+
+static void ClientRunMove(client_move &move)
+{
+	const pmove_collision *previous = pmove_context;
+	pmove_context = &move.collision;
 
-		// perform a pmove
-#ifdef QUAKEC_PMOVE
-		Pmove(&pm);
+	// perform a pmove
+#ifdef CUSTOM_PMOVE
+	if (Pmove_Recording())
+		Pmove_Record(move.pm);
+	else
+		Pmove(move.pm);
 #else
-		gi.Pmove(pm);
+	gi.Pmove(move.pm);
 #endif
 
-		// save results of pmove
-		ent.client->g.old_pmove = ent.client->ps.pmove = pm.s;
+	pmove_context = previous;
+}
 
-		ent.s.origin = pm.s.get_origin();
-		ent.g.velocity = pm.s.get_velocity();
+static void ClientFinishMove(entity &ent, const usercmd &ucmd, client_move &move)
+{
+	const pmove_t &pm = move.pm;
 
-		ent.mins = pm.mins;
-		ent.maxs = pm.maxs;
+	// save results of pmove
+	ent.client->g.old_pmove = ent.client->ps.pmove = pm.s;
 
-		ent.client->g.resp.cmd_angles = ucmd.get_angles();
+	ent.s.origin = pm.s.get_origin();
+	ent.g.velocity = pm.s.get_velocity();
 
-		if (ent.g.groundentity.has_value() && !pm.groundentity.has_value() && (pm.cmd.upmove >= 10) && (pm.waterlevel == 0))
-#ifdef SINGLE_PLAYER
-		{
-#endif
-			gi.sound(ent, CHAN_VOICE, gi.soundindex("*jump1.wav"), 1, ATTN_NORM, 0);
-#ifdef SINGLE_PLAYER
-			PlayerNoise(ent, ent.s.origin, PNOISE_SELF);
-		}
-#endif
+	ent.mins = pm.mins;
+	ent.maxs = pm.maxs;
 
-		ent.g.viewheight = (int)pm.viewheight;
-		ent.g.waterlevel = pm.waterlevel;
-		ent.g.watertype = pm.watertype;
-		ent.g.groundentity = pm.groundentity;
-		if (pm.groundentity.has_value())
-			ent.g.groundentity_linkcount = pm.groundentity->linkcount;
+	ent.client->g.resp.cmd_angles = ucmd.get_angles();
 
-		if (ent.g.deadflag)
-		{
-			ent.client->ps.viewangles[ROLL] = 40.f;
-			ent.client->ps.viewangles[PITCH] = -15.f;
-			ent.client->ps.viewangles[YAW] = ent.client->g.killer_yaw;
-		}
-		else
-			ent.client->ps.viewangles = ent.client->g.v_angle = pm.viewangles;
+	move.jumped = ent.g.groundentity.has_value() && !pm.groundentity.has_value() && (pm.cmd.upmove >= 10) && (pm.waterlevel == 0);
+
+	ent.g.viewheight = (int)pm.viewheight;
+	ent.g.waterlevel = pm.waterlevel;
+	ent.g.watertype = pm.watertype;
+	ent.g.groundentity = pm.groundentity;
+	if (pm.groundentity.has_value())
+		ent.g.groundentity_linkcount = pm.groundentity->linkcount;
+
+	if (ent.g.deadflag)
+	{
+		ent.client->ps.viewangles[ROLL] = 40.f;
+		ent.client->ps.viewangles[PITCH] = -15.f;
+		ent.client->ps.viewangles[YAW] = ent.client->g.killer_yaw;
+	}
+	else
+		ent.client->ps.viewangles = ent.client->g.v_angle = pm.viewangles;
+}
+
+static void ClientMoveEffects(entity &ent, const client_move &move)
+{
+	if (move.jumped)
+	{
+		gi.sound(ent, CHAN_VOICE, gi.soundindex("*jump1.wav"), 1, ATTN_NORM, 0);
+#ifdef SINGLE_PLAYER
+		PlayerNoise(ent, ent.s.origin, PNOISE_SELF);
+#endif
+	}
 
 #ifdef HOOK_CODE
-		if (ent.client->g.grapple.has_value())
-			GrapplePull(ent.client->g.grapple);
+	if (ent.client->g.grapple.has_value())
+		GrapplePull(ent.client->g.grapple);
 #endif
 
-		gi.linkentity(ent);
+	gi.linkentity(ent);
 
-		if (ent.g.movetype != MOVETYPE_NOCLIP)
-			G_TouchTriggers(ent);
+	if (ent.g.movetype != MOVETYPE_NOCLIP)
+		G_TouchTriggers(ent);
 
 #ifdef GROUND_ZERO
-		ent.gravity = 1.0;
+	ent.gravity = 1.0;
 #endif
 
-		// touch other objects
-		for (auto &other : pm.touchents)
-		{
-			if (!other.has_value())
-				break;
+	// touch other objects
+	for (auto &other : move.pm.touchents)
+	{
+		if (!other.has_value())
+			break;
 
-			if (other->g.touch)
-				other->g.touch(other, ent, vec3_origin, null_surface);
-		}
+		if (other->g.touch)
+			other->g.touch(other, ent, vec3_origin, null_surface);
+	}
+}
+
+void ClientThink(entity &ent, const usercmd &ucmd)
+{
+	PROFILE_ZONE("ClientThink");
+
+	level.current_entity = ent;
+
+	if (level.intermission_framenum)
+	{
+		ent.client->ps.pmove.pm_type = PM_FREEZE;
+		// can exit intermission after five seconds
+		if (level.framenum > level.intermission_framenum + 5.0f * BASE_FRAMERATE
+			&& (ucmd.buttons & BUTTON_ANY))
+			level.exitintermission = true;
+		return;
+	}
+
+	if (ent.client->g.chase_target.has_value())
+		ent.client->g.resp.cmd_angles = ucmd.get_angles();
+	else
+	{
+		client_move move;
+
+		ClientPrepareMove(ent, ucmd, move);
+		ClientRunMove(move);
+		ClientFinishMove(ent, ucmd, move);
+		ClientMoveEffects(ent, move);
 	}
 
 	ent.client->g.oldbuttons = ent.client->g.buttons;
@@ -1898,7 +2026,7 @@ void ClientThink(entity &ent, const usercmd &ucmd)
 
 			if (ent.client->g.chase_target.has_value())
 			{
-				ent.client->g.chase_target = nullptr;
+				SetChaseTarget(ent, null_entity);
 				ent.client->ps.pmove.pm_flags &= ~PMF_NO_PREDICTION;
 			}
 			else
@@ -1933,12 +2061,7 @@ void ClientThink(entity &ent, const usercmd &ucmd)
 	}
 
 	// update chase cam if being followed
-	for (uint32_t i = 1; i <= game.maxclients; i++)
-	{
-		entity &other = itoe(i);
-		if (other.inuse && other.client->g.chase_target == ent)
-			UpdateChaseCam(other);
-	}
+	UpdateChasers(ent);
 
 #ifdef BOTS
 	//AITools_DropNodes(ent);
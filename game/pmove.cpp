@@ -0,0 +1,1525 @@
+#include "../lib/types.h"
+#include "../lib/entity.h"
+#include "../lib/gi.h"
+#include "game.h"
+#include "util.h"
+#include "pmove.h"
+
+#ifdef CUSTOM_PMOVE
+#include "../lib/dynarray.h"
+#include "../lib/map.h"
+#include <bit>
+#include <cstdio>
+
+// every step below has to round exactly like the engine's C does, down to
+// where it works in double, so the order of operations is theirs; build
+// without floating-point contraction or the FMAs will drift it.
+
+// movement parameters
+constexpr float pm_stopspeed = 100;
+constexpr float pm_maxspeed = 300;
+constexpr float pm_duckspeed = 100;
+constexpr float pm_accelerate = 10;
+constexpr float pm_wateraccelerate = 10;
+constexpr float pm_friction = 6;
+constexpr float pm_waterfriction = 1;
+constexpr float pm_waterspeed = 400;
+
+constexpr int32_t STEPSIZE = 18;
+constexpr size_t MAX_CLIP_PLANES = 5;
+
+// compared in double by the engine; as floats, a 0.7f normal would pass
+constexpr double MIN_STEP_NORMAL = 0.7;
+constexpr double PM_STOP_EPSILON = 0.1;
+
+#ifdef KMQUAKE2_ENGINE_MOD
+using pm_coord = int32_t;
+#else
+using pm_coord = int16_t;
+#endif
+
+// traces and contents checks remembered for the length of one move
+constexpr size_t PM_MEMO_TRACES = 8;
+constexpr size_t PM_MEMO_CONTENTS = 8;
+
+struct pm_trace_key
+{
+	vector	start, mins, maxs, end;
+};
+
+// the engine keeps this in globals
+struct pmove_local
+{
+	pmove_t				&pm;
+	// sv_airaccelerate, as the engine sees it for this move; like
+	// the engine, only whether it's set matters
+	float				airaccelerate;
+
+	// full float precision
+	vector				origin;
+	vector				velocity;
+
+	vector				forward, right, up;
+	float				frametime;
+
+	const surface		*groundsurface;
+	content_flags		groundcontents;
+
+	// pm.s's origin, written back when the move snaps
+	array<pm_coord, 3>	s_origin;
+	vector				previous_origin;
+	bool				ladder;
+
+	array<pm_trace_key, PM_MEMO_TRACES>		trace_keys;
+	array<trace, PM_MEMO_TRACES>			traces;
+	size_t									num_traces;
+	array<vector, PM_MEMO_CONTENTS>			contents_keys;
+	array<content_flags, PM_MEMO_CONTENTS>	contents;
+	size_t									num_contents;
+	// queries asked of the memo, including the ones it answered
+	uint32_t								trace_queries, contents_queries;
+};
+
+// added to once a move is done
+static struct
+{
+	uint64_t	moves;
+	uint64_t	traces, traces_issued;
+	uint64_t	contents, contents_issued;
+} pmove_stats;
+
+/*
+==============
+engine queries
+==============
+*/
+static trace PM_Trace(pmove_local &pml, const vector &start, const vector &end)
+{
+	const pm_trace_key key { start, pml.pm.mins, pml.pm.maxs, end };
+	const size_t n = min(pml.num_traces, PM_MEMO_TRACES);
+
+	pml.trace_queries++;
+
+	for (size_t i = 0; i < n; i++)
+		if (!memcmp(&pml.trace_keys[i], &key, sizeof(key)))
+			return pml.traces[i];
+
+	const size_t slot = pml.num_traces++ % PM_MEMO_TRACES;
+	pml.trace_keys[slot] = key;
+	return pml.traces[slot] = pml.pm.trace(start, pml.pm.mins, pml.pm.maxs, end);
+}
+
+static content_flags PM_PointContents(pmove_local &pml, const vector &point)
+{
+	const size_t n = min(pml.num_contents, PM_MEMO_CONTENTS);
+
+	pml.contents_queries++;
+
+	for (size_t i = 0; i < n; i++)
+		if (!memcmp(&pml.contents_keys[i], &point, sizeof(point)))
+			return pml.contents[i];
+
+	const size_t slot = pml.num_contents++ % PM_MEMO_CONTENTS;
+	pml.contents_keys[slot] = point;
+	return pml.contents[slot] = pml.pm.pointcontents(point);
+}
+
+static void PM_SetOrigin(pmove_local &pml)
+{
+	pml.pm.s.set_origin({ pml.s_origin[0] * short2coord, pml.s_origin[1] * short2coord, pml.s_origin[2] * short2coord });
+}
+
+/*
+==============
+vector math, as q_shared does it
+==============
+*/
+// the engine's sin and cos are the double ones; sinf and cosf
+// can round differently
+static void PM_AngleVectors(const vector &angles, vector &forward, vector &right, vector &up)
+{
+	constexpr double deg2rad_d = 3.14159265358979323846 * 2 / 360;
+
+	float angle = (float)(angles[YAW] * deg2rad_d);
+	const float sy = (float)std::sin((double)angle);
+	const float cy = (float)std::cos((double)angle);
+	angle = (float)(angles[PITCH] * deg2rad_d);
+	const float sp = (float)std::sin((double)angle);
+	const float cp = (float)std::cos((double)angle);
+	angle = (float)(angles[ROLL] * deg2rad_d);
+	const float sr = (float)std::sin((double)angle);
+	const float cr = (float)std::cos((double)angle);
+
+	forward = { cp * cy, cp * sy, -sp };
+	right = {
+		(-1 * sr * sp * cy + -1 * cr * -sy),
+		(-1 * sr * sp * sy + -1 * cr * cy),
+		-1 * sr * cp
+	};
+	up = {
+		(cr * sp * cy + -sr * -sy),
+		(cr * sp * sy + -sr * cy),
+		cr * cp
+	};
+}
+
+static vector PM_ClipVelocity(const vector &in, const vector &normal, const float overbounce)
+{
+	const float backoff = (in * normal) * overbounce;
+	vector out = in - (normal * backoff);
+
+	for (float &v : out)
+		if (v > -PM_STOP_EPSILON && v < PM_STOP_EPSILON)
+			v = 0;
+
+	return out;
+}
+
+/*
+==============
+PM_StepSlideMove
+
+Each intersection will try to step over the obstruction instead of
+sliding along it.
+==============
+*/
+static void PM_StepSlideMove_(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+	array<vector, MAX_CLIP_PLANES> planes;
+	size_t numplanes = 0;
+	const vector primal_velocity = pml.velocity;
+	float time_left = pml.frametime;
+
+	for (int32_t bumpcount = 0; bumpcount < 4; bumpcount++)
+	{
+		const vector end = pml.origin + (time_left * pml.velocity);
+		const trace tr = PM_Trace(pml, pml.origin, end);
+
+		if (tr.allsolid)
+		{
+			// entity is trapped in another solid; don't build up falling damage
+			pml.velocity.z = 0;
+			return;
+		}
+
+		if (tr.fraction > 0)
+		{
+			// actually covered some distance
+			pml.origin = tr.endpos;
+			numplanes = 0;
+		}
+
+		if (tr.fraction == 1)
+			break;
+
+		// save entity for contact
+		if (pm.numtouch < (int32_t)MAX_TOUCH)
+			pm.touchents[pm.numtouch++] = tr.ent;
+
+		time_left -= time_left * tr.fraction;
+
+		// slide along this plane
+		if (numplanes >= MAX_CLIP_PLANES)
+		{
+			// this shouldn't really happen
+			pml.velocity = vec3_origin;
+			break;
+		}
+
+		planes[numplanes++] = tr.normal;
+
+		// modify original_velocity so it parallels all of the clip planes
+		size_t i;
+
+		for (i = 0; i < numplanes; i++)
+		{
+			pml.velocity = PM_ClipVelocity(pml.velocity, planes[i], (float)1.01);
+
+			size_t j;
+
+			for (j = 0; j < numplanes; j++)
+				if (j != i && (pml.velocity * planes[j]) < 0)
+					break;
+
+			if (j == numplanes)
+				break;
+		}
+
+		if (i == numplanes)
+		{
+			// go along the crease
+			if (numplanes != 2)
+			{
+				pml.velocity = vec3_origin;
+				break;
+			}
+
+			const vector dir = CrossProduct(planes[0], planes[1]);
+			const float d = dir * pml.velocity;
+			pml.velocity = dir * d;
+		}
+
+		// if velocity is against the original velocity, stop dead
+		// to avoid tiny occilations in sloping corners
+		if ((pml.velocity * primal_velocity) <= 0)
+		{
+			pml.velocity = vec3_origin;
+			break;
+		}
+	}
+
+	if (pm.s.pm_time)
+		pml.velocity = primal_velocity;
+}
+
+static void PM_StepSlideMove(pmove_local &pml)
+{
+	const vector start_o = pml.origin;
+	const vector start_v = pml.velocity;
+
+	PM_StepSlideMove_(pml);
+
+	const vector down_o = pml.origin;
+	const vector down_v = pml.velocity;
+
+	vector up = start_o;
+	up.z += STEPSIZE;
+
+	trace tr = PM_Trace(pml, up, up);
+
+	// can't step up
+	if (tr.allsolid)
+		return;
+
+	// try sliding above
+	pml.origin = up;
+	pml.velocity = start_v;
+
+	PM_StepSlideMove_(pml);
+
+	// push down the final amount
+	vector down = pml.origin;
+	down.z -= STEPSIZE;
+	tr = PM_Trace(pml, pml.origin, down);
+
+	if (!tr.allsolid)
+		pml.origin = tr.endpos;
+
+	up = pml.origin;
+
+	// decide which one went farther
+	const float down_dist = (down_o.x - start_o.x) * (down_o.x - start_o.x) + (down_o.y - start_o.y) * (down_o.y - start_o.y);
+	const float up_dist = (up.x - start_o.x) * (up.x - start_o.x) + (up.y - start_o.y) * (up.y - start_o.y);
+
+	if (down_dist > up_dist || tr.normal.z < MIN_STEP_NORMAL)
+	{
+		pml.origin = down_o;
+		pml.velocity = down_v;
+		return;
+	}
+
+	// if we were walking along a plane, then we need to copy the Z over
+	pml.velocity.z = down_v.z;
+}
+
+/*
+==============
+friction and acceleration
+
+These work on whole vectors so the compiler can keep them in packed
+registers; every channel still rounds the same as the engine's loops.
+==============
+*/
+static void PM_Friction(pmove_local &pml)
+{
+	const pmove_t &pm = pml.pm;
+	vector &vel = pml.velocity;
+	const float speed = std::sqrt(vel.x * vel.x + vel.y * vel.y + vel.z * vel.z);
+
+	if (speed < 1)
+	{
+		vel.x = vel.y = 0;
+		return;
+	}
+
+	float drop = 0;
+
+	// apply ground friction
+	if ((pm.groundentity.has_value() && pml.groundsurface && !(pml.groundsurface->flags & SURF_SLICK)) || pml.ladder)
+	{
+		const float control = speed < pm_stopspeed ? pm_stopspeed : speed;
+		drop += control * pm_friction * pml.frametime;
+	}
+
+	// apply water friction
+	if (pm.waterlevel && !pml.ladder)
+		drop += speed * pm_waterfriction * pm.waterlevel * pml.frametime;
+
+	// scale the velocity
+	float newspeed = speed - drop;
+
+	if (newspeed < 0)
+		newspeed = 0;
+
+	newspeed /= speed;
+
+	vel = vel * newspeed;
+}
+
+static void PM_Accelerate(pmove_local &pml, const vector &wishdir, const float wishspeed, const float accel)
+{
+	const float currentspeed = pml.velocity * wishdir;
+	const float addspeed = wishspeed - currentspeed;
+
+	if (addspeed <= 0)
+		return;
+
+	float accelspeed = accel * pml.frametime * wishspeed;
+
+	if (accelspeed > addspeed)
+		accelspeed = addspeed;
+
+	pml.velocity += accelspeed * wishdir;
+}
+
+static void PM_AirAccelerate(pmove_local &pml, const vector &wishdir, const float wishspeed, const float accel)
+{
+	float wishspd = wishspeed;
+
+	if (wishspd > 30)
+		wishspd = 30;
+
+	const float currentspeed = pml.velocity * wishdir;
+	const float addspeed = wishspd - currentspeed;
+
+	if (addspeed <= 0)
+		return;
+
+	float accelspeed = accel * wishspeed * pml.frametime;
+
+	if (accelspeed > addspeed)
+		accelspeed = addspeed;
+
+	pml.velocity += accelspeed * wishdir;
+}
+
+// the engine only takes sv_airaccelerate in deathmatch, once per level;
+// it's latched, so reading it here agrees with that
+static float PM_AirAccelerateValue()
+{
+#ifdef SINGLE_PLAYER
+	if (!(bool)deathmatch)
+		return 0;
+#endif
+
+	return sv_airaccelerate.value;
+}
+
+static vector PM_CurrentDirection(const content_flags contents)
+{
+	vector v = vec3_origin;
+
+	if (contents & CONTENTS_CURRENT_0)
+		v.x += 1;
+	if (contents & CONTENTS_CURRENT_90)
+		v.y += 1;
+	if (contents & CONTENTS_CURRENT_180)
+		v.x -= 1;
+	if (contents & CONTENTS_CURRENT_270)
+		v.y -= 1;
+	if (contents & CONTENTS_CURRENT_UP)
+		v.z += 1;
+	if (contents & CONTENTS_CURRENT_DOWN)
+		v.z -= 1;
+
+	return v;
+}
+
+static void PM_AddCurrents(pmove_local &pml, vector &wishvel)
+{
+	const pmove_t &pm = pml.pm;
+
+	// account for ladders
+	if (pml.ladder && std::fabs(pml.velocity.z) <= 200)
+	{
+		if ((pm.viewangles[PITCH] <= -15) && (pm.cmd.forwardmove > 0))
+			wishvel.z = 200;
+		else if ((pm.viewangles[PITCH] >= 15) && (pm.cmd.forwardmove > 0))
+			wishvel.z = -200;
+		else if (pm.cmd.upmove > 0)
+			wishvel.z = 200;
+		else if (pm.cmd.upmove < 0)
+			wishvel.z = -200;
+		else
+			wishvel.z = 0;
+
+		// limit horizontal speed when on a ladder
+		wishvel.x = clamp(-25.f, wishvel.x, 25.f);
+		wishvel.y = clamp(-25.f, wishvel.y, 25.f);
+	}
+
+	// add water currents
+	if (pm.watertype & MASK_CURRENT)
+	{
+		float s = pm_waterspeed;
+
+		if ((pm.waterlevel == 1) && pm.groundentity.has_value())
+			s /= 2;
+
+		wishvel = wishvel + (s * PM_CurrentDirection(pm.watertype));
+	}
+
+	// add conveyor belt velocities
+	if (pm.groundentity.has_value())
+		wishvel = wishvel + (100 * PM_CurrentDirection(pml.groundcontents));
+}
+
+static void PM_WaterMove(pmove_local &pml)
+{
+	const pmove_t &pm = pml.pm;
+
+	// user intentions
+	vector wishvel = (pml.forward * pm.cmd.forwardmove) + (pml.right * pm.cmd.sidemove);
+
+	if (!pm.cmd.forwardmove && !pm.cmd.sidemove && !pm.cmd.upmove)
+		wishvel.z -= 60;		// drift towards bottom
+	else
+		wishvel.z += pm.cmd.upmove;
+
+	PM_AddCurrents(pml, wishvel);
+
+	vector wishdir = wishvel;
+	float wishspeed = VectorNormalize(wishdir);
+
+	if (wishspeed > pm_maxspeed)
+	{
+		wishvel = wishvel * (pm_maxspeed / wishspeed);
+		wishspeed = pm_maxspeed;
+	}
+
+	wishspeed *= 0.5f;
+
+	PM_Accelerate(pml, wishdir, wishspeed, pm_wateraccelerate);
+
+	PM_StepSlideMove(pml);
+}
+
+static void PM_AirMove(pmove_local &pml)
+{
+	const pmove_t &pm = pml.pm;
+	const float fmove = pm.cmd.forwardmove;
+	const float smove = pm.cmd.sidemove;
+
+	vector wishvel {
+		pml.forward.x * fmove + pml.right.x * smove,
+		pml.forward.y * fmove + pml.right.y * smove,
+		0
+	};
+
+	PM_AddCurrents(pml, wishvel);
+
+	vector wishdir = wishvel;
+	float wishspeed = VectorNormalize(wishdir);
+
+	// clamp to server defined max speed
+	const float maxspeed = (pm.s.pm_flags & PMF_DUCKED) ? pm_duckspeed : pm_maxspeed;
+
+	if (wishspeed > maxspeed)
+	{
+		wishvel = wishvel * (maxspeed / wishspeed);
+		wishspeed = maxspeed;
+	}
+
+	if (pml.ladder)
+	{
+		PM_Accelerate(pml, wishdir, wishspeed, pm_accelerate);
+
+		if (!wishvel.z)
+		{
+			if (pml.velocity.z > 0)
+			{
+				pml.velocity.z -= pm.s.gravity * pml.frametime;
+
+				if (pml.velocity.z < 0)
+					pml.velocity.z = 0;
+			}
+			else
+			{
+				pml.velocity.z += pm.s.gravity * pml.frametime;
+
+				if (pml.velocity.z > 0)
+					pml.velocity.z = 0;
+			}
+		}
+
+		PM_StepSlideMove(pml);
+	}
+	else if (pm.groundentity.has_value())
+	{
+		// walking on ground
+		pml.velocity.z = 0;
+		PM_Accelerate(pml, wishdir, wishspeed, pm_accelerate);
+
+		// fix for negative trigger_gravity fields
+		if (pm.s.gravity > 0)
+			pml.velocity.z = 0;
+		else
+			pml.velocity.z -= pm.s.gravity * pml.frametime;
+
+		if (!pml.velocity.x && !pml.velocity.y)
+			return;
+
+		PM_StepSlideMove(pml);
+	}
+	else
+	{
+		// not on ground, so little effect on velocity. sv_airaccelerate
+		// only switches air control on; like the engine's, the
+		// acceleration is pm_accelerate either way
+		if (pml.airaccelerate)
+			PM_AirAccelerate(pml, wishdir, wishspeed, pm_accelerate);
+		else
+			PM_Accelerate(pml, wishdir, wishspeed, 1);
+
+		// add gravity
+		pml.velocity.z -= pm.s.gravity * pml.frametime;
+		PM_StepSlideMove(pml);
+	}
+}
+
+/*
+==============
+PM_CatagorizePosition
+
+Sets groundentity, watertype and waterlevel.
+==============
+*/
+static void PM_CatagorizePosition(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+
+	// if the player hull point one unit down is solid, the player
+	// is on ground
+	vector point { pml.origin.x, pml.origin.y, (float)(pml.origin.z - 0.25) };
+
+	if (pml.velocity.z > 180)
+	{
+		pm.s.pm_flags &= ~PMF_ON_GROUND;
+		pm.groundentity = nullptr;
+	}
+	else
+	{
+		const trace tr = PM_Trace(pml, pml.origin, point);
+
+		pml.groundsurface = &tr.surface;
+		pml.groundcontents = tr.contents;
+
+		// the engine fills in the world when nothing was hit, so only
+		// the normal decides
+		if (tr.normal.z < MIN_STEP_NORMAL && !tr.startsolid)
+		{
+			pm.groundentity = nullptr;
+			pm.s.pm_flags &= ~PMF_ON_GROUND;
+		}
+		else
+		{
+			pm.groundentity = tr.ent;
+
+			// hitting solid ground will end a waterjump
+			if (pm.s.pm_flags & PMF_TIME_WATERJUMP)
+			{
+				pm.s.pm_flags &= ~(PMF_TIME_WATERJUMP | PMF_TIME_LAND | PMF_TIME_TELEPORT);
+				pm.s.pm_time = 0;
+			}
+
+			if (!(pm.s.pm_flags & PMF_ON_GROUND))
+			{
+				// just hit the ground
+				pm.s.pm_flags |= PMF_ON_GROUND;
+
+				// don't do landing time if we were just going down a slope
+				if (pml.velocity.z < -200)
+				{
+					pm.s.pm_flags |= PMF_TIME_LAND;
+
+					// don't allow another jump for a little while
+					pm.s.pm_time = (pml.velocity.z < -400) ? 25 : 18;
+				}
+			}
+		}
+
+		if (pm.numtouch < (int32_t)MAX_TOUCH)
+			pm.touchents[pm.numtouch++] = tr.ent;
+	}
+
+	// get waterlevel, accounting for ducking
+	pm.waterlevel = 0;
+	pm.watertype = CONTENTS_NONE;
+
+	const int32_t sample2 = (int32_t)(pm.viewheight - pm.mins.z);
+	const int32_t sample1 = sample2 / 2;
+
+	point.z = pml.origin.z + pm.mins.z + 1;
+	content_flags cont = PM_PointContents(pml, point);
+
+	if (cont & MASK_WATER)
+	{
+		pm.watertype = cont;
+		pm.waterlevel = 1;
+		point.z = pml.origin.z + pm.mins.z + sample1;
+		cont = PM_PointContents(pml, point);
+
+		if (cont & MASK_WATER)
+		{
+			pm.waterlevel = 2;
+			point.z = pml.origin.z + pm.mins.z + sample2;
+			cont = PM_PointContents(pml, point);
+
+			if (cont & MASK_WATER)
+				pm.waterlevel = 3;
+		}
+	}
+}
+
+static void PM_CheckJump(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+
+	// hasn't been long enough since landing to jump again
+	if (pm.s.pm_flags & PMF_TIME_LAND)
+		return;
+
+	// not holding jump
+	if (pm.cmd.upmove < 10)
+	{
+		pm.s.pm_flags &= ~PMF_JUMP_HELD;
+		return;
+	}
+
+	// must wait for jump to be released
+	if (pm.s.pm_flags & PMF_JUMP_HELD)
+		return;
+
+	if (pm.s.pm_type == PM_DEAD)
+		return;
+
+	// swimming, not jumping
+	if (pm.waterlevel >= 2)
+	{
+		pm.groundentity = nullptr;
+
+		if (pml.velocity.z <= -300)
+			return;
+
+		if (pm.watertype == CONTENTS_WATER)
+			pml.velocity.z = 100;
+		else if (pm.watertype == CONTENTS_SLIME)
+			pml.velocity.z = 80;
+		else
+			pml.velocity.z = 50;
+
+		return;
+	}
+
+	// in air, so no effect
+	if (!pm.groundentity.has_value())
+		return;
+
+	pm.s.pm_flags |= PMF_JUMP_HELD;
+
+	pm.groundentity = nullptr;
+	pml.velocity.z += 270;
+
+	if (pml.velocity.z < 270)
+		pml.velocity.z = 270;
+}
+
+static void PM_CheckSpecialMovement(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+
+	if (pm.s.pm_time)
+		return;
+
+	pml.ladder = false;
+
+	// check for ladder
+	vector flatforward { pml.forward.x, pml.forward.y, 0 };
+	VectorNormalize(flatforward);
+
+	vector spot = pml.origin + (1 * flatforward);
+	const trace tr = PM_Trace(pml, pml.origin, spot);
+
+	if ((tr.fraction < 1) && (tr.contents & CONTENTS_LADDER))
+		pml.ladder = true;
+
+	// check for water jump
+	if (pm.waterlevel != 2)
+		return;
+
+	spot = pml.origin + (30 * flatforward);
+	spot.z += 4;
+
+	if (!(PM_PointContents(pml, spot) & CONTENTS_SOLID))
+		return;
+
+	spot.z += 16;
+
+	if (PM_PointContents(pml, spot))
+		return;
+
+	// jump out of water
+	pml.velocity = flatforward * 50;
+	pml.velocity.z = 350;
+
+	pm.s.pm_flags |= PMF_TIME_WATERJUMP;
+	pm.s.pm_time = 255;
+}
+
+static void PM_FlyMove(pmove_local &pml, const bool doclip)
+{
+	pmove_t &pm = pml.pm;
+
+	pm.viewheight = 22;
+
+	// friction
+	const float speed = VectorLength(pml.velocity);
+
+	if (speed < 1)
+		pml.velocity = vec3_origin;
+	else
+	{
+		// extra friction
+		const float friction = (float)(pm_friction * 1.5);
+		const float control = speed < pm_stopspeed ? pm_stopspeed : speed;
+		const float drop = control * friction * pml.frametime;
+
+		// scale the velocity
+		float newspeed = speed - drop;
+
+		if (newspeed < 0)
+			newspeed = 0;
+
+		newspeed /= speed;
+
+		pml.velocity = pml.velocity * newspeed;
+	}
+
+	// accelerate
+	const float fmove = pm.cmd.forwardmove;
+	const float smove = pm.cmd.sidemove;
+
+	VectorNormalize(pml.forward);
+	VectorNormalize(pml.right);
+
+	vector wishvel = (pml.forward * fmove) + (pml.right * smove);
+	wishvel.z += pm.cmd.upmove;
+
+	vector wishdir = wishvel;
+	float wishspeed = VectorNormalize(wishdir);
+
+	// clamp to server defined max speed
+	if (wishspeed > pm_maxspeed)
+	{
+		wishvel = wishvel * (pm_maxspeed / wishspeed);
+		wishspeed = pm_maxspeed;
+	}
+
+	const float currentspeed = pml.velocity * wishdir;
+	const float addspeed = wishspeed - currentspeed;
+
+	if (addspeed <= 0)
+		return;
+
+	float accelspeed = pm_accelerate * pml.frametime * wishspeed;
+
+	if (accelspeed > addspeed)
+		accelspeed = addspeed;
+
+	pml.velocity += accelspeed * wishdir;
+
+	if (doclip)
+		pml.origin = PM_Trace(pml, pml.origin, pml.origin + (pml.frametime * pml.velocity)).endpos;
+	else
+		pml.origin = pml.origin + (pml.frametime * pml.velocity);
+}
+
+// sets mins, maxs, and viewheight
+static void PM_CheckDuck(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+
+	pm.mins.x = pm.mins.y = -16;
+	pm.maxs.x = pm.maxs.y = 16;
+
+	if (pm.s.pm_type == PM_GIB)
+	{
+		pm.mins.z = 0;
+		pm.maxs.z = 16;
+		pm.viewheight = 8;
+		return;
+	}
+
+	pm.mins.z = -24;
+
+	if (pm.s.pm_type == PM_DEAD)
+		pm.s.pm_flags |= PMF_DUCKED;
+	else if (pm.cmd.upmove < 0 && (pm.s.pm_flags & PMF_ON_GROUND))
+		pm.s.pm_flags |= PMF_DUCKED;
+	else if (pm.s.pm_flags & PMF_DUCKED)
+	{
+		// try to stand up
+		pm.maxs.z = 32;
+
+		if (!PM_Trace(pml, pml.origin, pml.origin).allsolid)
+			pm.s.pm_flags &= ~PMF_DUCKED;
+	}
+
+	if (pm.s.pm_flags & PMF_DUCKED)
+	{
+		pm.maxs.z = 4;
+		pm.viewheight = -2;
+	}
+	else
+	{
+		pm.maxs.z = 32;
+		pm.viewheight = 22;
+	}
+}
+
+static void PM_DeadMove(pmove_local &pml)
+{
+	if (!pml.pm.groundentity.has_value())
+		return;
+
+	// extra friction
+	const float forward = VectorLength(pml.velocity) - 20;
+
+	if (forward <= 0)
+		pml.velocity = vec3_origin;
+	else
+	{
+		VectorNormalize(pml.velocity);
+		pml.velocity = pml.velocity * forward;
+	}
+}
+
+static bool PM_GoodPosition(pmove_local &pml)
+{
+	if (pml.pm.s.pm_type == PM_SPECTATOR)
+		return true;
+
+	const vector origin { pml.s_origin[0] * short2coord, pml.s_origin[1] * short2coord, pml.s_origin[2] * short2coord };
+
+	return !PM_Trace(pml, origin, origin).allsolid;
+}
+
+// on exit, the origin will have a value that is pre-quantized to the 0.125
+// precision of the network channel and in a valid position.
+static void PM_SnapPosition(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+	array<int32_t, 3> sign;
+	array<int16_t, 3> velocity;
+	// try all single bits first
+	static constexpr int32_t jitterbits[8] = { 0, 4, 1, 2, 3, 5, 6, 7 };
+
+	// snap velocity to eigths
+	for (size_t i = 0; i < 3; i++)
+		velocity[i] = (int16_t)(int32_t)(pml.velocity[i] * 8);
+
+	pm.s.set_velocity({ velocity[0] * short2coord, velocity[1] * short2coord, velocity[2] * short2coord });
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		sign[i] = pml.origin[i] >= 0 ? 1 : -1;
+		pml.s_origin[i] = (pm_coord)(int32_t)(pml.origin[i] * 8);
+
+		if (pml.s_origin[i] * 0.125 == pml.origin[i])
+			sign[i] = 0;
+	}
+
+	const array<pm_coord, 3> base = pml.s_origin;
+
+	// try all combinations
+	for (const int32_t bits : jitterbits)
+	{
+		for (size_t i = 0; i < 3; i++)
+			pml.s_origin[i] = (bits & (1 << i)) ? (pm_coord)(base[i] + sign[i]) : base[i];
+
+		if (PM_GoodPosition(pml))
+		{
+			PM_SetOrigin(pml);
+			return;
+		}
+	}
+
+	// go back to the last position
+	for (size_t i = 0; i < 3; i++)
+		pml.s_origin[i] = (pm_coord)pml.previous_origin[i];
+
+	PM_SetOrigin(pml);
+}
+
+static void PM_InitialSnapPosition(pmove_local &pml)
+{
+	static constexpr int32_t offset[3] = { 0, -1, 1 };
+	const array<pm_coord, 3> base = pml.s_origin;
+
+	for (const int32_t z : offset)
+	{
+		pml.s_origin[2] = (pm_coord)(base[2] + z);
+
+		for (const int32_t y : offset)
+		{
+			pml.s_origin[1] = (pm_coord)(base[1] + y);
+
+			for (const int32_t x : offset)
+			{
+				pml.s_origin[0] = (pm_coord)(base[0] + x);
+
+				if (PM_GoodPosition(pml))
+				{
+					pml.origin = { pml.s_origin[0] * short2coord, pml.s_origin[1] * short2coord, pml.s_origin[2] * short2coord };
+					pml.previous_origin = { (float)pml.s_origin[0], (float)pml.s_origin[1], (float)pml.s_origin[2] };
+					return;
+				}
+			}
+		}
+	}
+
+	gi.dprintf("Bad InitialSnapPosition\n");
+}
+
+static void PM_ClampAngles(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+	const vector cmd_angles = pm.cmd.get_angles();
+	const vector delta_angles = pm.s.get_delta_angles();
+	array<int32_t, 3> angles;
+
+	// both are exact multiples of short2angle, so this gets the shorts back
+	for (size_t i = 0; i < 3; i++)
+		angles[i] = (int32_t)(cmd_angles[i] / short2angle) + (int32_t)(delta_angles[i] / short2angle);
+
+	if (pm.s.pm_flags & PMF_TIME_TELEPORT)
+	{
+		pm.viewangles[YAW] = (float)(angles[YAW] * (360.0 / 65536));
+		pm.viewangles[PITCH] = 0;
+		pm.viewangles[ROLL] = 0;
+	}
+	else
+	{
+		// circularly clamp the angles with deltas
+		for (size_t i = 0; i < 3; i++)
+			pm.viewangles[i] = (float)((int16_t)angles[i] * (360.0 / 65536));
+
+		// don't let the player look up or down more than 90 degrees
+		if (pm.viewangles[PITCH] > 89 && pm.viewangles[PITCH] < 180)
+			pm.viewangles[PITCH] = 89;
+		else if (pm.viewangles[PITCH] < 271 && pm.viewangles[PITCH] >= 180)
+			pm.viewangles[PITCH] = 271;
+	}
+
+	PM_AngleVectors(pm.viewangles, pml.forward, pml.right, pml.up);
+}
+
+static void PM_Move(pmove_local &pml)
+{
+	pmove_t &pm = pml.pm;
+
+	// clear results
+	pm.numtouch = 0;
+	pm.viewangles = vec3_origin;
+	pm.viewheight = 0;
+	pm.groundentity = nullptr;
+	pm.watertype = CONTENTS_NONE;
+	pm.waterlevel = 0;
+
+	// convert origin and velocity to float values
+	pml.origin = pm.s.get_origin();
+	pml.velocity = pm.s.get_velocity();
+
+	for (size_t i = 0; i < 3; i++)
+		pml.s_origin[i] = (pm_coord)(pml.origin[i] * coord2short);
+
+	// save old org in case we get stuck
+	pml.previous_origin = { (float)pml.s_origin[0], (float)pml.s_origin[1], (float)pml.s_origin[2] };
+
+	pml.frametime = (float)(pm.cmd.msec * 0.001);
+
+	PM_ClampAngles(pml);
+
+	if (pm.s.pm_type == PM_SPECTATOR)
+	{
+		PM_FlyMove(pml, false);
+		PM_SnapPosition(pml);
+		return;
+	}
+
+	if (pm.s.pm_type >= PM_DEAD)
+		pm.cmd.forwardmove = pm.cmd.sidemove = pm.cmd.upmove = 0;
+
+	// no movement at all
+	if (pm.s.pm_type == PM_FREEZE)
+		return;
+
+	PM_CheckDuck(pml);
+
+	if (pm.snapinitial)
+		PM_InitialSnapPosition(pml);
+
+	PM_CatagorizePosition(pml);
+
+	if (pm.s.pm_type == PM_DEAD)
+		PM_DeadMove(pml);
+
+	PM_CheckSpecialMovement(pml);
+
+	// drop timing counter
+	if (pm.s.pm_time)
+	{
+		const int32_t msec = max(1, pm.cmd.msec >> 3);
+
+		if (msec >= pm.s.pm_time)
+		{
+			pm.s.pm_flags &= ~(PMF_TIME_WATERJUMP | PMF_TIME_LAND | PMF_TIME_TELEPORT);
+			pm.s.pm_time = 0;
+		}
+		else
+			pm.s.pm_time = (uint8_t)(pm.s.pm_time - msec);
+	}
+
+	if (pm.s.pm_flags & PMF_TIME_TELEPORT)
+	{
+		// teleport pause stays exactly in place
+	}
+	else if (pm.s.pm_flags & PMF_TIME_WATERJUMP)
+	{
+		// waterjump has no control, but falls
+		pml.velocity.z -= pm.s.gravity * pml.frametime;
+
+		// cancel as soon as we are falling down again
+		if (pml.velocity.z < 0)
+		{
+			pm.s.pm_flags &= ~(PMF_TIME_WATERJUMP | PMF_TIME_LAND | PMF_TIME_TELEPORT);
+			pm.s.pm_time = 0;
+		}
+
+		PM_StepSlideMove(pml);
+	}
+	else
+	{
+		PM_CheckJump(pml);
+
+		PM_Friction(pml);
+
+		if (pm.waterlevel >= 2)
+			PM_WaterMove(pml);
+		else
+		{
+			vector angles = pm.viewangles;
+
+			if (angles[PITCH] > 180)
+				angles[PITCH] = angles[PITCH] - 360;
+
+			angles[PITCH] /= 3;
+
+			PM_AngleVectors(angles, pml.forward, pml.right, pml.up);
+
+			PM_AirMove(pml);
+		}
+	}
+
+	// set groundentity, watertype, and waterlevel for final spot
+	PM_CatagorizePosition(pml);
+
+	PM_SnapPosition(pml);
+}
+
+static void PM_RunMove(pmove_t &pm, const float airaccelerate)
+{
+	pmove_local pml { pm, airaccelerate };
+
+	PM_Move(pml);
+
+	pmove_stats.moves++;
+	pmove_stats.traces += pml.trace_queries;
+	pmove_stats.traces_issued += pml.num_traces;
+	pmove_stats.contents += pml.contents_queries;
+	pmove_stats.contents_issued += pml.num_contents;
+}
+
+void Pmove(pmove_t &pm)
+{
+	PM_RunMove(pm, PM_AirAccelerateValue());
+}
+
+/*
+==============
+differential check
+
+Moves are logged in the build's native layout; a log is only meant to be
+checked by the build that recorded it. The header keeps the sv_airaccelerate
+the moves were made under, and the check runs with that rather than the
+live value, so a log recorded with air control on always covers it.
+==============
+*/
+constexpr uint32_t PMOVE_LOG_MAGIC = 'V' << 24 | 'M' << 16 | 'P' << 8 | 'Q';
+constexpr uint32_t PMOVE_LOG_VERSION = 2;
+
+struct pmove_log_input
+{
+	pmove_state	s;
+	usercmd		cmd;
+	qboolean	snapinitial;
+};
+
+struct pmove_log_trace
+{
+	pm_trace_key	key;
+	qboolean		allsolid, startsolid;
+	float			fraction;
+	vector			endpos, normal;
+	surface_flags	surface_flags;
+	int32_t			surface_value;
+	content_flags	contents;
+	uint32_t		ent;
+};
+
+struct pmove_log_contents
+{
+	vector			point;
+	content_flags	contents;
+};
+
+struct pmove_log_result
+{
+	pmove_state					s;
+	usercmd						cmd;
+	int32_t						numtouch;
+	array<int32_t, MAX_TOUCH>	touchents;
+	vector						viewangles;
+	float						viewheight;
+	vector						mins, maxs;
+	int32_t						groundentity;
+	content_flags				watertype;
+	int32_t						waterlevel;
+};
+
+// one move: its input, what it asked of the engine and what it returned
+struct pmove_log_move
+{
+	pmove_log_input				input;
+	dynarray<pmove_log_trace>	traces;
+	dynarray<pmove_log_contents>	contents;
+	pmove_log_result			result;
+};
+
+static pmove_log_result Pmove_LogResult(const pmove_t &pm)
+{
+	pmove_log_result result {};
+
+	result.s = pm.s;
+	result.cmd = pm.cmd;
+	result.numtouch = pm.numtouch;
+
+	for (int32_t i = 0; i < pm.numtouch; i++)
+		result.touchents[i] = pm.touchents[i].has_value() ? (int32_t)pm.touchents[i]->s.number : -1;
+
+	result.viewangles = pm.viewangles;
+	result.viewheight = pm.viewheight;
+	result.mins = pm.mins;
+	result.maxs = pm.maxs;
+	result.groundentity = pm.groundentity.has_value() ? (int32_t)pm.groundentity->s.number : -1;
+	result.watertype = pm.watertype;
+	result.waterlevel = pm.waterlevel;
+
+	return result;
+}
+
+static struct
+{
+	std::FILE		*fp;
+	string			filename;
+	uint32_t		moves;
+	pmove_log_move	move;
+
+	// the callbacks the engine's pmove would have used
+	trace			(*trace)(const vector &start, const vector &mins, const vector &maxs, const vector &end);
+	content_flags	(*pointcontents)(const vector &point);
+} pmove_recorder;
+
+bool Pmove_Recording()
+{
+	return !!pmove_recorder.fp;
+}
+
+static trace Pmove_RecordTrace(const vector &start, const vector &mins, const vector &maxs, const vector &end)
+{
+	const trace tr = pmove_recorder.trace(start, mins, maxs, end);
+
+	pmove_recorder.move.traces.push_back({
+		{ start, mins, maxs, end },
+		tr.allsolid, tr.startsolid, tr.fraction, tr.endpos, tr.normal,
+		tr.surface.flags, tr.surface.value, tr.contents, (uint32_t)tr.ent.s.number
+	});
+
+	return tr;
+}
+
+static content_flags Pmove_RecordPointContents(const vector &point)
+{
+	const content_flags contents = pmove_recorder.pointcontents(point);
+
+	pmove_recorder.move.contents.push_back({ point, contents });
+
+	return contents;
+}
+
+template<typename T>
+static void Pmove_WriteArray(const dynarray<T> &values)
+{
+	const uint32_t count = (uint32_t)values.size();
+
+	std::fwrite(&count, sizeof(count), 1, pmove_recorder.fp);
+	std::fwrite(values.data(), sizeof(T), count, pmove_recorder.fp);
+}
+
+void Pmove_Record(pmove_t &pm)
+{
+	pmove_log_move &move = pmove_recorder.move;
+
+	move.input = { pm.s, pm.cmd, pm.snapinitial };
+	move.traces.clear();
+	move.contents.clear();
+
+	pmove_recorder.trace = pm.trace;
+	pmove_recorder.pointcontents = pm.pointcontents;
+	pm.trace = Pmove_RecordTrace;
+	pm.pointcontents = Pmove_RecordPointContents;
+
+	gi.Pmove(pm);
+
+	pm.trace = pmove_recorder.trace;
+	pm.pointcontents = pmove_recorder.pointcontents;
+
+	move.result = Pmove_LogResult(pm);
+
+	std::fwrite(&move.input, sizeof(move.input), 1, pmove_recorder.fp);
+	Pmove_WriteArray(move.traces);
+	Pmove_WriteArray(move.contents);
+	std::fwrite(&move.result, sizeof(move.result), 1, pmove_recorder.fp);
+
+	pmove_recorder.moves++;
+}
+
+static void Pmove_StopRecording()
+{
+	if (!pmove_recorder.fp)
+		return;
+
+	std::fclose(pmove_recorder.fp);
+	pmove_recorder.fp = nullptr;
+
+	gi.dprintf("pmove: wrote %u moves to %s\n", pmove_recorder.moves, pmove_recorder.filename.ptr());
+}
+
+static void Pmove_StartRecording(stringlit name)
+{
+	Pmove_StopRecording();
+
+	string filename = G_GamePath(name, "pmv");
+
+	if (fopen_s(&pmove_recorder.fp, filename.ptr(), "wb") || !pmove_recorder.fp)
+	{
+		pmove_recorder.fp = nullptr;
+		gi.dprintf("pmove: couldn't open %s for writing\n", filename.ptr());
+		return;
+	}
+
+	const uint32_t header[] = { PMOVE_LOG_MAGIC, PMOVE_LOG_VERSION, std::bit_cast<uint32_t>(PM_AirAccelerateValue()) };
+	std::fwrite(header, sizeof(header), 1, pmove_recorder.fp);
+
+	pmove_recorder.filename = filename;
+	pmove_recorder.moves = 0;
+
+	gi.dprintf("pmove: recording engine moves to %s\n", filename.ptr());
+}
+
+// the logged move the check is answering traces for
+static struct
+{
+	const pmove_log_move			*move;
+	bool							missed;
+	map<uint64_t, surface>			surfaces;
+} pmove_checker;
+
+static trace Pmove_CheckTrace(const vector &start, const vector &mins, const vector &maxs, const vector &end)
+{
+	const pm_trace_key key { start, mins, maxs, end };
+
+	// the world is frozen for the length of a move, so any logged
+	// trace with the same arguments has the answer
+	for (auto &logged : pmove_checker.move->traces)
+	{
+		if (memcmp(&logged.key, &key, sizeof(key)))
+			continue;
+
+		surface &surf = pmove_checker.surfaces[(uint64_t)logged.surface_flags << 32 | (uint32_t)logged.surface_value];
+		surf.flags = logged.surface_flags;
+		surf.value = logged.surface_value;
+
+		trace tr(surf, itoe(logged.ent < max_entities ? logged.ent : 0));
+		tr.allsolid = logged.allsolid;
+		tr.startsolid = logged.startsolid;
+		tr.fraction = logged.fraction;
+		tr.endpos = logged.endpos;
+		tr.normal = logged.normal;
+		tr.contents = logged.contents;
+		return tr;
+	}
+
+	// the engine never asked this; we've already gone a different way
+	pmove_checker.missed = true;
+
+	trace tr(null_surface, itoe(0));
+	tr.allsolid = tr.startsolid = false;
+	tr.fraction = 1;
+	tr.endpos = end;
+	tr.normal = vec3_origin;
+	return tr;
+}
+
+static content_flags Pmove_CheckPointContents(const vector &point)
+{
+	for (auto &logged : pmove_checker.move->contents)
+		if (!memcmp(&logged.point, &point, sizeof(point)))
+			return logged.contents;
+
+	pmove_checker.missed = true;
+	return CONTENTS_NONE;
+}
+
+template<typename T>
+static bool Pmove_ReadArray(std::FILE *fp, dynarray<T> &values)
+{
+	uint32_t count;
+
+	if (std::fread(&count, sizeof(count), 1, fp) != 1)
+		return false;
+
+	values.resize(count);
+	return std::fread(values.data(), sizeof(T), count, fp) == count;
+}
+
+// name of the first result that differs, or nullptr
+static stringlit Pmove_CompareResults(const pmove_log_result &a, const pmove_log_result &b)
+{
+	if (memcmp(&a.s, &b.s, sizeof(a.s)))
+		return "pmove state";
+	if (memcmp(&a.cmd, &b.cmd, sizeof(a.cmd)))
+		return "cmd";
+	if (a.numtouch != b.numtouch || memcmp(a.touchents.data(), b.touchents.data(), sizeof(int32_t) * a.numtouch))
+		return "touchents";
+	if (memcmp(&a.viewangles, &b.viewangles, sizeof(a.viewangles)))
+		return "viewangles";
+	if (memcmp(&a.viewheight, &b.viewheight, sizeof(a.viewheight)))
+		return "viewheight";
+	if (memcmp(&a.mins, &b.mins, sizeof(a.mins)) || memcmp(&a.maxs, &b.maxs, sizeof(a.maxs)))
+		return "bounds";
+	if (a.groundentity != b.groundentity)
+		return "groundentity";
+	if (a.watertype != b.watertype || a.waterlevel != b.waterlevel)
+		return "water";
+
+	return nullptr;
+}
+
+static void Pmove_Check(stringlit name)
+{
+	string filename = G_GamePath(name, "pmv");
+	std::FILE *fp;
+
+	if (fopen_s(&fp, filename.ptr(), "rb") || !fp)
+	{
+		gi.dprintf("pmove: couldn't open %s\n", filename.ptr());
+		return;
+	}
+
+	uint32_t header[3];
+
+	if (std::fread(header, sizeof(header), 1, fp) != 1 || header[0] != PMOVE_LOG_MAGIC || header[1] != PMOVE_LOG_VERSION)
+	{
+		gi.dprintf("pmove: %s isn't a pmove log\n", filename.ptr());
+		std::fclose(fp);
+		return;
+	}
+
+	const float airaccelerate = std::bit_cast<float>(header[2]);
+
+	constexpr uint32_t MAX_REPORTED = 8;
+	pmove_log_move move;
+	uint32_t moves = 0, mismatched = 0, diverged = 0;
+
+	pmove_checker.move = &move;
+
+	while (std::fread(&move.input, sizeof(move.input), 1, fp) == 1)
+	{
+		if (!Pmove_ReadArray(fp, move.traces) || !Pmove_ReadArray(fp, move.contents) ||
+			std::fread(&move.result, sizeof(move.result), 1, fp) != 1)
+		{
+			gi.dprintf("pmove: %s is truncated\n", filename.ptr());
+			break;
+		}
+
+		pmove_t pm {};
+
+		pm.s = move.input.s;
+		pm.cmd = move.input.cmd;
+		pm.snapinitial = move.input.snapinitial;
+		pm.trace = Pmove_CheckTrace;
+		pm.pointcontents = Pmove_CheckPointContents;
+
+		pmove_checker.missed = false;
+
+		PM_RunMove(pm, airaccelerate);
+
+		const stringlit differs = Pmove_CompareResults(move.result, Pmove_LogResult(pm));
+
+		if (pmove_checker.missed)
+			diverged++;
+
+		if (differs && mismatched++ < MAX_REPORTED)
+			gi.dprintf("pmove: move %u: %s differs%s\n", moves, differs, pmove_checker.missed ? " (asked for a trace the engine didn't)" : "");
+
+		moves++;
+	}
+
+	std::fclose(fp);
+	pmove_checker.move = nullptr;
+
+	gi.dprintf("pmove: checked %u moves from %s (sv_airaccelerate %g); %u mismatched, %u diverged\n", moves, filename.ptr(), airaccelerate, mismatched, diverged);
+}
+
+void Pmove_Command()
+{
+	string sub = gi.argc() > 2 ? strlwr(gi.argv(2)) : "";
+
+	if (sub == "record" && gi.argc() > 3)
+		Pmove_StartRecording(gi.argv(3));
+	else if (sub == "stop")
+		Pmove_StopRecording();
+	else if (sub == "check" && gi.argc() > 3)
+		Pmove_Check(gi.argv(3));
+	else
+	{
+		gi.dprintf("%llu moves; %llu of %llu traces and %llu of %llu contents checks went to the engine\n",
+			pmove_stats.moves, pmove_stats.traces_issued, pmove_stats.traces, pmove_stats.contents_issued, pmove_stats.contents);
+
+		if (pmove_recorder.fp)
+			gi.dprintf("recording to %s; %u moves so far\n", pmove_recorder.filename.ptr(), pmove_recorder.moves);
+	}
+}
+#endif
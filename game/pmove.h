@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../lib/types.h"
+#include "../lib/gi.h"
+
+/*
+==============
+game-side pmove
+
+Pmove is a port of the stock engine's player movement that produces
+bit-identical results, so clients predicting with the engine copy stay
+in sync. Traces and point contents with the same arguments are only
+asked of the engine once per move; the world can't change mid-move, so
+this doesn't change any result.
+
+"sv pmove record <name>" sends moves through the engine's pmove instead
+and logs their inputs, results and every trace and contents check they
+made; "sv pmove check <name>" feeds the logged inputs back through Pmove,
+answering its traces from the log, and reports any move whose results
+aren't bit-for-bit the same. The check runs under the sv_airaccelerate the
+log was recorded with, so keep one recorded with "sv_airaccelerate 1"
+alongside one with it off to cover both kinds of air movement.
+==============
+*/
+#ifdef CUSTOM_PMOVE
+// perform a player move
+void Pmove(pmove_t &pm);
+
+// whether "sv pmove record" is running
+bool Pmove_Recording();
+
+// perform a player move through the engine, logging it to the recording
+void Pmove_Record(pmove_t &pm);
+
+// "sv pmove [record <name>|stop|check <name>]"
+void Pmove_Command();
+#endif
@@ -0,0 +1,212 @@
+#include "../lib/types.h"
+#include "../lib/gi.h"
+#include "profile.h"
+
+#ifdef PROFILE
+#include "../lib/dynarray.h"
+#include "../lib/entity.h"
+#include "util.h"
+#include <algorithm>
+#include <cstdio>
+
+constexpr size_t MAX_PROFILE_ZONES = 64;
+
+struct profile_zone_stats
+{
+	stringlit	name;
+
+	// accumulated over the current frame
+	uint64_t	frame_ns;
+	uint32_t	frame_calls;
+
+	// totals of the last PROFILE_FRAMES frames
+	array<uint64_t, PROFILE_FRAMES>	history_ns;
+	array<uint32_t, PROFILE_FRAMES>	history_calls;
+	uint64_t						max_ns;
+};
+
+static array<profile_zone_stats, MAX_PROFILE_ZONES> profile_zones;
+static uint32_t num_profile_zones;
+static size_t profile_frame, profile_frames_recorded;
+
+struct profile_event
+{
+	uint32_t					zone;
+	profile_clock::time_point	start, end;
+};
+
+// events for a Chrome trace are only kept while a capture is running
+static struct
+{
+	string						filename;
+	uint32_t					frames_left;
+	profile_clock::time_point	epoch;
+	dynarray<profile_event>		events;
+} profile_capture;
+
+profile_zone::profile_zone(stringlit name) :
+	name(name),
+	id(num_profile_zones < MAX_PROFILE_ZONES ? num_profile_zones++ : (uint32_t)MAX_PROFILE_ZONES)
+{
+	if (id < MAX_PROFILE_ZONES)
+		profile_zones[id].name = name;
+}
+
+profile_scope::profile_scope(const profile_zone &zone) :
+	zone(zone),
+	start(profile_clock::now())
+{
+}
+
+profile_scope::~profile_scope()
+{
+	if (zone.id == MAX_PROFILE_ZONES)
+		return;
+
+	const profile_clock::time_point end = profile_clock::now();
+	profile_zone_stats &stats = profile_zones[zone.id];
+
+	stats.frame_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	stats.frame_calls++;
+
+	if (profile_capture.frames_left)
+		profile_capture.events.push_back({ zone.id, start, end });
+}
+
+static void Profile_WriteTrace()
+{
+	std::FILE *fp;
+
+	if (fopen_s(&fp, profile_capture.filename.ptr(), "w") || !fp)
+	{
+		gi.dprintf("profile: couldn't open %s for writing\n", profile_capture.filename.ptr());
+		profile_capture.events.clear();
+		return;
+	}
+
+	std::fprintf(fp, "{\"traceEvents\":[\n");
+
+	for (size_t i = 0; i < profile_capture.events.size(); i++)
+	{
+		const profile_event &ev = profile_capture.events[i];
+		const double ts = std::chrono::duration<double, std::micro>(ev.start - profile_capture.epoch).count();
+		const double dur = std::chrono::duration<double, std::micro>(ev.end - ev.start).count();
+
+		std::fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			profile_zones[ev.zone].name, ts, dur, (i + 1 < profile_capture.events.size()) ? "," : "");
+	}
+
+	std::fprintf(fp, "]}\n");
+	std::fclose(fp);
+
+	gi.dprintf("profile: wrote %u events to %s\n", (uint32_t)profile_capture.events.size(), profile_capture.filename.ptr());
+	profile_capture.events.clear();
+}
+
+void Profile_EndFrame()
+{
+	const size_t slot = profile_frame++ % PROFILE_FRAMES;
+
+	for (uint32_t i = 0; i < num_profile_zones; i++)
+	{
+		profile_zone_stats &stats = profile_zones[i];
+
+		stats.history_ns[slot] = stats.frame_ns;
+		stats.history_calls[slot] = stats.frame_calls;
+		stats.max_ns = max(stats.max_ns, stats.frame_ns);
+		stats.frame_ns = 0;
+		stats.frame_calls = 0;
+	}
+
+	profile_frames_recorded = min(profile_frames_recorded + 1, PROFILE_FRAMES);
+
+	if (profile_capture.frames_left && !--profile_capture.frames_left)
+		Profile_WriteTrace();
+}
+
+static void Profile_Reset()
+{
+	for (auto &stats : profile_zones)
+	{
+		stats.frame_ns = stats.max_ns = 0;
+		stats.frame_calls = 0;
+		stats.history_ns.fill(0);
+		stats.history_calls.fill(0);
+	}
+
+	profile_frame = profile_frames_recorded = 0;
+}
+
+static void Profile_Dump()
+{
+	if (!profile_frames_recorded)
+	{
+		gi.dprintf("profile: no frames recorded\n");
+		return;
+	}
+
+	struct zone_summary
+	{
+		uint32_t	id;
+		double		mean, p99, max, calls;
+	};
+
+	dynarray<zone_summary> summaries;
+	array<uint64_t, PROFILE_FRAMES> sorted;
+	const size_t n = profile_frames_recorded;
+
+	for (uint32_t i = 0; i < num_profile_zones; i++)
+	{
+		const profile_zone_stats &stats = profile_zones[i];
+		uint64_t total_ns = 0, total_calls = 0;
+
+		for (size_t f = 0; f < n; f++)
+		{
+			sorted[f] = stats.history_ns[f];
+			total_ns += stats.history_ns[f];
+			total_calls += stats.history_calls[f];
+		}
+
+		const size_t p99 = min(n - 1, (size_t)(n * 0.99));
+		std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.begin() + n);
+
+		summaries.push_back({ i, total_ns / 1e6 / n, sorted[p99] / 1e6, stats.max_ns / 1e6, (double)total_calls / n });
+	}
+
+	std::sort(summaries.begin(), summaries.end(), [](const zone_summary &a, const zone_summary &b) { return a.mean > b.mean; });
+
+	gi.dprintf("%u frames; ms per frame\n", (uint32_t)n);
+	gi.dprintf("%-28s %8s %8s %8s %10s\n", "zone", "mean", "p99", "max", "calls");
+
+	for (auto &summary : summaries)
+		gi.dprintf("%-28s %8.3f %8.3f %8.3f %10.1f\n", profile_zones[summary.id].name, summary.mean, summary.p99, summary.max, summary.calls);
+}
+
+void Profile_Command()
+{
+	string sub = gi.argc() > 2 ? strlwr(gi.argv(2)) : "";
+
+	if (sub == "reset")
+	{
+		Profile_Reset();
+		gi.dprintf("profile: reset\n");
+	}
+	else if (sub == "trace")
+	{
+		if (gi.argc() < 5)
+		{
+			gi.dprintf("usage: sv profile trace <frames> <name>\n");
+			return;
+		}
+
+		profile_capture.filename = G_GamePath(gi.argv(4), "json");
+		profile_capture.frames_left = max(1, atoi(gi.argv(3)));
+		profile_capture.epoch = profile_clock::now();
+		profile_capture.events.clear();
+
+		gi.dprintf("profile: capturing %u frames to %s\n", profile_capture.frames_left, profile_capture.filename.ptr());
+	}
+	else
+		Profile_Dump();
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../lib/types.h"
+
+/*
+==============
+profiler
+
+PROFILE_ZONE("name") times the rest of the scope it's placed in. Zones
+are summed per server frame and the last PROFILE_FRAMES frames are kept,
+so "sv profile" can report mean, p99 and max per zone. Without PROFILE
+in config.h every zone compiles to nothing.
+==============
+*/
+#ifdef PROFILE
+#include <chrono>
+
+using profile_clock = std::chrono::steady_clock;
+
+constexpr size_t PROFILE_FRAMES = 256;
+
+// one static instance per PROFILE_ZONE site
+struct profile_zone
+{
+	stringlit	name;
+	uint32_t	id;
+
+	explicit profile_zone(stringlit name);
+};
+
+// times the scope it lives in
+class profile_scope
+{
+	const profile_zone			&zone;
+	profile_clock::time_point	start;
+
+public:
+	profile_scope(const profile_zone &zone);
+	~profile_scope();
+};
+
+#define PROFILE_CONCAT2(a, b) a ## b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+
+#define PROFILE_ZONE(name) \
+	static const profile_zone PROFILE_CONCAT(_profile_zone_, __LINE__)(name); \
+	const profile_scope PROFILE_CONCAT(_profile_scope_, __LINE__)(PROFILE_CONCAT(_profile_zone_, __LINE__))
+
+// close out the current frame's zone totals
+void Profile_EndFrame();
+
+// "sv profile [reset | trace <frames> <name>]"
+void Profile_Command();
+#else
+#define PROFILE_ZONE(name)
+#endif
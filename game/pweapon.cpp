@@ -507,23 +507,19 @@ Weapon_Generic
 A generic function to handle the basics of weapon thinking
 ================
 */
-void Weapon_Generic(entity &ent, int32_t FRAME_ACTIVATE_LAST, int32_t FRAME_FIRE_LAST, int32_t FRAME_IDLE_LAST, int32_t FRAME_DEACTIVATE_LAST, std::initializer_list<int32_t> is_pause_frame, std::initializer_list<int32_t> is_fire_frame, fire_func *fire)
+void Weapon_Generic(entity &ent, const weapon_frames &frames)
 {
-	const int32_t FRAME_FIRE_FIRST	= FRAME_ACTIVATE_LAST + 1;
-	const int32_t FRAME_IDLE_FIRST	= FRAME_FIRE_LAST + 1;
-	const int32_t FRAME_DEACTIVATE_FIRST = FRAME_IDLE_LAST + 1;
-
 	if (ent.g.deadflag || ent.s.modelindex != MODEL_PLAYER) // VWep animations screw up corpses
 		return;
 
 	if (ent.client->g.weaponstate == WEAPON_DROPPING)
 	{
-		if (ent.client->ps.gunframe == FRAME_DEACTIVATE_LAST)
+		if (ent.client->ps.gunframe == frames.deactivate_last)
 		{
 			ChangeWeapon(ent);
 			return;
 		}
-		else if ((FRAME_DEACTIVATE_LAST - ent.client->ps.gunframe) == 4)
+		else if ((frames.deactivate_last - ent.client->ps.gunframe) == 4)
 		{
 			ent.client->g.anim_priority = ANIM_REVERSE;
 			if (ent.client->ps.pmove.pm_flags & PMF_DUCKED)
@@ -544,10 +540,10 @@ void Weapon_Generic(entity &ent, int32_t FRAME_ACTIVATE_LAST, int32_t FRAME_FIRE
 
 	if (ent.client->g.weaponstate == WEAPON_ACTIVATING)
 	{
-		if (ent.client->ps.gunframe == FRAME_ACTIVATE_LAST)
+		if (ent.client->ps.gunframe == frames.activate_last)
 		{
 			ent.client->g.weaponstate = WEAPON_READY;
-			ent.client->ps.gunframe = FRAME_IDLE_FIRST;
+			ent.client->ps.gunframe = frames.idle_first;
 			return;
 		}
 
@@ -558,9 +554,9 @@ void Weapon_Generic(entity &ent, int32_t FRAME_ACTIVATE_LAST, int32_t FRAME_FIRE
 	if (ent.client->g.newweapon && (ent.client->g.weaponstate != WEAPON_FIRING))
 	{
 		ent.client->g.weaponstate = WEAPON_DROPPING;
-		ent.client->ps.gunframe = FRAME_DEACTIVATE_FIRST;
+		ent.client->ps.gunframe = frames.deactivate_first;
 
-		if ((FRAME_DEACTIVATE_LAST - FRAME_DEACTIVATE_FIRST) < 4)
+		if ((frames.deactivate_last - frames.deactivate_first) < 4)
 		{
 			ent.client->g.anim_priority = ANIM_REVERSE;
 			if (ent.client->ps.pmove.pm_flags & PMF_DUCKED)
@@ -586,7 +582,7 @@ void Weapon_Generic(entity &ent, int32_t FRAME_ACTIVATE_LAST, int32_t FRAME_FIRE
 			if (!ent.client->g.ammo_index || 
 				(ent.client->g.pers.inventory[ent.client->g.ammo_index] >= ent.client->g.pers.weapon->quantity))
 			{
-				ent.client->ps.gunframe = FRAME_FIRE_FIRST;
+				ent.client->ps.gunframe = frames.fire_first;
 				ent.client->g.weaponstate = WEAPON_FIRING;
 
 				// start the animation
@@ -614,15 +610,14 @@ void Weapon_Generic(entity &ent, int32_t FRAME_ACTIVATE_LAST, int32_t FRAME_FIRE
 		}
 		else
 		{
-			if (ent.client->ps.gunframe == FRAME_IDLE_LAST)
+			if (ent.client->ps.gunframe == frames.idle_last)
 			{
-				ent.client->ps.gunframe = FRAME_IDLE_FIRST;
+				ent.client->ps.gunframe = frames.idle_first;
 				return;
 			}
 
-			for (auto &frame : is_pause_frame)
-				if (frame == ent.client->ps.gunframe && (Q_rand() & 15))
-					return;
+			if (frames.pause_frames[ent.client->ps.gunframe] && (Q_rand() & 15))
+				return;
 
 			ent.client->ps.gunframe++;
 			return;
@@ -631,36 +626,29 @@ void Weapon_Generic(entity &ent, int32_t FRAME_ACTIVATE_LAST, int32_t FRAME_FIRE
 
 	if (ent.client->g.weaponstate == WEAPON_FIRING)
 	{
-		bool fired = false;
-
-		for (auto &frame : is_fire_frame)
-			if (frame == ent.client->ps.gunframe)
-			{
+		if (frames.fire_frames[ent.client->ps.gunframe])
+		{
 #ifdef CTF
-				if (CTFApplyStrengthSound(ent)) { }
-				else
+			if (CTFApplyStrengthSound(ent)) { }
+			else
 #endif
-				if (ent.client->g.quad_framenum > level.framenum)
-					gi.sound(ent, CHAN_ITEM, gi.soundindex("items/damage3.wav"), 1, ATTN_NORM, 0);
+			if (ent.client->g.quad_framenum > level.framenum)
+				gi.sound(ent, CHAN_ITEM, gi.soundindex("items/damage3.wav"), 1, ATTN_NORM, 0);
 #ifdef GROUND_ZERO
-				else if (ent.client.double_framenum > level.framenum)
-					gi.sound(ent, CHAN_ITEM, gi.soundindex("misc/ddamage3.wav"), 1, ATTN_NORM, 0);
+			else if (ent.client.double_framenum > level.framenum)
+				gi.sound(ent, CHAN_ITEM, gi.soundindex("misc/ddamage3.wav"), 1, ATTN_NORM, 0);
 #endif
 
 #ifdef CTF
-				CTFApplyHasteSound(ent);
+			CTFApplyHasteSound(ent);
 #endif
 
-				fire(ent);
-
-				fired = true;
-				break;
-			}
-
-		if (!fired)
+			frames.fire(ent);
+		}
+		else
 			ent.client->ps.gunframe++;
 
-		if (ent.client->ps.gunframe == FRAME_IDLE_FIRST + 1)
+		if (ent.client->ps.gunframe == frames.idle_first + 1)
 			ent.client->g.weaponstate = WEAPON_READY;
 	}
 }
@@ -874,9 +862,11 @@ static void weapon_grenadelauncher_fire(entity &ent)
 		ent.client->g.pers.inventory[ent.client->g.ammo_index]--;
 }
 
+static constexpr weapon_frames grenade_launcher_frames(5, 16, 59, 64, { 34, 51, 59 }, { 6 }, weapon_grenadelauncher_fire);
+
 void Weapon_GrenadeLauncher(entity &ent)
 {
-	Weapon_Generic(ent, 5, 16, 59, 64, { 34, 51, 59 }, { 6 }, weapon_grenadelauncher_fire);
+	Weapon_Generic(ent, grenade_launcher_frames);
 }
 
 /*
@@ -928,9 +918,11 @@ static void Weapon_RocketLauncher_Fire(entity &ent)
 		ent.client->g.pers.inventory[ent.client->g.ammo_index]--;
 }
 
+static constexpr weapon_frames rocket_launcher_frames(4, 12, 50, 54, { 25, 33, 42, 50 }, { 5 }, Weapon_RocketLauncher_Fire);
+
 void Weapon_RocketLauncher(entity &ent)
 {
-	Weapon_Generic(ent, 4, 12, 50, 54, { 25, 33, 42, 50 }, { 5 }, Weapon_RocketLauncher_Fire);
+	Weapon_Generic(ent, rocket_launcher_frames);
 }
 
 /*
@@ -989,9 +981,11 @@ static void Weapon_Blaster_Fire(entity &ent)
 	ent.client->ps.gunframe++;
 }
 
+static constexpr weapon_frames blaster_frames(4, 8, 52, 55, { 19, 32 }, { 5 }, Weapon_Blaster_Fire);
+
 void Weapon_Blaster(entity &ent)
 {
-	Weapon_Generic(ent, 4, 8, 52, 55, { 19, 32 }, { 5 }, Weapon_Blaster_Fire);
+	Weapon_Generic(ent, blaster_frames);
 }
 
 static void Weapon_HyperBlaster_Fire(entity &ent)
@@ -1064,9 +1058,11 @@ static void Weapon_HyperBlaster_Fire(entity &ent)
 	}
 }
 
+static constexpr weapon_frames hyperblaster_frames(5, 20, 49, 53, {}, { 6, 7, 8, 9, 10, 11 }, Weapon_HyperBlaster_Fire);
+
 void Weapon_HyperBlaster(entity &ent)
 {
-	Weapon_Generic(ent, 5, 20, 49, 53, {}, { 6, 7, 8, 9, 10, 11 }, Weapon_HyperBlaster_Fire);
+	Weapon_Generic(ent, hyperblaster_frames);
 }
 
 /*
@@ -1166,9 +1162,11 @@ static void Machinegun_Fire(entity &ent)
 	}
 }
 
+static constexpr weapon_frames machinegun_frames(3, 5, 45, 49, { 23, 45 }, { 4, 5 }, Machinegun_Fire);
+
 void Weapon_Machinegun(entity &ent)
 {
-	Weapon_Generic(ent, 3, 5, 45, 49, { 23, 45 }, { 4, 5 }, Machinegun_Fire);
+	Weapon_Generic(ent, machinegun_frames);
 }
 
 static void Chaingun_Fire(entity &ent)
@@ -1287,9 +1285,11 @@ static void Chaingun_Fire(entity &ent)
 		ent.client->g.pers.inventory[ent.client->g.ammo_index] -= shots;
 }
 
+static constexpr weapon_frames chaingun_frames(4, 31, 61, 64, { 38, 43, 51, 61 }, { 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21 }, Chaingun_Fire);
+
 void Weapon_Chaingun(entity &ent)
 {
-	Weapon_Generic(ent, 4, 31, 61, 64, { 38, 43, 51, 61 }, { 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21 }, Chaingun_Fire);
+	Weapon_Generic(ent, chaingun_frames);
 }
 
 /*
@@ -1345,9 +1345,11 @@ static void weapon_shotgun_fire(entity &ent)
 		ent.client->g.pers.inventory[ent.client->g.ammo_index]--;
 }
 
+static constexpr weapon_frames shotgun_frames(7, 18, 36, 39, { 22, 28, 34 }, { 8, 9 }, weapon_shotgun_fire);
+
 void Weapon_Shotgun(entity &ent)
 {
-	Weapon_Generic(ent, 7, 18, 36, 39, { 22, 28, 34 }, { 8, 9 }, weapon_shotgun_fire);
+	Weapon_Generic(ent, shotgun_frames);
 }
 
 static void weapon_supershotgun_fire(entity &ent)
@@ -1397,9 +1399,11 @@ static void weapon_supershotgun_fire(entity &ent)
 		ent.client->g.pers.inventory[ent.client->g.ammo_index] -= 2;
 }
 
+static constexpr weapon_frames super_shotgun_frames(6, 17, 57, 61, { 29, 42, 57 }, { 7 }, weapon_supershotgun_fire);
+
 void Weapon_SuperShotgun(entity &ent)
 {
-	Weapon_Generic(ent, 6, 17, 57, 61, { 29, 42, 57 }, { 7 }, weapon_supershotgun_fire);
+	Weapon_Generic(ent, super_shotgun_frames);
 }
 
 /*
@@ -1463,9 +1467,11 @@ static void weapon_railgun_fire(entity &ent)
 		ent.client->g.pers.inventory[ent.client->g.ammo_index]--;
 }
 
+static constexpr weapon_frames railgun_frames(3, 18, 56, 61, { 56 }, { 4 }, weapon_railgun_fire);
+
 void Weapon_Railgun(entity &ent)
 {
-	Weapon_Generic(ent, 3, 18, 56, 61, { 56 }, { 4 }, weapon_railgun_fire);
+	Weapon_Generic(ent, railgun_frames);
 }
 
 /*
@@ -1542,7 +1548,9 @@ static void weapon_bfg_fire(entity &ent)
 		ent.client->g.pers.inventory[ent.client->g.ammo_index] -= 50;
 }
 
+static constexpr weapon_frames bfg_frames(8, 32, 55, 58, { 39, 45, 50, 55 }, { 9, 17 }, weapon_bfg_fire);
+
 void Weapon_BFG(entity &ent)
 {
-	Weapon_Generic(ent, 8, 32, 55, 58, { 39, 45, 50, 55 }, { 9, 17 }, weapon_bfg_fire);
+	Weapon_Generic(ent, bfg_frames);
 }
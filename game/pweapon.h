@@ -53,7 +53,83 @@ Drop_Weapon
 */
 void Drop_Weapon(entity &ent, const gitem_t &it);
 
-void Weapon_Generic(entity &ent, int32_t FRAME_ACTIVATE_LAST, int32_t FRAME_FIRE_LAST, int32_t FRAME_IDLE_LAST, int32_t FRAME_DEACTIVATE_LAST, std::initializer_list<int32_t> is_pause_frame, std::initializer_list<int32_t> is_fire_frame, fire_func *fire);
+// gun frames at or above this can't be used in a weapon_frames
+constexpr int32_t MAX_WEAPON_FRAMES = 128;
+
+// thrown on a gun frame that doesn't fit in a weapon_frame_set
+class weapon_frame_out_of_range : public std::exception
+{
+public:
+	weapon_frame_out_of_range() :
+		std::exception("gun frame out of range for weapon_frame_set", 1)
+	{
+	}
+};
+
+// a set of gun frames, stored as a bitset so that membership
+// is a single bit test.
+struct weapon_frame_set
+{
+	array<uint64_t, MAX_WEAPON_FRAMES / 64>	bits {};
+
+	constexpr weapon_frame_set(std::initializer_list<int32_t> frames)
+	{
+		for (const int32_t &frame : frames)
+			bits[frame >= 0 && frame < MAX_WEAPON_FRAMES ? (frame >> 6) : throw weapon_frame_out_of_range()] |= 1ull << (frame & 63);
+	}
+
+	constexpr bool operator[](const int32_t &frame) const
+	{
+		return (uint32_t)frame < (uint32_t)MAX_WEAPON_FRAMES && (bits[frame >> 6] & (1ull << (frame & 63)));
+	}
+};
+
+// describes the view model animation of a weapon for Weapon_Generic.
+// the four ranges (activate, fire, idle, deactivate) are laid out
+// back to back starting at frame 0, so only the last frame of each is given.
+struct weapon_frames
+{
+	int32_t	activate_last, fire_last, idle_last, deactivate_last;
+	int32_t	fire_first, idle_first, deactivate_first;
+
+	// idle frames that randomly hold the animation
+	weapon_frame_set	pause_frames;
+	// firing frames that call fire
+	weapon_frame_set	fire_frames;
+	fire_func			*fire;
+
+	constexpr weapon_frames(int32_t activate_last, int32_t fire_last, int32_t idle_last, int32_t deactivate_last, std::initializer_list<int32_t> pause_frames, std::initializer_list<int32_t> fire_frames, fire_func *fire) :
+		activate_last(activate_last),
+		fire_last(fire_last),
+		idle_last(idle_last),
+		deactivate_last(deactivate_last < MAX_WEAPON_FRAMES ? deactivate_last : throw weapon_frame_out_of_range()),
+		fire_first(activate_last + 1),
+		idle_first(fire_last + 1),
+		deactivate_first(idle_last + 1),
+		pause_frames(pause_frames),
+		fire_frames(fire_frames),
+		fire(fire)
+	{
+	}
+};
+
+/*
+================
+Weapon_Generic
+
+A generic function to handle the basics of weapon thinking
+================
+*/
+void Weapon_Generic(entity &ent, const weapon_frames &frames);
+
+// a weapon think that is entirely described by its frames; this can be
+// used directly as an item's weaponthink, for weapons that don't need
+// anything more than Weapon_Generic.
+template<const weapon_frames &frames>
+void Weapon_Think(entity &ent)
+{
+	Weapon_Generic(ent, frames);
+}
 
 constexpr float GRENADE_TIMER	= 3.0f;
 constexpr int GRENADE_MINSPEED	= 400;
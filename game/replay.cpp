@@ -0,0 +1,287 @@
+#include "../lib/types.h"
+#include "../lib/entity.h"
+#include "../lib/gi.h"
+#include "../lib/dynarray.h"
+#include "game.h"
+#include "util.h"
+#include "replay.h"
+#include <random>
+#include <cstdio>
+
+// usercmds are delta-encoded a byte at a time against the client's previous
+// one, with a 16-bit mask saying which bytes follow
+static_assert(sizeof(usercmd) == 16, "usercmd delta mask assumes a packed 16-byte usercmd");
+
+// cvars that change how the game behaves, captured when recording starts
+static constexpr stringlit replay_cvars[] = {
+	"maxclients", "maxentities", "maxspectators", "deathmatch", "dmflags", "fraglimit", "timelimit",
+	"cheats", "filterban", "g_select_empty", "sv_gravity", "sv_maxvelocity", "sv_rollspeed", "sv_rollangle",
+	"run_pitch", "run_roll", "bob_up", "bob_pitch", "bob_roll", "flood_msgs", "flood_persecond",
+	"flood_waitdelay", "sv_maplist", "sv_features", "g_spawn_cache", "g_debris_max", "g_debris_per_frame"
+};
+
+/*
+==============
+recording
+==============
+*/
+static struct
+{
+	std::FILE			*fp;
+	string				filename;
+	// waiting for the next level spawn to start the log
+	bool				pending;
+	gtime				frames;
+	uint64_t			events, bytes;
+	dynarray<usercmd>	last_cmds;
+	dynarray<uint8_t>	buffer;
+} recorder;
+
+static void Replay_WriteByte(uint8_t b)
+{
+	recorder.buffer.push_back(b);
+}
+
+static void Replay_WriteVarint(uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		Replay_WriteByte((uint8_t)(v | 0x80));
+		v >>= 7;
+	}
+
+	Replay_WriteByte((uint8_t)v);
+}
+
+static void Replay_WriteString(stringlit s)
+{
+	const size_t len = s ? strlen(s) : 0;
+
+	Replay_WriteVarint(len);
+	recorder.buffer.insert(recorder.buffer.end(), (const uint8_t *)s, (const uint8_t *)s + len);
+}
+
+static void Replay_WriteArgs()
+{
+	const size_t argc = gi.argc();
+
+	Replay_WriteVarint(argc);
+
+	for (size_t i = 0; i < argc; i++)
+		Replay_WriteString(gi.argv(i));
+}
+
+static void Replay_BeginEvent(replay_event_type type)
+{
+	recorder.buffer.clear();
+	Replay_WriteByte(type);
+}
+
+static void Replay_EndEvent()
+{
+	if (std::fwrite(recorder.buffer.data(), 1, recorder.buffer.size(), recorder.fp) != recorder.buffer.size())
+	{
+		gi.dprintf("replay: write to %s failed, recording stopped\n", recorder.filename.ptr());
+		Replay_Stop();
+		return;
+	}
+
+	recorder.events++;
+	recorder.bytes += recorder.buffer.size();
+}
+
+static inline bool Replay_Recording()
+{
+	return recorder.fp && !recorder.pending;
+}
+
+uint32_t Replay_LevelSeed(bool &fixed)
+{
+	stringlit seed = g_seed.string;
+
+	// any number is a seed, 0 included; only an empty g_seed is random
+	fixed = seed && *seed;
+
+	if (fixed)
+		return (uint32_t)strtoul(seed, nullptr, 10);
+
+	return std::random_device()();
+}
+
+void Replay_Record(stringlit name)
+{
+	Replay_Stop();
+
+	string filename = G_GamePath(name, "rpl");
+
+	if (fopen_s(&recorder.fp, filename.ptr(), "wb") || !recorder.fp)
+	{
+		recorder.fp = nullptr;
+		gi.dprintf("replay: couldn't open %s for writing\n", filename.ptr());
+		return;
+	}
+
+	recorder.filename = filename;
+	recorder.pending = true;
+	recorder.frames = recorder.events = recorder.bytes = 0;
+
+	gi.dprintf("replay: recording to %s from the next level spawn\n", filename.ptr());
+}
+
+void Replay_Stop()
+{
+	if (!recorder.fp)
+		return;
+
+	if (!recorder.pending)
+	{
+		Replay_BeginEvent(REPLAY_END);
+		std::fwrite(recorder.buffer.data(), 1, recorder.buffer.size(), recorder.fp);
+	}
+
+	std::fclose(recorder.fp);
+	recorder.fp = nullptr;
+
+	gi.dprintf("replay: stopped %s; %llu frames, %llu events, %llu bytes\n", recorder.filename.ptr(), recorder.frames, recorder.events, recorder.bytes);
+}
+
+void Replay_Status()
+{
+	if (!recorder.fp)
+		gi.dprintf("replay: not recording\n");
+	else if (recorder.pending)
+		gi.dprintf("replay: %s waiting for a level spawn\n", recorder.filename.ptr());
+	else
+		gi.dprintf("replay: recording %s; %llu frames, %llu events, %llu bytes\n", recorder.filename.ptr(), recorder.frames, recorder.events, recorder.bytes);
+}
+
+void Replay_SpawnEntities(uint32_t seed, bool fixed_seed, stringlit mapname, stringlit entstring, stringlit spawnpoint)
+{
+	if (!recorder.fp)
+		return;
+
+	if (recorder.pending)
+	{
+		recorder.buffer.clear();
+		recorder.buffer.resize(8);
+		memcpy(recorder.buffer.data(), &REPLAY_MAGIC, sizeof(uint32_t));
+		memcpy(recorder.buffer.data() + 4, &REPLAY_VERSION, sizeof(uint32_t));
+
+		Replay_WriteVarint(lengthof(replay_cvars));
+
+		for (stringlit name : replay_cvars)
+		{
+			Replay_WriteString(name);
+			Replay_WriteString(gi.cvar(name, "", CVAR_NONE).string);
+		}
+
+		recorder.pending = false;
+		Replay_EndEvent();
+
+		if (!recorder.fp)
+			return;
+	}
+
+	recorder.last_cmds.assign(game.maxclients, usercmd {});
+
+	Replay_BeginEvent(REPLAY_SPAWN);
+	Replay_WriteByte(fixed_seed ? REPLAY_SPAWN_FIXED_SEED : REPLAY_SPAWN_NONE);
+	Replay_WriteVarint(seed);
+	Replay_WriteString(mapname);
+	Replay_WriteString(entstring);
+	Replay_WriteString(spawnpoint);
+	Replay_EndEvent();
+}
+
+static void Replay_ClientEvent(replay_event_type type, const entity &ent, stringlit userinfo = nullptr)
+{
+	if (!Replay_Recording())
+		return;
+
+	Replay_BeginEvent(type);
+	Replay_WriteVarint(ent.s.number - 1);
+
+	if (type == REPLAY_CONNECT || type == REPLAY_USERINFO)
+		Replay_WriteString(userinfo);
+	else if (type == REPLAY_COMMAND)
+		Replay_WriteArgs();
+
+	Replay_EndEvent();
+}
+
+void Replay_ClientConnect(const entity &ent, stringlit userinfo)
+{
+	if (Replay_Recording())
+		recorder.last_cmds[ent.s.number - 1] = {};
+
+	Replay_ClientEvent(REPLAY_CONNECT, ent, userinfo);
+}
+
+void Replay_ClientBegin(const entity &ent)
+{
+	Replay_ClientEvent(REPLAY_BEGIN, ent);
+}
+
+void Replay_ClientUserinfoChanged(const entity &ent, stringlit userinfo)
+{
+	Replay_ClientEvent(REPLAY_USERINFO, ent, userinfo);
+}
+
+void Replay_ClientDisconnect(const entity &ent)
+{
+	Replay_ClientEvent(REPLAY_DISCONNECT, ent);
+}
+
+void Replay_ClientCommand(const entity &ent)
+{
+	Replay_ClientEvent(REPLAY_COMMAND, ent);
+}
+
+void Replay_ClientThink(const entity &ent, const usercmd &cmd)
+{
+	if (!Replay_Recording())
+		return;
+
+	usercmd &last = recorder.last_cmds[ent.s.number - 1];
+	const uint8_t *from = (const uint8_t *)&last;
+	const uint8_t *to = (const uint8_t *)&cmd;
+	uint16_t mask = 0;
+
+	for (size_t i = 0; i < sizeof(usercmd); i++)
+		if (from[i] != to[i])
+			mask |= 1 << i;
+
+	Replay_BeginEvent(REPLAY_THINK);
+	Replay_WriteVarint(ent.s.number - 1);
+	Replay_WriteVarint(mask);
+
+	for (size_t i = 0; i < sizeof(usercmd); i++)
+		if (mask & (1 << i))
+			Replay_WriteByte(to[i]);
+
+	Replay_EndEvent();
+
+	last = cmd;
+}
+
+void Replay_RunFrame()
+{
+	if (!Replay_Recording())
+		return;
+
+	Replay_BeginEvent(REPLAY_FRAME);
+	Replay_EndEvent();
+	recorder.frames++;
+}
+
+void Replay_ServerCommand()
+{
+	// don't record the recorder, or the profiler the bench
+	// host drives while it plays a log back
+	if (!Replay_Recording() || !strcmp(gi.argv(1), "replay") || !strcmp(gi.argv(1), "profile"))
+		return;
+
+	Replay_BeginEvent(REPLAY_SERVERCOMMAND);
+	Replay_WriteArgs();
+	Replay_EndEvent();
+}
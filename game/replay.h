@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../lib/types.h"
+import usercmd;
+
+/*
+==============
+replays
+
+A replay is a binary log of everything the engine feeds into the game module:
+the cvars it was started with, the RNG seed and entity lump of every level,
+client connections, userinfo changes, commands and every usercmd, in order.
+Playing one back through the same entry points reproduces the same frames,
+which is what makes frame-time spikes from live servers reproducible; the
+bench host's --replay mode does that headlessly.
+
+The game only writes them. The bench host reads them without including
+anything from the game, so if the layout below changes, its reader in
+host/bench.cpp has to change with it.
+
+	uint32 magic, uint32 version
+	varint count, then count pairs of string cvar name, string value
+	events, each a byte replay_event_type followed by its fields
+
+Integers are varints (7 bits a byte, low first), strings are a varint length
+followed by that many bytes, and a usercmd is a varint mask of the bytes that
+changed from the client's previous one followed by those bytes.
+==============
+*/
+
+constexpr uint32_t REPLAY_MAGIC = 'P' << 24 | 'R' << 16 | '2' << 8 | 'Q';
+constexpr uint32_t REPLAY_VERSION = 2;
+
+enum replay_event_type : uint8_t
+{
+	REPLAY_END,
+	// RunFrame; everything that follows belongs to the next frame
+	REPLAY_FRAME,
+	// flags, seed, mapname, entity lump, spawnpoint
+	REPLAY_SPAWN,
+	// client, userinfo
+	REPLAY_CONNECT,
+	// client
+	REPLAY_BEGIN,
+	// client, userinfo
+	REPLAY_USERINFO,
+	// client
+	REPLAY_DISCONNECT,
+	// client, argv
+	REPLAY_COMMAND,
+	// argv
+	REPLAY_SERVERCOMMAND,
+	// client, usercmd as a delta from the client's previous one
+	REPLAY_THINK
+};
+
+enum replay_spawn_flags : uint8_t
+{
+	REPLAY_SPAWN_NONE,
+	// the seed came from g_seed rather than being picked at random.
+	// either way it's the seed the level ran with.
+	REPLAY_SPAWN_FIXED_SEED	= 1 << 0
+};
+
+// pick the seed for the level about to be spawned: g_seed if set,
+// otherwise a fresh random one. it is recorded either way, and
+// fixed is set to whether it came from g_seed.
+uint32_t Replay_LevelSeed(bool &fixed);
+
+// start recording to filename; the log starts at the next level spawn
+void Replay_Record(stringlit filename);
+
+// stop recording and close the log
+void Replay_Stop();
+
+// print the recorder's state
+void Replay_Status();
+
+// recorder hooks, called from the game_export wrappers
+void Replay_SpawnEntities(uint32_t seed, bool fixed_seed, stringlit mapname, stringlit entstring, stringlit spawnpoint);
+void Replay_ClientConnect(const entity &ent, stringlit userinfo);
+void Replay_ClientBegin(const entity &ent);
+void Replay_ClientUserinfoChanged(const entity &ent, stringlit userinfo);
+void Replay_ClientDisconnect(const entity &ent);
+void Replay_ClientCommand(const entity &ent);
+void Replay_ClientThink(const entity &ent, const usercmd &cmd);
+void Replay_RunFrame();
+void Replay_ServerCommand();
@@ -6,9 +6,11 @@
 #include "util.h"
 #include "itemlist.h"
 #include "player.h"
+#include "misc.h"
 #ifdef BOTS
 #include "ai/aimain.h"
 #endif
+#include <chrono>
 
 // this doesn't use game_allocator. need to investigate if memory allocated here
 // will be safe during a crash...
@@ -33,24 +35,39 @@ static inline std::vector<registered_entity> &get_registered_entities()
 	return get_registered_entities().data() + get_registered_entities().size();
 }
 
-using spawn_deserializer = bool(*)(const string &input, void *output);
+// a parsed, typed spawn value. which member is valid depends on the
+// type of the field it was parsed for.
+struct spawn_value
+{
+	string	str;
+
+	union
+	{
+		int64_t	integer = 0;
+		float	single;
+		double	dbl;
+		vector	vec;
+	};
+};
+
+using spawn_parser = bool(*)(const string &input, spawn_value &output);
+using spawn_applier = void(*)(const spawn_value &input, void *output);
 
 struct spawn_field
 {
-	stringlit			key;
-	size_t				offset;
-	spawn_deserializer	func;
-	bool				is_temp;
+	stringlit		key;
+	size_t			offset;
+	spawn_parser	parse;
+	spawn_applier	apply;
+	bool			is_temp;
 };
 
 template<typename T>
-static bool deserialize(const string &input, void *output)
+static bool parse(const string &input, spawn_value &output)
 {
-	T *out = (T *)output;
-
 	if constexpr(std::is_same_v<T, string> || std::is_same_v<T, stringref>)
 	{
-		*out = input;
+		output.str = input;
 		return true;
 	}
 	else if constexpr(std::is_integral_v<T> || std::is_enum_v<T>)
@@ -60,16 +77,16 @@ static bool deserialize(const string &input, void *output)
 		if constexpr(std::is_unsigned_v<T>)
 		{
 			if constexpr(sizeof(T) > 4)
-				*out = (T)strtoull(input.ptr(), (char **)&endptr, 10);
+				output.integer = (int64_t)strtoull(input.ptr(), (char **)&endptr, 10);
 			else
-				*out = (T)strtoul(input.ptr(), (char **)&endptr, 10);
+				output.integer = (int64_t)strtoul(input.ptr(), (char **)&endptr, 10);
 		}
 		else
 		{
 			if constexpr(sizeof(T) > 4)
-				*out = (T)strtoll(input.ptr(), (char **)&endptr, 10);
+				output.integer = (int64_t)strtoll(input.ptr(), (char **)&endptr, 10);
 			else
-				*out = (T)strtol(input.ptr(), (char **)&endptr, 10);
+				output.integer = (int64_t)strtol(input.ptr(), (char **)&endptr, 10);
 		}
 
 		return endptr;
@@ -79,9 +96,9 @@ static bool deserialize(const string &input, void *output)
 		char *endptr;
 
 		if constexpr(sizeof(T) > 4)
-			*out = (T)strtod(input.ptr(), (char **)&endptr);
+			output.dbl = strtod(input.ptr(), (char **)&endptr);
 		else
-			*out = (T)strtof(input.ptr(), (char **)&endptr);
+			output.single = strtof(input.ptr(), (char **)&endptr);
 
 		return endptr;
 	}
@@ -91,7 +108,7 @@ static bool deserialize(const string &input, void *output)
 
 		for (size_t i = 0; i < 3; i++)
 		{
-			(*out)[i] = strtof(endptr, (char **)&endptr);
+			output.vec[i] = strtof(endptr, (char **)&endptr);
 
 			if (!endptr)
 				return false;
@@ -103,14 +120,36 @@ static bool deserialize(const string &input, void *output)
 		static_assert(false, "dunno how to deserialize this");
 }
 
+template<typename T>
+static void apply(const spawn_value &input, void *output)
+{
+	T *out = (T *)output;
+
+	if constexpr(std::is_same_v<T, string> || std::is_same_v<T, stringref>)
+		*out = input.str;
+	else if constexpr(std::is_integral_v<T> || std::is_enum_v<T>)
+		*out = (T)input.integer;
+	else if constexpr(std::is_floating_point_v<T>)
+	{
+		if constexpr(sizeof(T) > 4)
+			*out = (T)input.dbl;
+		else
+			*out = (T)input.single;
+	}
+	else if constexpr(std::is_same_v<T, vector>)
+		*out = input.vec;
+	else
+		static_assert(false, "dunno how to deserialize this");
+}
+
 #define SPAWN_EFIELD_NAMED(name, field) \
-	{ name, offsetof(entity, field), deserialize<decltype(entity::field)>, false }
+	{ name, offsetof(entity, field), parse<decltype(entity::field)>, apply<decltype(entity::field)>, false }
 
 #define SPAWN_EFIELD(name) \
 	SPAWN_EFIELD_NAMED(#name, g.name)
 
 #define SPAWN_TFIELD_NAMED(name, field) \
-	{ name, offsetof(spawn_temp, field), deserialize<decltype(spawn_temp::field)>, true }
+	{ name, offsetof(spawn_temp, field), parse<decltype(spawn_temp::field)>, apply<decltype(spawn_temp::field)>, true }
 
 #define SPAWN_TFIELD(name) \
 	SPAWN_TFIELD_NAMED(#name, name)
@@ -172,15 +211,40 @@ constexpr spawn_field spawn_fields[] =
 	SPAWN_TFIELD(maxpitch)
 };
 
-static bool ED_ParseField(const string &key, const string &value, entity &ent)
+// a single parsed key/value pair, as it will be applied to an entity.
+// field is an index into spawn_fields; SPAWN_RECORD_END marks
+// the closing brace of an entity.
+struct spawn_record
+{
+	uint16_t	field;
+	spawn_value	value;
+};
+
+constexpr uint16_t SPAWN_RECORD_END = (uint16_t)-1;
+
+static_assert(std::size(spawn_fields) < SPAWN_RECORD_END, "too many spawn fields");
+
+static inline void ED_ApplyField(const spawn_field &field, const spawn_value &value, entity &ent)
+{
+	field.apply(value, (field.is_temp ? (uint8_t *)&st : (uint8_t *)&ent) + field.offset);
+}
+
+static bool ED_ParseField(const string &key, const string &value, entity &ent, dynarray<spawn_record> *records)
 {
 	for (auto &field : spawn_fields)
 	{
 		if (!striequals(field.key, key))
 			continue;
 
-		if (field.func)
-			field.func(value, (field.is_temp ? (uint8_t *)&st : (uint8_t *)&ent) + field.offset);
+		if (field.parse)
+		{
+			spawn_record record { (uint16_t)(&field - spawn_fields) };
+			field.parse(value, record.value);
+			ED_ApplyField(field, record.value, ent);
+
+			if (records)
+				records->push_back(std::move(record));
+		}
 
 		return true;
 	}
@@ -193,7 +257,9 @@ static void ClearSpawnTemp()
 	st = {};
 }
 
-static void ED_ParseEdict(stringlit entities, size_t &entities_offset, entity &ent)
+// if records is non-null, every applied field is also appended to it
+// so that the entity can be replayed later without re-parsing.
+static void ED_ParseEdict(stringlit entities, size_t &entities_offset, entity &ent, dynarray<spawn_record> *records)
 {
 	bool init = false;
 	
@@ -220,14 +286,132 @@ static void ED_ParseEdict(stringlit entities, size_t &entities_offset, entity &e
 
 		string value = strtok(entities, entities_offset);
 		
-		if (!ED_ParseField(key, value, ent))
+		if (!ED_ParseField(key, value, ent, records))
 			gi.dprintf("%s: %s is not a field\n", __func__, key.ptr());
 	}
+
+	if (records)
+	{
+		spawn_record &end = records->emplace_back(spawn_record { SPAWN_RECORD_END });
+		end.value.integer = init;
+	}
 	
 	if (!init)
 		G_FreeEdict(ent);
 };
 
+// replay an entity recorded by ED_ParseEdict
+static void ED_ReplayEdict(const dynarray<spawn_record> &records, size_t &record_offset, entity &ent)
+{
+	for (; records[record_offset].field != SPAWN_RECORD_END; record_offset++)
+	{
+		const spawn_record &record = records[record_offset];
+		ED_ApplyField(spawn_fields[record.field], record.value, ent);
+	}
+
+	const bool init = records[record_offset++].value.integer;
+
+	if (!init)
+		G_FreeEdict(ent);
+}
+
+/*
+==============================================================================
+
+SPAWN CACHE
+
+Servers that cycle the same few maps re-parse the same entity lumps over
+and over. Each parsed lump is kept around as a flat list of spawn_records,
+keyed by map name and a hash of the lump, and replayed on the next visit.
+
+==============================================================================
+*/
+
+struct spawn_cache_entry
+{
+	string					mapname;
+	uint32_t				hash;
+	size_t					length;
+	dynarray<spawn_record>	records;
+	// how long the original parse took, in seconds
+	double					parse_time;
+	// level load this entry was last used on, for eviction
+	uint32_t				last_used;
+};
+
+struct spawn_cache_stats
+{
+	uint32_t	loads;
+	uint32_t	hits;
+	uint32_t	misses;
+	double		time_saved;
+};
+
+static dynarray<spawn_cache_entry> spawn_cache;
+static spawn_cache_stats spawn_cache_counters;
+
+// FNV-1a of the entity lump
+static uint32_t SpawnCache_Hash(stringlit entities, size_t &length)
+{
+	uint32_t hash = 2166136261u;
+	stringlit c = entities;
+
+	for (; *c; c++)
+		hash = (hash ^ (uint8_t)*c) * 16777619u;
+
+	length = c - entities;
+	return hash;
+}
+
+static spawn_cache_entry *SpawnCache_Find(stringlit mapname, const uint32_t &hash, const size_t &length)
+{
+	for (auto &entry : spawn_cache)
+		if (entry.hash == hash && entry.length == length && striequals(entry.mapname, mapname))
+			return &entry;
+
+	return nullptr;
+}
+
+static spawn_cache_entry &SpawnCache_Insert(stringlit mapname, const uint32_t &hash, const size_t &length)
+{
+	const size_t max_entries = (size_t)max(0, (int32_t)g_spawn_cache);
+
+	// evict the least recently used map
+	while (spawn_cache.size() && spawn_cache.size() >= max_entries)
+	{
+		auto oldest = spawn_cache.begin();
+
+		for (auto it = spawn_cache.begin(); it != spawn_cache.end(); it++)
+			if (it->last_used < oldest->last_used)
+				oldest = it;
+
+		spawn_cache.erase(oldest);
+	}
+
+	return spawn_cache.emplace_back(spawn_cache_entry { mapname, hash, length });
+}
+
+void SpawnCache_Clear()
+{
+	spawn_cache.clear();
+	spawn_cache.shrink_to_fit();
+}
+
+void SpawnCache_Stats()
+{
+	size_t records = 0;
+
+	for (auto &entry : spawn_cache)
+		records += entry.records.size();
+
+	gi.dprintf("spawn cache: %u maps, %u records (%u bytes)\n", (uint32_t)spawn_cache.size(), (uint32_t)records, (uint32_t)(records * sizeof(spawn_record)));
+	gi.dprintf("%u loads, %u hits, %u misses, %.2fms parse time saved\n", spawn_cache_counters.loads, spawn_cache_counters.hits,
+		spawn_cache_counters.misses, spawn_cache_counters.time_saved * 1000);
+
+	for (auto &entry : spawn_cache)
+		gi.dprintf("  %-16s %08x %6u records, %.2fms to parse\n", entry.mapname.ptr(), entry.hash, (uint32_t)entry.records.size(), entry.parse_time * 1000);
+}
+
 // these are only used by the spawn function
 #ifdef SINGLE_PLAYER
 constexpr spawn_flag SPAWNFLAG_NOT_EASY		= (spawn_flag)0x00000100;
@@ -242,6 +426,8 @@ constexpr spawn_flag SPAWNFLAG_NOT_MASK		= (spawn_flag)0x00001F00; // mask of al
 
 void PreSpawnEntities()
 {
+	Debris_Clear();
+
 #ifdef SINGLE_PLAYER
 	SaveClientData();
 #endif
@@ -457,24 +643,64 @@ void SpawnEntities(stringlit mapname, stringlit entities, stringlit spawnpoint)
 	
 	entityref ent = world;
 	size_t inhibit = 0;
+
+	// check if we've parsed this lump before
+	size_t entities_length;
+	const uint32_t entities_hash = SpawnCache_Hash(entities, entities_length);
+	spawn_cache_entry *cached = nullptr;
+	dynarray<spawn_record> recorded, *recording = nullptr;
+	size_t record_offset = 0;
+	double parse_time = 0;
+
+	spawn_cache_counters.loads++;
+
+	if ((int32_t)g_spawn_cache > 0)
+	{
+		cached = SpawnCache_Find(mapname, entities_hash, entities_length);
+
+		if (cached)
+			spawn_cache_counters.hits++;
+		else
+		{
+			spawn_cache_counters.misses++;
+			recording = &recorded;
+		}
+	}
+	else if (spawn_cache.size())
+		SpawnCache_Clear();
 	
 	// parse ents
 	while (1)
 	{
-		string token = strtok(entities, entities_offset);
+		const auto parse_start = std::chrono::steady_clock::now();
+
+		if (cached)
+		{
+			if (record_offset >= cached->records.size())
+				break;
+		}
+		else
+		{
+			string token = strtok(entities, entities_offset);
 		
-		if (entities_offset == -1)
-			break;
+			if (entities_offset == -1)
+				break;
 
-		if (token != "{")
-			gi.error("%s: found %s when expecting {", __func__, token.ptr());
+			if (token != "{")
+				gi.error("%s: found %s when expecting {", __func__, token.ptr());
+		}
 		
 		if (ent->inuse)
 			ent = G_Spawn();
 		else
 			G_InitEdict(ent);	
 		
-		ED_ParseEdict(entities, entities_offset, ent);
+		if (cached)
+			ED_ReplayEdict(cached->records, record_offset, ent);
+		else
+			ED_ParseEdict(entities, entities_offset, ent, recording);
+
+		parse_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - parse_start).count();
 
 #ifdef SINGLE_PLAYER
 		// yet another map hack
@@ -535,6 +761,24 @@ void SpawnEntities(stringlit mapname, stringlit entities, stringlit spawnpoint)
 	
 	ClearSpawnTemp();
 
+	if (cached)
+	{
+		const double saved = max(0.0, cached->parse_time - parse_time);
+		spawn_cache_counters.time_saved += saved;
+		cached->last_used = spawn_cache_counters.loads;
+
+		gi.dprintf("spawn cache hit for %s: replayed in %.2fms, %.2fms saved\n", mapname, parse_time * 1000, saved * 1000);
+	}
+	else if (recording)
+	{
+		// only store the lump once it has parsed successfully
+		spawn_cache_entry &entry = SpawnCache_Insert(mapname, entities_hash, entities_length);
+		recorded.shrink_to_fit();
+		entry.records = std::move(recorded);
+		entry.parse_time = parse_time;
+		entry.last_used = spawn_cache_counters.loads;
+	}
+
 	gi.dprintf("%i entities inhibited\n", inhibit);
 
 	G_FindTeams();
@@ -43,4 +43,10 @@ parsing textual entity definitions out of an ent file.
 void SpawnEntities(stringlit mapname, stringlit entities, stringlit spawnpoint);
 
 // Called before SpawnEntities, before entities are wiped.
-void PreSpawnEntities();
\ No newline at end of file
+void PreSpawnEntities();
+
+// Drop all cached entity lumps.
+void SpawnCache_Clear();
+
+// Print spawn cache usage and hit rates to the console.
+void SpawnCache_Stats();
\ No newline at end of file
@@ -1,4 +1,18 @@
 #include "../lib/types.h"
+#include "../lib/entity.h"
+#include "../lib/gi.h"
+#include "../lib/random.h"
+#include "../lib/vector_batch.h"
+#include "../lib/entity_mirror.h"
+#include "spawn.h"
+#include "itemlist.h"
+#include "misc.h"
+#include "cmds.h"
+#include "replay.h"
+#include "profile.h"
+#include "pmove.h"
+#include "ipfilter.h"
+#include "chase.h"
 #ifdef BOTS
 #include "ai/aicmds.h"
 #endif
@@ -9,4 +23,82 @@ void ServerCommand()
 	if (BOT_ServerCommand ())
 		return;
 #endif
+
+	string cmd = strlwr(gi.argv(1));
+
+	if (cmd == "spawncache")
+		SpawnCache_Stats();
+	else if (cmd == "debris")
+		Debris_Stats();
+	else if (cmd == "replay")
+	{
+		string sub = gi.argc() > 2 ? strlwr(gi.argv(2)) : "";
+
+		if (sub == "record" && gi.argc() > 3)
+			Replay_Record(gi.argv(3));
+		else if (sub == "stop")
+			Replay_Stop();
+		else
+			Replay_Status();
+	}
+	else if (cmd == "addip")
+		IPFilter_Add();
+	else if (cmd == "removeip")
+		IPFilter_Remove();
+	else if (cmd == "listip")
+		IPFilter_List();
+	else if (cmd == "writeip")
+		IPFilter_Write();
+	else if (cmd == "cmdlimit")
+	{
+		if (gi.argc() > 2 && striequals(gi.argv(2), "reset"))
+		{
+			Cmd_LimitReset();
+			gi.dprintf("cmdlimit: reset\n");
+		}
+		else
+			Cmd_LimitReport();
+	}
+	else if (cmd == "tracecache")
+	{
+		if (gi.argc() > 2 && striequals(gi.argv(2), "reset"))
+		{
+			TraceCache_Reset();
+			gi.dprintf("tracecache: reset\n");
+		}
+		else
+			TraceCache_Report();
+	}
+#ifdef CUSTOM_PMOVE
+	else if (cmd == "pmove")
+		Pmove_Command();
+#endif
+#ifdef PROFILE
+	else if (cmd == "profile")
+		Profile_Command();
+#endif
+#ifdef ENGINE_CALL_STATS
+	else if (cmd == "engcalls")
+	{
+		if (gi.argc() > 2 && striequals(gi.argv(2), "reset"))
+		{
+			EngineCalls_Reset();
+			gi.dprintf("engcalls: reset\n");
+		}
+		else
+			EngineCalls_Report(gi.argc() > 2 ? max(1, atoi(gi.argv(2))) : 20);
+	}
+#endif
+	else if (cmd == "benchrand")
+		BenchmarkRandom(gi.argc() > 2 ? max(1, atoi(gi.argv(2))) : 10000000);
+	else if (cmd == "benchvec")
+		BenchmarkVectorBatch(gi.argc() > 2 ? max(1, atoi(gi.argv(2))) : 100000);
+	else if (cmd == "chase")
+		ChaseBroadcast();
+	else if (cmd == "mirror")
+		Mirror_Check();
+	else if (cmd == "benchitems")
+		BenchmarkItemLookups(gi.argc() > 2 ? max(1, atoi(gi.argv(2))) : 2000);
+	else
+		gi.dprintf("Unknown server command \"%s\"\n", cmd.ptr());
 }
\ No newline at end of file
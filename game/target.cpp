@@ -1,6 +1,7 @@
 #include "../lib/types.h"
 #include "../lib/entity.h"
 #include "../lib/gi.h"
+#include "../lib/entity_mirror.h"
 #include "game.h"
 #include "combat.h"
 #include "util.h"
@@ -293,7 +294,7 @@ static void use_target_changelevel(entity &self, entity &other, entity &cactivat
 
 		// if multiplayer, let everyone know who hit the exit
 		if (cactivator.is_client())
-			gi.bprintf(PRINT_HIGH, "%s exited the level.\n", cactivator.client->g.pers.netname.ptr());
+			G_Broadcast(G_PrintMessage(PRINT_HIGH, "%s exited the level.\n", cactivator.client->g.pers.netname.ptr()));
 #ifdef SINGLE_PLAYER
 	}
 
@@ -785,11 +786,10 @@ static void target_earthquake_think(entity &self)
 
 	for (uint32_t i = 1; i < num_entities; i++)
 	{
-		entity &e = itoe(i);
-		if (!e.inuse)
-			continue;
-		if (!e.is_client())
+		if (!ent_mirror.has(i, MIRROR_INUSE | MIRROR_CLIENT))
 			continue;
+
+		entity &e = itoe(i);
 		if (!e.g.groundentity.has_value())
 			continue;
 
@@ -1,9 +1,12 @@
 #include "../lib/types.h"
 #include "../lib/entity.h"
 #include "../lib/gi.h"
+#include "../lib/entity_mirror.h"
 #include "game.h"
 #include "util.h"
 #include "combat.h"
+#include "cmds.h"
+#include <cstdarg>
 
 class bad_entity_operation : public std::exception
 {
@@ -21,6 +24,7 @@ void G_InitEdict(entity &e)
 
 	e.__init();
 	e.inuse = true;
+	Mirror_Update(e);
 	e.g.gravity = 1.0f;
 #ifdef GROUND_ZERO
 	e.g.gravityVector = MOVEDIR_DOWN;
@@ -76,16 +80,26 @@ entityref findradius(entityref from, vector org, float rad)
 	else
 		from = next_ent(from);
 
-	for (; etoi(from) < num_entities; from = next_ent(from))
+	// measure against the mirror's centers, then check the hit on the
+	// entity itself, since it may have changed without being relinked
+	for (size_t i = etoi(from); i < num_entities; i++)
 	{
-		if (!from->inuse)
+		i += VectorBatch_FindInRadius(ent_mirror.centers(i, num_entities), org, rad);
+
+		if (i >= num_entities)
+			break;
+
+		entity &e = itoe(i);
+
+		if (!e.inuse)
 			continue;
-		if (from->solid == SOLID_NOT)
+		if (e.solid == SOLID_NOT)
 			continue;
-		vector eorg = org - (from->s.origin + (from->mins + from->maxs) * 0.5f);
+		vector eorg = org - (e.s.origin + (e.mins + e.maxs) * 0.5f);
 		if (VectorLength(eorg) > rad)
 			continue;
-		return from;
+
+		return e;
 	}
 
 	return null_entity;
@@ -333,7 +347,7 @@ bool visible(const entity &self, const entity &other)
 	spot1.z += self.g.viewheight;
 	vector spot2 = other.s.origin;
 	spot2.z += other.g.viewheight;
-	trace tr = gi.traceline(spot1, spot2, self, MASK_OPAQUE);
+	trace tr = gi.traceline_cached(spot1, spot2, self, MASK_OPAQUE);
 	
 	if (tr.fraction == 1.0f || tr.ent == other)
 		return true;
@@ -349,3 +363,60 @@ bool infront(const entity &self, const entity &other)
 
 	return (vec * forward) > 0.3f;
 }
+
+string G_GamePath(stringlit name, stringlit extension)
+{
+	stringlit gamedir = gi.cvar("game", "", CVAR_SERVERINFO | CVAR_LATCH).string;
+
+	return va("%s/%s/%s.%s", gi.cvar("basedir", ".", CVAR_NOSET).string, *gamedir ? gamedir : "baseq2", name, extension);
+}
+
+client_message G_PrintMessage(print_level level, stringlit fmt, ...)
+{
+	va_list	argptr;
+	va_start(argptr, fmt);
+	client_message msg = { MESSAGE_PRINT, level, va(fmt, argptr) };
+	va_end(argptr);
+	return msg;
+}
+
+client_message G_CenterMessage(stringlit fmt, ...)
+{
+	va_list	argptr;
+	va_start(argptr, fmt);
+	client_message msg = { MESSAGE_CENTER, PRINT_HIGH, va(fmt, argptr) };
+	va_end(argptr);
+	return msg;
+}
+
+void G_SendMessage(const entity &ent, const client_message &msg)
+{
+	if (msg.type == MESSAGE_CENTER)
+		gi.centerprint(ent, msg.text.ptr());
+	else
+		gi.cprint(ent, msg.level, msg.text.ptr());
+}
+
+void G_Broadcast(const client_message &msg)
+{
+	// the engine has no centerprint broadcast
+	if (msg.type == MESSAGE_CENTER)
+		G_Broadcast(msg, [](entity &) { return true; });
+	else
+		gi.bprint(msg.level, msg.text.ptr());
+}
+
+bool team_filter::operator()(entity &other) const
+{
+	return OnSameTeam(ent, other);
+}
+
+bool spectator_filter::operator()(entity &other) const
+{
+	return other.client->g.pers.spectator;
+}
+
+bool pvs_filter::operator()(entity &other) const
+{
+	return gi.inPVS(origin, other.s.origin + other.client->ps.viewoffset);
+}
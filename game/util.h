@@ -2,6 +2,7 @@
 
 #include "../lib/types.h"
 #include "game.h"
+#include "../lib/format.h"
 
 constexpr vector MOVEDIR_UP		= { 0, 0, 1 };
 constexpr vector MOVEDIR_DOWN	= { 0, 0, -1 };
@@ -85,6 +86,9 @@ findradius
 Returns entities that have origins within a spherical area
 
 findradius (origin, radius)
+
+Entities are measured where they were last linked, from the
+entity mirror.
 =================
 */
 entityref findradius(entityref from, vector org, float rad);
@@ -121,6 +125,10 @@ void G_UseTargets(entity &ent, entity &cactivator);
 
 void G_SetMovedir(vector &angles, vector &movedir);
 
+// path to a file called name.extension in the game directory, for
+// things the game writes itself (replays, profiler traces)
+string G_GamePath(stringlit name, stringlit extension);
+
 void BecomeExplosion1(entity &self);
 
 void BecomeExplosion2(entity &self);
@@ -153,4 +161,87 @@ returns 1 if the entity is in front (in sight) of self
 */
 bool infront(const entity &self, const entity &other);
 
-void G_TouchTriggers(entity &ent);
\ No newline at end of file
+void G_TouchTriggers(entity &ent);
+
+/*
+=================
+broadcasting
+
+A client_message is formatted once and can then be sent to any number
+of clients without formatting it again. G_Broadcast sends one to every
+client a filter accepts, or with no filter, to everyone and the console
+through the engine's own broadcast.
+=================
+*/
+enum message_type : uint8_t
+{
+	MESSAGE_PRINT,
+	MESSAGE_CENTER
+};
+
+struct client_message
+{
+	message_type	type;
+	print_level		level;
+	string			text;
+};
+
+client_message G_PrintMessage(print_level level, stringlit fmt, ...);
+
+client_message G_CenterMessage(stringlit fmt, ...);
+
+void G_SendMessage(const entity &ent, const client_message &msg);
+
+void G_Broadcast(const client_message &msg);
+
+template<typename TFilter>
+void G_Broadcast(const client_message &msg, TFilter &&filter)
+{
+	for (uint32_t i = 1; i <= game.maxclients; i++)
+	{
+		entity &other = itoe(i);
+
+		if (other.inuse && filter(other))
+			G_SendMessage(other, msg);
+	}
+}
+
+// clients on ent's team
+struct team_filter
+{
+	entity	&ent;
+
+	bool operator()(entity &other) const;
+};
+
+// clients watching as spectators
+struct spectator_filter
+{
+	bool operator()(entity &other) const;
+};
+
+// clients whose view origin is in the PVS of origin
+struct pvs_filter
+{
+	vector	origin;
+
+	bool operator()(entity &other) const;
+};
+
+/*
+=================
+lazy printing
+
+These only evaluate and format their arguments if the message will be
+seen: G_DevPrint when developer is set, G_ClientPrint when the level
+is at or above the client's "msg" level, below which the engine would
+throw it away anyway. The format string is a strformat one.
+=================
+*/
+#define G_DevPrint(...) \
+	do { if ((bool)developer) gi.dprint(strformat(__VA_ARGS__).ptr()); } while (0)
+
+#define G_ClientPrint(ent, printlevel, ...) \
+	do { const entity &print_ent_ = (ent); \
+		if ((printlevel) >= print_ent_.client->g.pers.messagelevel) \
+			gi.cprint(print_ent_, (printlevel), strformat(__VA_ARGS__).ptr()); } while (0)
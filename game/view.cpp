@@ -7,6 +7,7 @@
 #include "itemlist.h"
 #include "hud.h"
 #include "m_player.h"
+#include "profile.h"
 
 constexpr float FALL_TIME	= 0.3f;
 
@@ -138,7 +139,7 @@ static inline void P_WorldEffects(entity &current_player)
 				// play a gurp sound instead of a normal pain sound
 				if (current_player.g.health <= current_player.g.dmg)
 					gi.sound(current_player, CHAN_VOICE, gi.soundindex("player/drown1.wav"), 1, ATTN_NORM, 0);
-				else if (Q_rand() & 1)
+				else if (rng_effects() & 1)
 					gi.sound(current_player, CHAN_VOICE, gi.soundindex("*gurp1.wav"), 1, ATTN_NORM, 0);
 				else
 					gi.sound(current_player, CHAN_VOICE, gi.soundindex("*gurp2.wav"), 1, ATTN_NORM, 0);
@@ -166,7 +167,7 @@ static inline void P_WorldEffects(entity &current_player)
 				&& current_player.g.pain_debounce_framenum <= level.framenum
 				&& current_player.client->g.invincible_framenum < level.framenum)
 			{
-				if (Q_rand() & 1)
+				if (rng_effects() & 1)
 					gi.sound(current_player, CHAN_VOICE, gi.soundindex("player/burn1.wav"), 1, ATTN_NORM, 0);
 				else
 					gi.sound(current_player, CHAN_VOICE, gi.soundindex("player/burn2.wav"), 1, ATTN_NORM, 0);
@@ -352,7 +353,7 @@ static void P_DamageFeedback(entity &player)
 	// play an apropriate pain sound
 	if ((level.framenum > player.g.pain_debounce_framenum) && !(player.g.flags & FL_GODMODE) && (player.client->g.invincible_framenum <= level.framenum))
 	{
-		r = 1 + (Q_rand() & 1);
+		r = 1 + (rng_effects() & 1);
 		player.g.pain_debounce_framenum = (int)(level.framenum + 0.7f * BASE_FRAMERATE);
 		if (player.g.health < 25)
 			l = 25;
@@ -1003,6 +1004,8 @@ and right after spawning
 */
 void ClientEndServerFrame(entity &ent)
 {
+	PROFILE_ZONE("ClientEndServerFrame");
+
 	float   bobtime;
 
 	//
@@ -0,0 +1,2024 @@
+/*
+==============
+bench
+
+A headless host for the game module. It loads the game library, implements
+game_import_impl against a BSP-free world made of boxes, generates an entity
+lump for the scenario, connects scripted clients and drives RunFrame for a
+fixed number of frames, reporting frame time percentiles, time spent inside
+engine imports and game allocations.
+
+This does not include anything from the game; like a real engine it only knows
+the shared part of the ABI, mirrored here. If game_import_impl in lib/gi.cpp,
+game_export in main.cpp or the shared head of entity in lib/entity.h change,
+these have to change with them.
+
+With --replay it plays back a log recorded with "sv replay record" instead
+of running a scenario, timing every recorded frame; --record makes one from
+a scenario run. Logs of bench scenarios replay in the same box world; logs
+from real maps replay in the deathmatch arena, with their inline models
+reduced to points.
+
+The game's own profiler zones are reported too when it's built with PROFILE.
+On Linux, host/CMakeLists.txt builds it: cmake -S host -B build/bench
+
+usage: bench <game library> [scenario] [frames] [--budget <p99 ms>] [--record <name>] [--set <cvar> <value>]... [--verbose]
+       bench <game library> --replay <file> [--budget <p99 ms>] [--set <cvar> <value>]... [--verbose]
+scenarios: deathmatch, bots32, bots64, rockets, triggers
+
+--set <cvar> <value> sets a cvar before the game starts, so the same build can
+be compared with a feature on and off, e.g. --set bot_vis_matrix 0.
+==============
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <memory>
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+using qboolean = int32_t;
+using bench_clock = std::chrono::steady_clock;
+
+/*
+==============
+shared ABI
+==============
+*/
+struct vec3
+{
+	float x, y, z;
+
+	vec3 operator+(const vec3 &r) const { return { x + r.x, y + r.y, z + r.z }; }
+	vec3 operator-(const vec3 &r) const { return { x - r.x, y - r.y, z - r.z }; }
+	vec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+	float operator[](int i) const { return (&x)[i]; }
+	float &operator[](int i) { return (&x)[i]; }
+};
+
+static inline float dot(const vec3 &a, const vec3 &b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline vec3 load(const float *v)
+{
+	return v ? vec3 { v[0], v[1], v[2] } : vec3 { 0, 0, 0 };
+}
+
+struct entity_state
+{
+	uint32_t	number;
+	vec3		origin, angles, old_origin;
+	int32_t		modelindex, modelindex2, modelindex3, modelindex4;
+	int32_t		frame, skinnum;
+	uint32_t	effects, renderfx;
+	int32_t		solid;
+	int32_t		sound;
+	uint32_t	event;
+};
+
+struct area_link
+{
+	area_link	*next, *prev;
+};
+
+enum : int32_t
+{
+	SOLID_NOT,
+	SOLID_TRIGGER,
+	SOLID_BBOX,
+	SOLID_BSP
+};
+
+enum : uint32_t
+{
+	SVF_NOCLIENT		= 1 << 0,
+	SVF_DEADMONSTER		= 1 << 1,
+	SVF_MONSTER			= 1 << 2
+};
+
+enum : int32_t
+{
+	CONTENTS_SOLID			= 1 << 0,
+	CONTENTS_MONSTER		= 1 << 25,
+	CONTENTS_DEADMONSTER	= 1 << 26
+};
+
+enum : int32_t
+{
+	AREA_SOLID		= 1,
+	AREA_TRIGGERS	= 2
+};
+
+// the part of entity the engine is allowed to see
+struct edict
+{
+	entity_state	s;
+	void			*client;
+	qboolean		inuse;
+	int32_t			linkcount;
+	area_link		area;
+	int32_t			num_clusters;
+	int32_t			clusternums[16];
+	int32_t			headnode;
+	int32_t			areanum, areanum2;
+	uint32_t		svflags;
+	vec3			mins, maxs;
+	vec3			absmin, absmax, size;
+	int32_t			solid;
+	int32_t			clipmask;
+	edict			*owner;
+};
+
+struct csurface
+{
+	char	name[16];
+	int32_t	flags;
+	int32_t	value;
+};
+
+struct trace_result
+{
+	qboolean		allsolid;
+	qboolean		startsolid;
+	float			fraction;
+	vec3			endpos;
+	vec3			normal;
+	int32_t			plane_padding[2];
+	const csurface	*surface;
+	int32_t			contents;
+	edict			*ent;
+};
+
+struct usercmd
+{
+	uint8_t		msec;
+	uint8_t		buttons;
+	int16_t		angles[3];
+	int16_t		forwardmove, sidemove, upmove;
+	uint8_t		impulse;
+	uint8_t		lightlevel;
+};
+
+struct pmove_state
+{
+	int32_t		pm_type;
+	int16_t		origin[3];
+	int16_t		velocity[3];
+	uint8_t		pm_flags;
+	uint8_t		pm_time;
+	int16_t		gravity;
+	int16_t		delta_angles[3];
+};
+
+enum : int32_t
+{
+	PM_NORMAL,
+	PM_SPECTATOR,
+	PM_DEAD,
+	PM_GIB,
+	PM_FREEZE
+};
+
+enum : uint8_t
+{
+	PMF_DUCKED		= 1 << 0,
+	PMF_JUMP_HELD	= 1 << 1,
+	PMF_ON_GROUND	= 1 << 2
+};
+
+constexpr size_t MAX_TOUCH = 32;
+
+struct pmove
+{
+	pmove_state	s;
+	usercmd		cmd;
+	qboolean	snapinitial;
+
+	int32_t		numtouch;
+	edict		*touchents[MAX_TOUCH];
+
+	vec3		viewangles;
+	float		viewheight;
+
+	vec3		mins, maxs;
+
+	edict		*groundentity;
+	int32_t		watertype;
+	int32_t		waterlevel;
+
+	trace_result	(*trace)(const float *start, const float *mins, const float *maxs, const float *end);
+	int32_t			(*pointcontents)(const float *point);
+};
+
+struct cvar
+{
+	char		*name;
+	char		*string;
+	char		*latched_string;
+	int32_t		flags;
+	qboolean	modified;
+	float		value;
+	cvar		*next;
+};
+
+struct game_import_impl
+{
+	void (*bprintf)(int32_t printlevel, const char *fmt, ...);
+	void (*dprintf)(const char *fmt, ...);
+	void (*cprintf)(edict *ent, int32_t printlevel, const char *fmt, ...);
+	void (*centerprintf)(edict *ent, const char *fmt, ...);
+	void (*sound)(edict *ent, int32_t channel, int soundindex, float volume, float attenuation, float timeofs);
+	void (*positioned_sound)(const float *origin, edict *ent, int32_t channel, int32_t soundindex, float volume, float attenuation, float timeofs);
+	void (*configstring)(int32_t num, const char *string);
+	void (*error)(const char *fmt, ...);
+	int (*modelindex)(const char *name);
+	int (*soundindex)(const char *name);
+	int (*imageindex)(const char *name);
+	void (*setmodel)(edict *ent, const char *name);
+	trace_result (*trace)(const float *start, const float *mins, const float *maxs, const float *end, edict *passent, int32_t contentmask);
+	int32_t (*pointcontents)(const float *point);
+	qboolean (*inPVS)(const float *p1, const float *p2);
+	qboolean (*inPHS)(const float *p1, const float *p2);
+	void (*SetAreaPortalState)(int portalnum, qboolean open);
+	qboolean (*AreasConnected)(int area1, int area2);
+	void (*linkentity)(edict *ent);
+	void (*unlinkentity)(edict *ent);
+	int (*BoxEdicts)(const float *mins, const float *maxs, edict **list, int maxcount, int32_t areatype);
+	void (*Pmove)(pmove *pm);
+	void (*multicast)(const float *origin, int32_t to);
+	void (*unicast)(edict *ent, qboolean reliable);
+	void (*WriteChar)(int c);
+	void (*WriteByte)(int c);
+	void (*WriteShort)(int c);
+	void (*WriteLong)(int c);
+	void (*WriteFloat)(float f);
+	void (*WriteString)(const char *s);
+	void (*WritePosition)(const float *pos);
+	void (*WriteDir)(const float *pos);
+	void (*WriteAngle)(float f);
+	void *(*TagMalloc)(uint32_t size, uint32_t tag);
+	void (*TagFree)(void *block);
+	void (*FreeTags)(uint32_t tag);
+	::cvar *(*cvar)(const char *var_name, const char *value, int32_t flags);
+	::cvar *(*cvar_set)(const char *var_name, const char *value);
+	::cvar *(*cvar_forceset)(const char *var_name, const char *value);
+	int (*argc)(void);
+	char *(*argv)(int n);
+	char *(*args)(void);
+	void (*AddCommandString)(const char *text);
+	void (*DebugGraph)(float value, int color);
+};
+
+struct game_export
+{
+	int32_t	apiversion;
+
+	void (*Init)();
+	void (*Shutdown)();
+	void (*SpawnEntities)(const char *mapname, const char *entstring, const char *spawnpoint);
+	void (*WriteGame)(const char *filename, qboolean autosave);
+	void (*ReadGame)(const char *filename);
+	void (*WriteLevel)(const char *filename);
+	void (*ReadLevel)(const char *filename);
+	qboolean (*ClientConnect)(edict *ent, char *userinfo);
+	void (*ClientBegin)(edict *ent);
+	void (*ClientUserinfoChanged)(edict *ent, char *userinfo);
+	void (*ClientDisconnect)(edict *ent);
+	void (*ClientCommand)(edict *ent);
+	void (*ClientThink)(edict *ent, usercmd *cmd);
+	void (*RunFrame)();
+	void (*ServerCommand)();
+
+	uint8_t		*edicts;
+	uint32_t	edict_size;
+	uint32_t	num_edicts;
+	uint32_t	max_edicts;
+};
+
+using GetGameAPI_func = game_export *(*)(game_import_impl *impl);
+
+constexpr int32_t GAME_API_VERSION = 3;
+constexpr size_t MAX_INFO_STRING = 512;
+constexpr size_t MAX_CONFIGSTRINGS = 2080;
+constexpr float DIST_EPSILON = 0.03125f;
+
+/*
+==============
+host state
+==============
+*/
+static game_export *ge;
+static bool verbose;
+// print the game's output even when not verbose
+static bool echo;
+// playing back a log rather than a scenario
+static bool replaying;
+
+static inline edict &EDICT_NUM(size_t n)
+{
+	return *(edict *)(ge->edicts + ge->edict_size * n);
+}
+
+static inline size_t NUM_FOR_EDICT(const edict *e)
+{
+	return ((const uint8_t *)e - ge->edicts) / ge->edict_size;
+}
+
+// time spent inside each import, so the game's own cost
+// can be told apart from what a real engine would charge
+enum import_zone
+{
+	ZONE_TRACE,
+	ZONE_POINTCONTENTS,
+	ZONE_LINKENTITY,
+	ZONE_BOXEDICTS,
+	ZONE_PMOVE,
+	ZONE_MESSAGES,
+	ZONE_MEMORY,
+	ZONE_TOTAL
+};
+
+static constexpr const char *zone_names[ZONE_TOTAL] = {
+	"trace", "pointcontents", "linkentity", "BoxEdicts", "Pmove", "messages", "memory"
+};
+
+static struct
+{
+	uint64_t	calls[ZONE_TOTAL];
+	uint64_t	ns[ZONE_TOTAL];
+} imports;
+
+struct import_timer
+{
+	import_zone			zone;
+	bench_clock::time_point	start = bench_clock::now();
+
+	import_timer(import_zone zone) : zone(zone) { }
+
+	~import_timer()
+	{
+		imports.calls[zone]++;
+		imports.ns[zone] += std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count();
+	}
+};
+
+/*
+==============
+printing
+==============
+*/
+static void Host_Print(const char *prefix, const char *fmt, va_list args)
+{
+	if (!verbose && !echo)
+		return;
+
+	char buffer[2048];
+	vsnprintf(buffer, sizeof(buffer), fmt, args);
+	printf("%s%s", prefix, buffer);
+}
+
+static void PF_bprintf(int32_t, const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	Host_Print("[b] ", fmt, args);
+	va_end(args);
+}
+
+static void PF_dprintf(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	Host_Print("", fmt, args);
+	va_end(args);
+}
+
+static void PF_cprintf(edict *, int32_t, const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	Host_Print("[c] ", fmt, args);
+	va_end(args);
+}
+
+static void PF_centerprintf(edict *, const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	Host_Print("[cp] ", fmt, args);
+	va_end(args);
+}
+
+[[noreturn]] static void PF_error(const char *fmt, ...)
+{
+	char buffer[2048];
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(buffer, sizeof(buffer), fmt, args);
+	va_end(args);
+
+	fprintf(stderr, "game error: %s\n", buffer);
+	exit(2);
+}
+
+static void PF_sound(edict *, int32_t, int, float, float, float) { }
+static void PF_positioned_sound(const float *, edict *, int32_t, int32_t, float, float, float) { }
+
+/*
+==============
+config strings and indexes
+==============
+*/
+static std::array<std::string, MAX_CONFIGSTRINGS> configstrings;
+static std::unordered_map<std::string, int> model_indexes, sound_indexes, image_indexes;
+
+static void PF_configstring(int32_t num, const char *string)
+{
+	if (num < 0 || (size_t)num >= MAX_CONFIGSTRINGS)
+		PF_error("configstring: bad index %i", num);
+
+	configstrings[num] = string ? string : "";
+}
+
+static int Host_FindIndex(std::unordered_map<std::string, int> &indexes, const char *name)
+{
+	if (!name || !*name)
+		return 0;
+
+	auto it = indexes.find(name);
+
+	if (it != indexes.end())
+		return it->second;
+
+	// model 1 is always the world
+	const int index = (int)indexes.size() + 1 + (&indexes == &model_indexes);
+
+	if (index >= 256)
+		PF_error("index overflow for %s", name);
+
+	indexes.emplace(name, index);
+	return index;
+}
+
+static int PF_modelindex(const char *name) { return Host_FindIndex(model_indexes, name); }
+static int PF_soundindex(const char *name) { return Host_FindIndex(sound_indexes, name); }
+static int PF_imageindex(const char *name) { return Host_FindIndex(image_indexes, name); }
+
+/*
+==============
+world
+
+The world is a list of solid boxes; inline models "*n" are boxes too,
+and are only solid through the entities that use them.
+==============
+*/
+struct box
+{
+	vec3	mins, maxs;
+};
+
+static std::vector<box> world_boxes;
+static std::vector<box> inline_models;
+static area_link area_head;
+static csurface null_surface;
+
+static void PF_setmodel(edict *ent, const char *name);
+static void PF_linkentity(edict *ent);
+
+static void PF_setmodel(edict *ent, const char *name)
+{
+	if (!name)
+		PF_error("setmodel: null name");
+
+	ent->s.modelindex = PF_modelindex(name);
+
+	if (name[0] == '*')
+	{
+		const size_t n = (size_t)atoi(name + 1);
+
+		if (n && n <= inline_models.size())
+		{
+			ent->mins = inline_models[n - 1].mins;
+			ent->maxs = inline_models[n - 1].maxs;
+		}
+		// replays of real maps use models the box world doesn't have
+		else if (replaying)
+			ent->mins = ent->maxs = { 0, 0, 0 };
+		else
+			PF_error("setmodel: bad inline model %s", name);
+
+		PF_linkentity(ent);
+	}
+}
+
+static void PF_unlinkentity(edict *ent)
+{
+	if (!ent->area.prev)
+		return;
+
+	ent->area.prev->next = ent->area.next;
+	ent->area.next->prev = ent->area.prev;
+	ent->area.next = ent->area.prev = nullptr;
+}
+
+static void PF_linkentity(edict *ent)
+{
+	import_timer timer(ZONE_LINKENTITY);
+
+	if (ent->area.prev)
+		PF_unlinkentity(ent);
+
+	if (ent == &EDICT_NUM(0))
+		return;
+	if (!ent->inuse)
+		return;
+
+	ent->size = ent->maxs - ent->mins;
+	ent->absmin = ent->s.origin + ent->mins - vec3 { 1, 1, 1 };
+	ent->absmax = ent->s.origin + ent->maxs + vec3 { 1, 1, 1 };
+	ent->linkcount++;
+	ent->areanum = 1;
+	ent->areanum2 = 0;
+	ent->num_clusters = 0;
+
+	if (ent->solid == SOLID_NOT)
+		return;
+
+	ent->area.next = area_head.next;
+	ent->area.prev = &area_head;
+	area_head.next->prev = &ent->area;
+	area_head.next = &ent->area;
+}
+
+static inline edict *EDICT_FROM_AREA(area_link *l)
+{
+	return (edict *)((uint8_t *)l - offsetof(edict, area));
+}
+
+static inline bool Box_Overlaps(const vec3 &amins, const vec3 &amaxs, const vec3 &bmins, const vec3 &bmaxs)
+{
+	return amins.x <= bmaxs.x && amaxs.x >= bmins.x &&
+		amins.y <= bmaxs.y && amaxs.y >= bmins.y &&
+		amins.z <= bmaxs.z && amaxs.z >= bmins.z;
+}
+
+static int PF_BoxEdicts(const float *mins, const float *maxs, edict **list, int maxcount, int32_t areatype)
+{
+	import_timer timer(ZONE_BOXEDICTS);
+	const vec3 bmins = load(mins), bmaxs = load(maxs);
+	int count = 0;
+
+	for (area_link *l = area_head.next; l != &area_head; l = l->next)
+	{
+		edict *e = EDICT_FROM_AREA(l);
+
+		if ((areatype == AREA_TRIGGERS) != (e->solid == SOLID_TRIGGER))
+			continue;
+		if (!Box_Overlaps(e->absmin, e->absmax, bmins, bmaxs))
+			continue;
+		if (count == maxcount)
+			break;
+
+		list[count++] = e;
+	}
+
+	return count;
+}
+
+// sweep the box [mins, maxs] from start to end against the solid box
+// [bmins, bmaxs]; shortens tr if it hits earlier than what tr has
+static bool Trace_Box(trace_result &tr, const vec3 &start, const vec3 &end, const vec3 &mins, const vec3 &maxs, const vec3 &bmins, const vec3 &bmaxs)
+{
+	const vec3 lo = bmins - maxs, hi = bmaxs - mins;
+	const vec3 delta = end - start;
+	float enter = -1, leave = 1;
+	int axis = -1;
+	bool inside = true;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (start[i] <= lo[i] || start[i] >= hi[i])
+			inside = false;
+
+		if (delta[i] == 0)
+		{
+			if (start[i] < lo[i] || start[i] > hi[i])
+				return false;
+
+			continue;
+		}
+
+		float t0 = (lo[i] - start[i]) / delta[i];
+		float t1 = (hi[i] - start[i]) / delta[i];
+
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		if (t0 > enter)
+		{
+			enter = t0;
+			axis = i;
+		}
+
+		leave = std::min(leave, t1);
+
+		if (enter > leave)
+			return false;
+	}
+
+	if (inside)
+	{
+		tr.startsolid = true;
+
+		if (end.x > lo.x && end.x < hi.x && end.y > lo.y && end.y < hi.y && end.z > lo.z && end.z < hi.z)
+		{
+			tr.allsolid = true;
+			tr.fraction = 0;
+		}
+
+		return true;
+	}
+
+	if (axis == -1 || enter < 0 || enter >= tr.fraction)
+		return false;
+
+	const float len = std::sqrt(dot(delta, delta));
+	tr.fraction = std::max(0.f, enter - (len > 0 ? DIST_EPSILON / len : 0));
+	tr.normal = { 0, 0, 0 };
+	tr.normal[axis] = delta[axis] > 0 ? -1.f : 1.f;
+	return true;
+}
+
+static trace_result PF_trace(const float *pstart, const float *pmins, const float *pmaxs, const float *pend, edict *passent, int32_t contentmask)
+{
+	import_timer timer(ZONE_TRACE);
+	const vec3 start = load(pstart), end = load(pend), mins = load(pmins), maxs = load(pmaxs);
+	trace_result tr {};
+
+	tr.fraction = 1;
+	tr.surface = &null_surface;
+	tr.ent = &EDICT_NUM(0);
+
+	if (contentmask & CONTENTS_SOLID)
+		for (auto &b : world_boxes)
+			if (Trace_Box(tr, start, end, mins, maxs, b.mins, b.maxs))
+			{
+				tr.contents = CONTENTS_SOLID;
+				tr.ent = &EDICT_NUM(0);
+			}
+
+	if (!tr.allsolid)
+	{
+		for (area_link *l = area_head.next; l != &area_head; l = l->next)
+		{
+			edict *e = EDICT_FROM_AREA(l);
+
+			if (e->solid == SOLID_TRIGGER || e == passent)
+				continue;
+			if (passent && (e->owner == passent || passent->owner == e))
+				continue;
+			if (!(contentmask & CONTENTS_DEADMONSTER) && (e->svflags & SVF_DEADMONSTER))
+				continue;
+
+			const int32_t contents = e->solid == SOLID_BSP ? CONTENTS_SOLID : CONTENTS_MONSTER;
+
+			if (!(contentmask & contents))
+				continue;
+
+			if (Trace_Box(tr, start, end, mins, maxs, e->s.origin + e->mins, e->s.origin + e->maxs))
+			{
+				tr.contents = contents;
+				tr.ent = e;
+			}
+		}
+	}
+
+	tr.endpos = start + (end - start) * tr.fraction;
+	return tr;
+}
+
+static int32_t PF_pointcontents(const float *ppoint)
+{
+	import_timer timer(ZONE_POINTCONTENTS);
+	const vec3 point = load(ppoint);
+
+	for (auto &b : world_boxes)
+		if (Box_Overlaps(point, point, b.mins, b.maxs))
+			return CONTENTS_SOLID;
+
+	return 0;
+}
+
+static qboolean PF_inPVS(const float *, const float *) { return true; }
+static qboolean PF_inPHS(const float *, const float *) { return true; }
+static void PF_SetAreaPortalState(int, qboolean) { }
+static qboolean PF_AreasConnected(int, int) { return true; }
+
+/*
+==============
+player movement
+
+This is not the engine's pmove; it's a cheap kinematic mover with the same
+inputs and outputs, so clients walk, fall, jump and touch things without
+pulling in the shared movement code.
+==============
+*/
+static void PF_Pmove(pmove *pm)
+{
+	import_timer timer(ZONE_PMOVE);
+	const float dt = pm->cmd.msec * 0.001f;
+	vec3 origin { pm->s.origin[0] * 0.125f, pm->s.origin[1] * 0.125f, pm->s.origin[2] * 0.125f };
+	vec3 velocity { pm->s.velocity[0] * 0.125f, pm->s.velocity[1] * 0.125f, pm->s.velocity[2] * 0.125f };
+
+	for (int i = 0; i < 3; i++)
+		pm->viewangles[i] = (pm->cmd.angles[i] + pm->s.delta_angles[i]) * (360.f / 65536);
+
+	pm->mins = { -16, -16, -24 };
+	pm->maxs = { 16, 16, pm->s.pm_type >= PM_DEAD ? -8.f : 32.f };
+	pm->viewheight = pm->s.pm_type >= PM_DEAD ? -8.f : 22.f;
+	pm->numtouch = 0;
+	pm->groundentity = nullptr;
+	pm->watertype = 0;
+	pm->waterlevel = 0;
+
+	if (pm->s.pm_type == PM_FREEZE)
+		return;
+
+	const float yaw = pm->viewangles.y * (3.14159265f / 180);
+	const vec3 forward { std::cos(yaw), std::sin(yaw), 0 };
+	const vec3 right { std::sin(yaw), -std::cos(yaw), 0 };
+
+	if (pm->s.pm_type == PM_SPECTATOR)
+	{
+		origin = origin + (forward * pm->cmd.forwardmove + right * pm->cmd.sidemove) * dt;
+		velocity = { 0, 0, 0 };
+	}
+	else
+	{
+		const vec3 down = origin - vec3 { 0, 0, 0.25f };
+		trace_result ground = pm->trace(&origin.x, &pm->mins.x, &pm->maxs.x, &down.x);
+		bool on_ground = ground.fraction < 1 && ground.normal.z > 0.7f && velocity.z <= 180;
+
+		if (on_ground)
+			pm->groundentity = ground.ent;
+
+		if (pm->s.pm_type == PM_NORMAL)
+		{
+			vec3 wish = forward * pm->cmd.forwardmove + right * pm->cmd.sidemove;
+			const float speed = std::sqrt(dot(wish, wish));
+
+			if (speed > 300)
+				wish = wish * (300 / speed);
+
+			velocity.x = wish.x;
+			velocity.y = wish.y;
+
+			if (pm->cmd.upmove >= 10 && on_ground && !(pm->s.pm_flags & PMF_JUMP_HELD))
+			{
+				velocity.z = 270;
+				on_ground = false;
+				pm->groundentity = nullptr;
+				pm->s.pm_flags |= PMF_JUMP_HELD;
+			}
+			else if (pm->cmd.upmove < 10)
+				pm->s.pm_flags &= ~PMF_JUMP_HELD;
+		}
+
+		if (on_ground)
+		{
+			velocity.z = 0;
+			pm->s.pm_flags |= PMF_ON_GROUND;
+		}
+		else
+		{
+			velocity.z -= pm->s.gravity * dt;
+			pm->s.pm_flags &= ~PMF_ON_GROUND;
+		}
+
+		float remaining = dt;
+
+		for (int bump = 0; bump < 4 && remaining > 0; bump++)
+		{
+			const vec3 end = origin + velocity * remaining;
+			trace_result tr = pm->trace(&origin.x, &pm->mins.x, &pm->maxs.x, &end.x);
+
+			if (tr.allsolid)
+			{
+				velocity.z = 0;
+				break;
+			}
+
+			origin = tr.endpos;
+
+			if (tr.fraction == 1)
+				break;
+
+			if (pm->numtouch < (int32_t)MAX_TOUCH && tr.ent)
+				pm->touchents[pm->numtouch++] = tr.ent;
+
+			remaining -= remaining * tr.fraction;
+			velocity = velocity - tr.normal * (dot(velocity, tr.normal) * 1.01f);
+		}
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		pm->s.origin[i] = (int16_t)std::lround(origin[i] * 8);
+		pm->s.velocity[i] = (int16_t)std::lround(velocity[i] * 8);
+	}
+}
+
+/*
+==============
+messages
+
+Nothing is sent anywhere; the bytes are only counted.
+==============
+*/
+static struct
+{
+	uint64_t	pending;
+	uint64_t	messages, bytes;
+} net;
+
+static void Net_Write(size_t bytes)
+{
+	import_timer timer(ZONE_MESSAGES);
+	net.pending += bytes;
+}
+
+static void PF_WriteChar(int) { Net_Write(1); }
+static void PF_WriteByte(int) { Net_Write(1); }
+static void PF_WriteShort(int) { Net_Write(2); }
+static void PF_WriteLong(int) { Net_Write(4); }
+static void PF_WriteFloat(float) { Net_Write(4); }
+static void PF_WriteString(const char *s) { Net_Write(s ? strlen(s) + 1 : 1); }
+static void PF_WritePosition(const float *) { Net_Write(6); }
+static void PF_WriteDir(const float *) { Net_Write(1); }
+static void PF_WriteAngle(float) { Net_Write(1); }
+
+static void Net_Send()
+{
+	net.messages++;
+	net.bytes += net.pending;
+	net.pending = 0;
+}
+
+static void PF_multicast(const float *, int32_t) { Net_Send(); }
+static void PF_unicast(edict *, qboolean) { Net_Send(); }
+
+/*
+==============
+memory
+==============
+*/
+struct alignas(16) memory_block
+{
+	memory_block	*prev, *next;
+	uint32_t		size;
+	uint32_t		tag;
+};
+
+static memory_block memory_head = { &memory_head, &memory_head, 0, 0 };
+
+static struct
+{
+	uint64_t	allocs, frees;
+	uint64_t	live, peak;
+} memory;
+
+static void *PF_TagMalloc(uint32_t size, uint32_t tag)
+{
+	import_timer timer(ZONE_MEMORY);
+	memory_block *block = (memory_block *)calloc(1, sizeof(memory_block) + size);
+
+	if (!block)
+		PF_error("TagMalloc: failed on allocation of %u bytes", size);
+
+	block->size = size;
+	block->tag = tag;
+	block->next = memory_head.next;
+	block->prev = &memory_head;
+	memory_head.next->prev = block;
+	memory_head.next = block;
+
+	memory.allocs++;
+	memory.live += size;
+	memory.peak = std::max(memory.peak, memory.live);
+
+	return block + 1;
+}
+
+static void PF_TagFree(void *ptr)
+{
+	import_timer timer(ZONE_MEMORY);
+
+	if (!ptr)
+		return;
+
+	memory_block *block = (memory_block *)ptr - 1;
+	block->prev->next = block->next;
+	block->next->prev = block->prev;
+
+	memory.frees++;
+	memory.live -= block->size;
+
+	free(block);
+}
+
+static void PF_FreeTags(uint32_t tag)
+{
+	for (memory_block *block = memory_head.next, *next; block != &memory_head; block = next)
+	{
+		next = block->next;
+
+		if (block->tag == tag)
+			PF_TagFree(block + 1);
+	}
+}
+
+/*
+==============
+cvars
+==============
+*/
+static std::unordered_map<std::string, std::unique_ptr<cvar>> cvars;
+static cvar *cvar_vars;
+
+static char *CopyString(const char *s)
+{
+	const size_t len = strlen(s) + 1;
+	char *copy = (char *)malloc(len);
+	memcpy(copy, s, len);
+	return copy;
+}
+
+static cvar *Cvar_Set(const char *name, const char *value)
+{
+	auto it = cvars.find(name);
+
+	if (it == cvars.end())
+		return nullptr;
+
+	cvar *var = it->second.get();
+
+	if (strcmp(var->string, value))
+	{
+		free(var->string);
+		var->string = CopyString(value);
+		var->value = (float)atof(value);
+		var->modified = true;
+	}
+
+	return var;
+}
+
+static cvar *PF_cvar(const char *name, const char *value, int32_t flags)
+{
+	auto it = cvars.find(name);
+
+	if (it != cvars.end())
+	{
+		it->second->flags |= flags;
+		return it->second.get();
+	}
+
+	if (!value)
+		return nullptr;
+
+	auto var = std::make_unique<cvar>();
+	var->name = CopyString(name);
+	var->string = CopyString(value);
+	var->latched_string = nullptr;
+	var->flags = flags;
+	var->modified = true;
+	var->value = (float)atof(value);
+	var->next = cvar_vars;
+	cvar_vars = var.get();
+
+	return cvars.emplace(name, std::move(var)).first->second.get();
+}
+
+static cvar *PF_cvar_set(const char *name, const char *value)
+{
+	cvar *var = Cvar_Set(name, value);
+	return var ? var : PF_cvar(name, value, 0);
+}
+
+static cvar *PF_cvar_forceset(const char *name, const char *value)
+{
+	return PF_cvar_set(name, value);
+}
+
+/*
+==============
+commands
+==============
+*/
+static std::vector<std::string> cmd_argv;
+static std::string cmd_args;
+static std::string empty_arg;
+
+static void Cmd_Set(const std::vector<std::string> &argv)
+{
+	cmd_argv = argv;
+	cmd_args.clear();
+
+	for (size_t i = 1; i < argv.size(); i++)
+	{
+		if (i > 1)
+			cmd_args += ' ';
+		cmd_args += argv[i];
+	}
+}
+
+static int PF_argc() { return (int)cmd_argv.size(); }
+static char *PF_argv(int n) { return (n >= 0 && (size_t)n < cmd_argv.size()) ? cmd_argv[n].data() : empty_arg.data(); }
+static char *PF_args() { return cmd_args.data(); }
+
+static void PF_AddCommandString(const char *text)
+{
+	if (verbose)
+		printf("[cmd] %s\n", text);
+}
+
+static void PF_DebugGraph(float, int) { }
+
+static game_import_impl host_imports = {
+	PF_bprintf, PF_dprintf, PF_cprintf, PF_centerprintf, PF_sound, PF_positioned_sound,
+	PF_configstring, PF_error, PF_modelindex, PF_soundindex, PF_imageindex, PF_setmodel,
+	PF_trace, PF_pointcontents, PF_inPVS, PF_inPHS, PF_SetAreaPortalState, PF_AreasConnected,
+	PF_linkentity, PF_unlinkentity, PF_BoxEdicts, PF_Pmove,
+	PF_multicast, PF_unicast, PF_WriteChar, PF_WriteByte, PF_WriteShort, PF_WriteLong, PF_WriteFloat,
+	PF_WriteString, PF_WritePosition, PF_WriteDir, PF_WriteAngle,
+	PF_TagMalloc, PF_TagFree, PF_FreeTags,
+	PF_cvar, PF_cvar_set, PF_cvar_forceset,
+	PF_argc, PF_argv, PF_args,
+	PF_AddCommandString, PF_DebugGraph
+};
+
+/*
+==============
+entity lump generator
+
+Every scenario plays in a square arena: a floor, four walls and a grid of
+pillars, with spawn points and items spread over the floor.
+==============
+*/
+constexpr float ARENA_SIZE = 2048;
+constexpr float ARENA_HEIGHT = 512;
+
+struct scenario
+{
+	const char	*name;
+	uint32_t	maxclients;
+	// clients connected through ClientConnect and driven by usercmds
+	uint32_t	scripted;
+	// bots added through "sv addbot"
+	uint32_t	bots;
+	// scripted clients give themselves a rocket launcher and hold fire
+	bool		rockets;
+	// trigger volumes and relay chains
+	uint32_t	trigger_chains;
+	uint32_t	chain_length;
+};
+
+static const scenario scenarios[] = {
+	{ "deathmatch",	8,	8,	0,	false,	0,	0 },
+	{ "bots32",		32,	0,	32,	false,	0,	0 },
+	{ "bots64",		64,	0,	64,	false,	0,	0 },
+	{ "rockets",	16,	16,	0,	true,	0,	0 },
+	{ "triggers",	8,	8,	0,	false,	64,	8 }
+};
+
+static std::string entity_lump;
+
+static void Lump_Begin(const char *classname)
+{
+	entity_lump += "{\n\"classname\" \"";
+	entity_lump += classname;
+	entity_lump += "\"\n";
+}
+
+static void Lump_Key(const char *key, const std::string &value)
+{
+	entity_lump += '"';
+	entity_lump += key;
+	entity_lump += "\" \"";
+	entity_lump += value;
+	entity_lump += "\"\n";
+}
+
+static void Lump_End()
+{
+	entity_lump += "}\n";
+}
+
+static std::string Lump_Vector(float x, float y, float z)
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%g %g %g", x, y, z);
+	return buffer;
+}
+
+static size_t Lump_InlineModel(const vec3 &mins, const vec3 &maxs)
+{
+	inline_models.push_back({ mins, maxs });
+	return inline_models.size();
+}
+
+static void Lump_Generate(const scenario &sc)
+{
+	constexpr float half = ARENA_SIZE / 2;
+
+	world_boxes.clear();
+	inline_models.clear();
+	entity_lump.clear();
+
+	// floor, ceiling and walls
+	world_boxes.push_back({ { -half, -half, -64 }, { half, half, 0 } });
+	world_boxes.push_back({ { -half, -half, ARENA_HEIGHT }, { half, half, ARENA_HEIGHT + 64 } });
+	world_boxes.push_back({ { -half - 64, -half, 0 }, { -half, half, ARENA_HEIGHT } });
+	world_boxes.push_back({ { half, -half, 0 }, { half + 64, half, ARENA_HEIGHT } });
+	world_boxes.push_back({ { -half, -half - 64, 0 }, { half, -half, ARENA_HEIGHT } });
+	world_boxes.push_back({ { -half, half, 0 }, { half, half + 64, ARENA_HEIGHT } });
+
+	// pillars
+	for (float x = -half + 256; x < half; x += 512)
+		for (float y = -half + 256; y < half; y += 512)
+			world_boxes.push_back({ { x - 32, y - 32, 0 }, { x + 32, y + 32, 128 } });
+
+	Lump_Begin("worldspawn");
+	Lump_Key("message", std::string("bench ") + sc.name);
+	Lump_End();
+
+	// spawn points and items on an offset grid between the pillars
+	static const char *const items[] = {
+		"weapon_rocketlauncher", "weapon_railgun", "weapon_supershotgun", "weapon_chaingun",
+		"ammo_rockets", "ammo_slugs", "ammo_shells", "ammo_bullets", "item_health", "item_armor_body"
+	};
+	constexpr int cells = (int)(ARENA_SIZE / 256);
+	size_t spawn = 0, item = 0;
+
+	for (int cx = 0; cx < cells; cx++)
+	{
+		for (int cy = 0; cy < cells; cy++)
+		{
+			const float x = -half + 128 + cx * 256, y = -half + 128 + cy * 256;
+
+			if ((cx + cy) & 1)
+			{
+				Lump_Begin("info_player_deathmatch");
+				Lump_Key("origin", Lump_Vector(x, y, 25));
+				Lump_Key("angle", std::to_string((spawn++ * 45) % 360));
+				Lump_End();
+			}
+			else
+			{
+				Lump_Begin(items[item++ % std::size(items)]);
+				Lump_Key("origin", Lump_Vector(x, y, 16));
+				Lump_End();
+			}
+		}
+	}
+
+	// each chain is a trigger volume on the floor that fires a relay,
+	// which fires the next one, and a timer that fires the same chain
+	for (uint32_t c = 0; c < sc.trigger_chains; c++)
+	{
+		const float x = -half + 64 + (c % 16) * (ARENA_SIZE - 128) / 16;
+		const float y = -half + 64 + (c / 16) * (ARENA_SIZE - 128) / 16;
+		const size_t model = Lump_InlineModel({ x - 48, y - 48, 0 }, { x + 48, y + 48, 72 });
+
+		Lump_Begin("trigger_multiple");
+		Lump_Key("model", "*" + std::to_string(model));
+		Lump_Key("wait", "0.1");
+		Lump_Key("target", "chain" + std::to_string(c) + "_0");
+		Lump_End();
+
+		Lump_Begin("func_timer");
+		Lump_Key("wait", "0.1");
+		Lump_Key("random", "0.05");
+		Lump_Key("spawnflags", "1");
+		Lump_Key("target", "chain" + std::to_string(c) + "_0");
+		Lump_End();
+
+		for (uint32_t l = 0; l < sc.chain_length; l++)
+		{
+			Lump_Begin("trigger_relay");
+			Lump_Key("targetname", "chain" + std::to_string(c) + "_" + std::to_string(l));
+
+			if (l + 1 < sc.chain_length)
+				Lump_Key("target", "chain" + std::to_string(c) + "_" + std::to_string(l + 1));
+
+			Lump_End();
+		}
+	}
+}
+
+/*
+==============
+scripted clients
+==============
+*/
+struct scripted_client
+{
+	edict		*ent;
+	float		yaw;
+	float		yaw_speed;
+	uint32_t	seed;
+};
+
+static std::vector<scripted_client> clients;
+
+// clients send commands faster than the server runs frames
+constexpr uint32_t CMDS_PER_FRAME = 4;
+constexpr uint8_t CMD_MSEC = 25;
+
+static uint32_t Client_Random(scripted_client &cl)
+{
+	cl.seed = cl.seed * 1664525 + 1013904223;
+	return cl.seed >> 8;
+}
+
+static void Client_Command(scripted_client &cl, std::vector<std::string> argv)
+{
+	Cmd_Set(argv);
+	ge->ClientCommand(cl.ent);
+}
+
+static void Clients_Connect(const scenario &sc)
+{
+	clients.clear();
+
+	for (uint32_t i = 0; i < sc.scripted; i++)
+	{
+		scripted_client cl { &EDICT_NUM(i + 1), (float)(i * 37 % 360), 20.f + (i % 7) * 15, i * 2654435761u + 1 };
+		char userinfo[MAX_INFO_STRING];
+
+		snprintf(userinfo, sizeof(userinfo), "\\name\\bench%u\\skin\\male/grunt\\hand\\2\\ip\\127.0.0.%u", i, i + 1);
+
+		if (!ge->ClientConnect(cl.ent, userinfo))
+			PF_error("client %u was refused", i);
+
+		ge->ClientBegin(cl.ent);
+
+		if (sc.rockets)
+		{
+			Client_Command(cl, { "give", "all" });
+			Client_Command(cl, { "use", "rocket launcher" });
+		}
+
+		clients.push_back(cl);
+	}
+
+	for (uint32_t i = 0; i < sc.bots; i++)
+	{
+		Cmd_Set({ "sv", "addbot", "", "bot" + std::to_string(i), "male/grunt" });
+		ge->ServerCommand();
+	}
+}
+
+static void Clients_Think(const scenario &sc, uint64_t frame)
+{
+	for (auto &cl : clients)
+	{
+		for (uint32_t n = 0; n < CMDS_PER_FRAME; n++)
+		{
+			usercmd cmd {};
+
+			cl.yaw += cl.yaw_speed * CMD_MSEC * 0.001f;
+
+			if (Client_Random(cl) % 64 == 0)
+				cl.yaw_speed = -cl.yaw_speed;
+
+			cmd.msec = CMD_MSEC;
+			cmd.angles[1] = (int16_t)(cl.yaw * 65536 / 360);
+			cmd.forwardmove = 400;
+			cmd.sidemove = (int16_t)(std::sin(frame * 0.1f + cl.yaw_speed) * 400);
+			cmd.upmove = (Client_Random(cl) % 32 == 0) ? 200 : 0;
+
+			// dead clients respawn on attack
+			if (sc.rockets || (Client_Random(cl) % 8 == 0))
+				cmd.buttons = 1;
+
+			ge->ClientThink(cl.ent, &cmd);
+		}
+	}
+}
+
+/*
+==============
+replay playback
+
+Reads the logs the game writes with "sv replay record". The layout is
+described in game/replay.h; like the ABI above, it's mirrored here rather
+than included, and has to change with it.
+==============
+*/
+constexpr uint32_t REPLAY_MAGIC = 'P' << 24 | 'R' << 16 | '2' << 8 | 'Q';
+constexpr uint32_t REPLAY_VERSION = 2;
+
+enum replay_event_type : uint8_t
+{
+	REPLAY_END,
+	REPLAY_FRAME,
+	REPLAY_SPAWN,
+	REPLAY_CONNECT,
+	REPLAY_BEGIN,
+	REPLAY_USERINFO,
+	REPLAY_DISCONNECT,
+	REPLAY_COMMAND,
+	REPLAY_SERVERCOMMAND,
+	REPLAY_THINK
+};
+
+enum : uint8_t
+{
+	REPLAY_SPAWN_FIXED_SEED	= 1 << 0
+};
+
+// anything longer than this is a corrupt length, not a string
+constexpr uint64_t REPLAY_MAX_STRING = 1 << 24;
+
+struct replay_event
+{
+	replay_event_type			type;
+	uint8_t						flags;
+	uint32_t					client;
+	uint32_t					seed;
+	std::string					mapname, entities, spawnpoint, userinfo;
+	std::vector<std::string>	argv;
+	usercmd						cmd;
+};
+
+static struct
+{
+	FILE						*fp;
+	uint64_t					frame;
+	uint32_t					maxclients;
+	std::vector<usercmd>		last_cmds;
+	std::vector<std::pair<std::string, std::string>>	cvars;
+	// why the log was rejected, if it was
+	const char					*error;
+} replay;
+
+static bool Replay_Reject(const char *error)
+{
+	replay.error = error;
+	return false;
+}
+
+static bool Replay_ReadByte(uint8_t &b)
+{
+	const int c = fgetc(replay.fp);
+
+	if (c == EOF)
+		return Replay_Reject("truncated");
+
+	b = (uint8_t)c;
+	return true;
+}
+
+static bool Replay_ReadVarint(uint64_t &v)
+{
+	uint8_t b;
+	v = 0;
+
+	for (uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		if (!Replay_ReadByte(b))
+			return false;
+
+		v |= (uint64_t)(b & 0x7F) << shift;
+
+		if (!(b & 0x80))
+			return true;
+	}
+
+	return Replay_Reject("bad varint");
+}
+
+static bool Replay_ReadString(std::string &s)
+{
+	uint64_t len;
+
+	if (!Replay_ReadVarint(len))
+		return false;
+	if (len > REPLAY_MAX_STRING)
+		return Replay_Reject("bad string length");
+
+	s.resize(len);
+
+	if (len && fread(s.data(), 1, len, replay.fp) != len)
+		return Replay_Reject("truncated");
+
+	return true;
+}
+
+static bool Replay_ReadArgs(std::vector<std::string> &argv)
+{
+	uint64_t argc;
+
+	if (!Replay_ReadVarint(argc))
+		return false;
+	if (argc > 256)
+		return Replay_Reject("bad argument count");
+
+	argv.resize(argc);
+
+	for (auto &arg : argv)
+		if (!Replay_ReadString(arg))
+			return false;
+
+	return true;
+}
+
+// open a log and read its header
+static bool Replay_Open(const char *filename)
+{
+	uint32_t magic, version;
+	uint64_t num_cvars;
+
+	replay.fp = fopen(filename, "rb");
+
+	if (!replay.fp)
+		return Replay_Reject("couldn't open it");
+	if (fread(&magic, sizeof(magic), 1, replay.fp) != 1 || magic != REPLAY_MAGIC)
+		return Replay_Reject("not a replay");
+	if (fread(&version, sizeof(version), 1, replay.fp) != 1 || version != REPLAY_VERSION)
+		return Replay_Reject("wrong version");
+	if (!Replay_ReadVarint(num_cvars))
+		return false;
+	if (num_cvars > 1024)
+		return Replay_Reject("bad cvar count");
+
+	replay.cvars.resize(num_cvars);
+
+	for (auto &cv : replay.cvars)
+		if (!Replay_ReadString(cv.first) || !Replay_ReadString(cv.second))
+			return false;
+
+	return true;
+}
+
+// read the next event; false at the end of the log, with
+// replay.error set if it ended because the log is bad
+static bool Replay_Next(replay_event &ev)
+{
+	uint8_t type;
+	uint64_t v;
+
+	// a log from a server that went down has no end marker
+	const int c = fgetc(replay.fp);
+
+	if (c == EOF)
+		return false;
+
+	type = (uint8_t)c;
+	ev.type = (replay_event_type)type;
+
+	switch (ev.type)
+	{
+	case REPLAY_END:
+		return false;
+	case REPLAY_FRAME:
+		replay.frame++;
+		return true;
+	case REPLAY_SPAWN:
+		if (!Replay_ReadByte(ev.flags) || !Replay_ReadVarint(v) || !Replay_ReadString(ev.mapname) ||
+			!Replay_ReadString(ev.entities) || !Replay_ReadString(ev.spawnpoint))
+			return false;
+		ev.seed = (uint32_t)v;
+		replay.last_cmds.assign(replay.maxclients, usercmd {});
+		return true;
+	case REPLAY_SERVERCOMMAND:
+		return Replay_ReadArgs(ev.argv);
+	case REPLAY_CONNECT:
+	case REPLAY_BEGIN:
+	case REPLAY_USERINFO:
+	case REPLAY_DISCONNECT:
+	case REPLAY_COMMAND:
+	case REPLAY_THINK:
+		break;
+	default:
+		return Replay_Reject("bad event type");
+	}
+
+	if (!Replay_ReadVarint(v))
+		return false;
+	if (v >= replay.maxclients)
+		return Replay_Reject("client number out of range");
+
+	ev.client = (uint32_t)v;
+
+	switch (ev.type)
+	{
+	case REPLAY_CONNECT:
+		replay.last_cmds[ev.client] = {};
+		[[fallthrough]];
+	case REPLAY_USERINFO:
+		if (!Replay_ReadString(ev.userinfo))
+			return false;
+		// the game gets these in a MAX_INFO_STRING buffer it may write to
+		if (ev.userinfo.empty() || ev.userinfo.size() >= MAX_INFO_STRING)
+			return Replay_Reject("bad userinfo");
+		return true;
+	case REPLAY_COMMAND:
+		return Replay_ReadArgs(ev.argv);
+	case REPLAY_THINK: {
+		uint8_t *to = (uint8_t *)&replay.last_cmds[ev.client];
+
+		if (!Replay_ReadVarint(v))
+			return false;
+		if (v >> sizeof(usercmd))
+			return Replay_Reject("bad usercmd mask");
+
+		for (size_t i = 0; i < sizeof(usercmd); i++)
+			if ((v & (1 << i)) && !Replay_ReadByte(to[i]))
+				return false;
+
+		ev.cmd = replay.last_cmds[ev.client];
+		return true; }
+	default:
+		return true;
+	}
+}
+
+// apply the recorded cvars, except ones set with --set; latched
+// ones like maxclients only take before Init
+static void Replay_ApplyCvars()
+{
+	for (auto &cv : replay.cvars)
+		PF_cvar(cv.first.c_str(), cv.second.c_str(), 0);
+}
+
+// feed an event to the game
+static void Replay_Run(replay_event &ev)
+{
+	edict *ent = (ev.type >= REPLAY_CONNECT && ev.type != REPLAY_SERVERCOMMAND) ? &EDICT_NUM(ev.client + 1) : nullptr;
+	char userinfo[MAX_INFO_STRING];
+
+	if (ev.type == REPLAY_CONNECT || ev.type == REPLAY_USERINFO)
+		memcpy(userinfo, ev.userinfo.c_str(), ev.userinfo.size() + 1);
+
+	switch (ev.type)
+	{
+	case REPLAY_FRAME:
+		ge->RunFrame();
+		break;
+	case REPLAY_SPAWN: {
+		const scenario *sc = &scenarios[0];
+
+		for (auto &s : scenarios)
+			if (ev.mapname == s.name)
+				sc = &s;
+
+		// rebuild the box world the log was recorded in
+		Lump_Generate(*sc);
+
+		if (verbose)
+			printf("[replay] %s, seed %u (%s)\n", ev.mapname.c_str(), ev.seed, (ev.flags & REPLAY_SPAWN_FIXED_SEED) ? "g_seed" : "random");
+
+		// the game reseeds from g_seed on every spawn; 0 is a seed like any other
+		PF_cvar_set("g_seed", std::to_string(ev.seed).c_str());
+		ge->SpawnEntities(ev.mapname.c_str(), ev.entities.c_str(), ev.spawnpoint.c_str());
+		break; }
+	case REPLAY_CONNECT:
+		ge->ClientConnect(ent, userinfo);
+		break;
+	case REPLAY_BEGIN:
+		ge->ClientBegin(ent);
+		break;
+	case REPLAY_USERINFO:
+		ge->ClientUserinfoChanged(ent, userinfo);
+		break;
+	case REPLAY_DISCONNECT:
+		ge->ClientDisconnect(ent);
+		break;
+	case REPLAY_COMMAND:
+		Cmd_Set(ev.argv);
+		ge->ClientCommand(ent);
+		break;
+	case REPLAY_SERVERCOMMAND:
+		Cmd_Set(ev.argv);
+		ge->ServerCommand();
+		break;
+	case REPLAY_THINK:
+		ge->ClientThink(ent, &ev.cmd);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+==============
+benchmark
+==============
+*/
+static double Percentile(const std::vector<double> &sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+
+	return sorted[std::min(sorted.size() - 1, (size_t)(p * (sorted.size() - 1) + 0.5))];
+}
+
+/*
+==============
+game profiler zones
+
+If the game was built with PROFILE, its zone profiler captures every
+measured frame to a Chrome trace, which is summed up here by zone. Zones
+nest, so their times overlap each other and the imports.
+==============
+*/
+static const char *const PROFILE_TRACE_NAME = "bench_profile";
+static const char *const PROFILE_TRACE_PATH = "baseq2/bench_profile.json";
+
+// capture the next frames frames; without PROFILE the game
+// doesn't know the command and no trace is written
+static void Profile_Start(uint64_t frames)
+{
+	std::filesystem::create_directories("baseq2");
+	std::filesystem::remove(PROFILE_TRACE_PATH);
+
+	Cmd_Set({ "sv", "profile", "trace", std::to_string(std::max<uint64_t>(frames, 1)), PROFILE_TRACE_NAME });
+	ge->ServerCommand();
+}
+
+static void Profile_Report(uint64_t frames, double frame_sum_ms)
+{
+	FILE *fp = fopen(PROFILE_TRACE_PATH, "r");
+
+	if (!fp)
+	{
+		printf("game zones: none; build the game with PROFILE for them\n");
+		return;
+	}
+
+	struct zone_total
+	{
+		std::string	name;
+		uint64_t	calls;
+		double		ms;
+	};
+
+	std::vector<zone_total> zones;
+	char line[512], name[128];
+	double ts, dur;
+
+	while (fgets(line, sizeof(line), fp))
+	{
+		if (sscanf(line, "{\"name\":\"%127[^\"]\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%lf,\"dur\":%lf", name, &ts, &dur) != 3)
+			continue;
+
+		auto it = std::find_if(zones.begin(), zones.end(), [&](const zone_total &z) { return z.name == name; });
+
+		if (it == zones.end())
+			it = zones.insert(zones.end(), { name, 0, 0 });
+
+		it->calls++;
+		it->ms += dur / 1000;
+	}
+
+	fclose(fp);
+
+	std::sort(zones.begin(), zones.end(), [](const zone_total &a, const zone_total &b) { return a.ms > b.ms; });
+
+	printf("game zones (trace in %s):\n", PROFILE_TRACE_PATH);
+
+	for (auto &z : zones)
+		printf("  %-26s %10.1f calls/frame  %8.3f ms/frame  %5.1f%%\n", z.name.c_str(), (double)z.calls / frames,
+			z.ms / frames, frame_sum_ms ? z.ms * 100 / frame_sum_ms : 0);
+}
+
+// counters at the start of the measured frames
+struct bench_baseline
+{
+	decltype(::imports)	imports;
+	decltype(::memory)	memory;
+	decltype(::net)		net;
+};
+
+static bench_baseline Bench_Baseline()
+{
+	return { imports, memory, net };
+}
+
+// print everything measured since base over frame_ms; returns the p99
+static double Bench_Report(const std::vector<double> &frame_ms, double total_ms, const bench_baseline &base)
+{
+	const uint64_t frames = std::max<uint64_t>(frame_ms.size(), 1);
+	std::vector<double> sorted = frame_ms;
+	std::sort(sorted.begin(), sorted.end());
+
+	double sum = 0;
+	for (double ms : frame_ms)
+		sum += ms;
+
+	const double mean = frame_ms.empty() ? 0 : sum / frame_ms.size();
+	const double p99 = Percentile(sorted, 0.99);
+
+	printf("frame ms: mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f  (%.1fs wall)\n", mean, Percentile(sorted, 0.5),
+		Percentile(sorted, 0.9), p99, sorted.empty() ? 0 : sorted.back(), total_ms / 1000);
+
+	double import_ms = 0;
+	printf("imports:\n");
+
+	for (int z = 0; z < ZONE_TOTAL; z++)
+	{
+		const uint64_t calls = imports.calls[z] - base.imports.calls[z];
+		const double ms = (imports.ns[z] - base.imports.ns[z]) / 1e6;
+
+		import_ms += ms;
+		printf("  %-14s %10.1f calls/frame  %8.3f ms/frame  %5.1f%%\n", zone_names[z], (double)calls / frames,
+			ms / frames, sum ? ms * 100 / sum : 0);
+	}
+
+	printf("  %-14s %10s             %8.3f ms/frame  %5.1f%%\n", "game", "", (sum - import_ms) / frames,
+		sum ? (sum - import_ms) * 100 / sum : 0);
+	printf("memory: %.1f allocs/frame, %.1f frees/frame, %llu KB live, %llu KB peak\n",
+		(double)(memory.allocs - base.memory.allocs) / frames,
+		(double)(memory.frees - base.memory.frees) / frames,
+		(unsigned long long)(memory.live / 1024), (unsigned long long)(memory.peak / 1024));
+	printf("network: %.1f messages/frame, %.1f bytes/frame\n", (double)(net.messages - base.net.messages) / frames,
+		(double)(net.bytes - base.net.bytes) / frames);
+
+	Profile_Report(frames, sum);
+
+	return p99;
+}
+
+// run a scenario for frames frames, optionally recording it
+static double Bench_Scenario(const scenario &sc, uint64_t frames, const char *record)
+{
+	PF_cvar("maxclients", std::to_string(sc.maxclients).c_str(), 0);
+	PF_cvar("deathmatch", "1", 0);
+	PF_cvar("cheats", sc.rockets ? "1" : "0", 0);
+	PF_cvar("dedicated", "1", 0);
+
+	ge->Init();
+
+	// the recorder starts at the next spawn; it writes to <basedir>/baseq2
+	if (record)
+	{
+		std::filesystem::create_directories("baseq2");
+		Cmd_Set({ "sv", "replay", "record", record });
+		ge->ServerCommand();
+		printf("recording to baseq2/%s.rpl\n", record);
+	}
+
+	Lump_Generate(sc);
+	ge->SpawnEntities(sc.name, entity_lump.c_str(), "");
+
+	// let the level settle before anyone joins
+	for (int i = 0; i < 5; i++)
+		ge->RunFrame();
+
+	Clients_Connect(sc);
+
+	constexpr uint64_t WARMUP_FRAMES = 20;
+	std::vector<double> frame_ms;
+	frame_ms.reserve(frames);
+
+	bench_baseline base = Bench_Baseline();
+	const auto start = bench_clock::now();
+
+	for (uint64_t frame = 0; frame < frames + WARMUP_FRAMES; frame++)
+	{
+		if (frame == WARMUP_FRAMES)
+		{
+			base = Bench_Baseline();
+			Profile_Start(frames);
+		}
+
+		const auto frame_start = bench_clock::now();
+
+		Clients_Think(sc, frame);
+		ge->RunFrame();
+
+		if (frame >= WARMUP_FRAMES)
+			frame_ms.push_back(std::chrono::duration<double, std::milli>(bench_clock::now() - frame_start).count());
+	}
+
+	const double total_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+
+	printf("scenario %s: %u clients, %u bots, %llu frames, %u edicts in use at the end\n", sc.name, sc.scripted, sc.bots,
+		(unsigned long long)frames, ge->num_edicts);
+
+	const double p99 = Bench_Report(frame_ms, total_ms, base);
+
+	// the bots' visibility queries and traces
+	if (sc.bots)
+	{
+		echo = true;
+		Cmd_Set({ "sv", "botvis" });
+		ge->ServerCommand();
+		echo = false;
+	}
+
+	return p99;
+}
+
+// play back a log, timing every recorded frame. a frame is
+// charged with the events that lead up to its RunFrame.
+static double Bench_Replay(const char *filename)
+{
+	replaying = true;
+
+	if (!Replay_Open(filename))
+	{
+		fprintf(stderr, "can't replay %s: %s\n", filename, replay.error);
+		exit(1);
+	}
+
+	Replay_ApplyCvars();
+	PF_cvar("dedicated", "1", 0);
+
+	ge->Init();
+
+	replay.maxclients = (uint32_t)PF_cvar("maxclients", "1", 0)->value;
+
+	std::vector<double> frame_ms;
+	replay_event ev;
+	double pending_ms = 0;
+
+	// read the whole log first; a bad one is rejected before any of
+	// it runs, and the profiler wants to know how many frames to capture
+	while (Replay_Next(ev))
+		;
+
+	if (replay.error)
+	{
+		fprintf(stderr, "can't replay %s: %s at frame %llu\n", filename, replay.error, (unsigned long long)replay.frame);
+		exit(1);
+	}
+
+	const uint64_t replay_frames = replay.frame;
+
+	fclose(replay.fp);
+	replay.frame = 0;
+
+	if (!Replay_Open(filename))
+	{
+		fprintf(stderr, "can't replay %s: %s\n", filename, replay.error);
+		exit(1);
+	}
+
+	Profile_Start(replay_frames);
+
+	const bench_baseline base = Bench_Baseline();
+	const auto start = bench_clock::now();
+
+	while (Replay_Next(ev))
+	{
+		const auto event_start = bench_clock::now();
+
+		Replay_Run(ev);
+
+		pending_ms += std::chrono::duration<double, std::milli>(bench_clock::now() - event_start).count();
+
+		if (ev.type == REPLAY_FRAME)
+		{
+			frame_ms.push_back(pending_ms);
+			pending_ms = 0;
+		}
+	}
+
+	if (replay.error)
+	{
+		fprintf(stderr, "can't replay %s: %s at frame %llu\n", filename, replay.error, (unsigned long long)replay.frame);
+		exit(1);
+	}
+
+	const double total_ms = std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+
+	printf("replay %s: %u clients, %llu frames, %u edicts in use at the end\n", filename, replay.maxclients,
+		(unsigned long long)frame_ms.size(), ge->num_edicts);
+
+	return Bench_Report(frame_ms, total_ms, base);
+}
+
+static void *Host_LoadGame(const char *path)
+{
+#ifdef _WIN32
+	HMODULE lib = LoadLibraryA(path);
+	return lib ? (void *)GetProcAddress(lib, "GetGameAPI") : nullptr;
+#else
+	void *lib = dlopen(path, RTLD_NOW);
+	return lib ? dlsym(lib, "GetGameAPI") : nullptr;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+	const char *library = nullptr, *scenario_name = "deathmatch";
+	const char *replay_file = nullptr, *record = nullptr;
+	std::vector<std::pair<const char *, const char *>> sets;
+	uint64_t frames = 1000;
+	double budget = 0;
+	int positional = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--verbose"))
+			verbose = true;
+		else if (!strcmp(argv[i], "--budget") && i + 1 < argc)
+			budget = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+			replay_file = argv[++i];
+		else if (!strcmp(argv[i], "--record") && i + 1 < argc)
+			record = argv[++i];
+		else if (!strcmp(argv[i], "--set") && i + 2 < argc)
+		{
+			sets.push_back({ argv[i + 1], argv[i + 2] });
+			i += 2;
+		}
+		else if (positional == 0 && ++positional)
+			library = argv[i];
+		else if (positional == 1 && ++positional)
+			scenario_name = argv[i];
+		else if (positional == 2 && ++positional)
+			frames = strtoull(argv[i], nullptr, 10);
+	}
+
+	if (!library)
+	{
+		fprintf(stderr, "usage: bench <game library> [scenario] [frames] [--budget <p99 ms>] [--record <name>] [--set <cvar> <value>]... [--verbose]\n"
+			"       bench <game library> --replay <file> [--budget <p99 ms>] [--set <cvar> <value>]... [--verbose]\nscenarios:");
+
+		for (auto &sc : scenarios)
+			fprintf(stderr, " %s", sc.name);
+
+		fprintf(stderr, "\n");
+		return 1;
+	}
+
+	const scenario *sc = nullptr;
+
+	for (auto &s : scenarios)
+		if (!strcmp(s.name, scenario_name))
+			sc = &s;
+
+	if (!sc && !replay_file)
+	{
+		fprintf(stderr, "unknown scenario %s\n", scenario_name);
+		return 1;
+	}
+
+	GetGameAPI_func GetGameAPI = (GetGameAPI_func)Host_LoadGame(library);
+
+	if (!GetGameAPI)
+	{
+		fprintf(stderr, "couldn't load GetGameAPI from %s\n", library);
+		return 1;
+	}
+
+	area_head.next = area_head.prev = &area_head;
+
+	ge = GetGameAPI(&host_imports);
+
+	if (ge->apiversion != GAME_API_VERSION)
+	{
+		fprintf(stderr, "game is version %i, not %i\n", ge->apiversion, GAME_API_VERSION);
+		return 1;
+	}
+
+	// ahead of the scenario's and the replay's own cvars, which
+	// only create theirs if they don't exist yet
+	for (auto &set : sets)
+		PF_cvar(set.first, set.second, 0);
+
+	const double p99 = replay_file ? Bench_Replay(replay_file) : Bench_Scenario(*sc, frames, record);
+
+	ge->Shutdown();
+
+	if (budget > 0 && p99 > budget)
+	{
+		printf("FAILED: p99 %.3f ms is over the %.3f ms budget\n", p99, budget);
+		return 3;
+	}
+
+	return 0;
+}
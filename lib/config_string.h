@@ -2,6 +2,9 @@
 
 #include "types.h"
 
+// max size of a Quake path
+constexpr size_t MAX_QPATH = 64;
+
 //
 // per-level limits
 //
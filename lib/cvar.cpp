@@ -1,3 +1,77 @@
 #include "cvar.h"
+#include "map.h"
+#include <climits>
 
-/*static*/ qboolean cvarref::empty_modified = false;
\ No newline at end of file
+/*static*/ qboolean cvarref::empty_modified = false;
+/*static*/ cvar_cache cvarref::empty_cache = { nullptr, 0, false, {} };
+
+// cvar records are never freed by the engine, so
+// the pointers are good keys for as long as the game runs
+static map<cvar *, cvar_cache> cvar_caches;
+
+static void Cvar_Fill(cvar_cache &cache)
+{
+	const cvar &cv = *cache.cv;
+	const stringlit s = cv.string;
+
+	cache.boolean = s && *s && !(s[0] == '0' && s[1] == '\0');
+
+	// atof can give values an int can't hold
+	if (cv.value >= (float)INT_MAX)
+		cache.integer = INT_MAX;
+	else if (cv.value <= (float)INT_MIN)
+		cache.integer = INT_MIN;
+	else
+		cache.integer = (int32_t)cv.value;
+}
+
+cvar_cache &Cvar_Cache(cvar &cv)
+{
+	auto it = cvar_caches.find(&cv);
+
+	if (it != cvar_caches.end())
+		return it->second;
+
+	cvar_cache &cache = cvar_caches[&cv];
+	cache.cv = &cv;
+	Cvar_Fill(cache);
+	return cache;
+}
+
+void Cvar_Refresh(cvar &cv)
+{
+	auto it = cvar_caches.find(&cv);
+
+	if (it != cvar_caches.end())
+		Cvar_Fill(it->second);
+}
+
+void Cvar_OnChange(const cvarref &cv, cvar_changed_func func)
+{
+	if (cv.cv)
+		cv.cache->callbacks.push_back(func);
+}
+
+void Cvar_Update()
+{
+	for (auto &entry : cvar_caches)
+	{
+		cvar &cv = *entry.first;
+
+		if (!cv.modified)
+			continue;
+
+		cv.modified = false;
+
+		cvar_cache &cache = entry.second;
+		Cvar_Fill(cache);
+
+		if (cache.callbacks.empty())
+			continue;
+
+		cvarref ref(cv);
+
+		for (auto &func : cache.callbacks)
+			func(ref);
+	}
+}
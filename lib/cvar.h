@@ -1,6 +1,8 @@
 #pragma once
 
 #include "types.h"
+#include "dynarray.h"
+#include <type_traits>
 
 enum cvar_flags : int32_t
 {
@@ -35,31 +37,71 @@ struct cvar
 	const float			value;
 };
 
+struct cvarref;
+
+// called from Cvar_Update after a cvar changes
+using cvar_changed_func = void (*)(cvarref &cvar);
+
+// the typed values of a cvar, kept by the cvar registry. they're
+// refreshed by Cvar_Update once a frame, and straight away when the
+// game sets the cvar itself.
+struct cvar_cache
+{
+	cvar							*cv;
+	int32_t							integer;
+	bool							boolean;
+	dynarray<cvar_changed_func>		callbacks;
+};
+
+// fetch the registry's cache for a cvar, adding it if need be
+cvar_cache &Cvar_Cache(cvar &cv);
+
+// re-read a cvar into its cache
+void Cvar_Refresh(cvar &cv);
+
+// call func from Cvar_Update whenever cv changes
+void Cvar_OnChange(const cvarref &cv, cvar_changed_func func);
+
+// refresh every cached cvar whose modified flag is set, clearing
+// it and calling its change callbacks. called once a frame; anything
+// else that used to poll modified should register a callback instead.
+void Cvar_Update();
+
 // a wrapper for cvar that can perform conversions automatically.
 struct cvarref
 {
 private:
 	cvar *cv;
+	cvar_cache *cache;
 	static constexpr cvar_flags empty_flags = CVAR_NONE; 
 	static qboolean empty_modified; 
 	static constexpr float empty_value = 0.f; 
+	static constexpr stringlit empty_string = nullptr;
+	static cvar_cache empty_cache;
+
+	friend void Cvar_OnChange(const cvarref &cv, cvar_changed_func func);
 
 public:
 	stringlit			name;
-	stringlit			string;
-	stringlit			latched_string;
+	// these follow the engine's copies, which it replaces on every change
+	const stringlit		&string;
+	const stringlit		&latched_string;
 	const cvar_flags	&flags;
 	qboolean			&modified;
 	const float			&value;
+	// value as an integer, from the cache
+	const int32_t		&intVal;
 
 	cvarref() :
 		cv(nullptr),
+		cache(&empty_cache),
 		name(nullptr),
-		string(nullptr),
-		latched_string(nullptr),
+		string(empty_string),
+		latched_string(empty_string),
 		flags(empty_flags),
 		modified(empty_modified),
-		value(empty_value)
+		value(empty_value),
+		intVal(empty_cache.integer)
 	{
 	}
 
@@ -70,12 +112,14 @@ public:
 
 	cvarref(cvar &v) :
 		cv(&v),
+		cache(&Cvar_Cache(v)),
 		name(v.name),
 		string(v.string),
 		latched_string(v.latched_string),
 		flags(v.flags),
 		modified(v.modified),
-		value(v.value)
+		value(v.value),
+		intVal(cache->integer)
 	{
 	}
 	
@@ -95,14 +139,18 @@ public:
 	// as true
 	inline explicit operator bool() const
 	{
-		return *string && !(string[0] == '0' && string[1] == '\0');
+		return cache->boolean;
 	}
 
-	// everything else is templated
+	// everything else is templated; integers, enums and
+	// bitflags come from the cached integer
 	template<typename T>
 	inline explicit operator T() const
 	{
-		return (T)value;
+		if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+			return (T)cache->integer;
+		else
+			return (T)value;
 	}
 
 	inline bool operator==(stringlit lit) const { return (stringref)string == lit; }
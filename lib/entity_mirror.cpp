@@ -0,0 +1,129 @@
+#include "entity_mirror.h"
+#include "gi.h"
+#include "format.h"
+#include <bit>
+
+entity_mirror ent_mirror;
+
+static inline void Mirror_Store(array<float, MAX_EDICTS> &x, array<float, MAX_EDICTS> &y, array<float, MAX_EDICTS> &z, const size_t &number, const vector &v)
+{
+	x[number] = v.x;
+	y[number] = v.y;
+	z[number] = v.z;
+}
+
+static inline mirror_flags Mirror_Flags(const entity &ent)
+{
+	mirror_flags flags = MIRROR_NONE;
+
+	if (ent.inuse)
+		flags |= MIRROR_INUSE;
+	if (ent.is_linked())
+		flags |= MIRROR_LINKED;
+	if (ent.is_client())
+		flags |= MIRROR_CLIENT;
+
+	return flags;
+}
+
+void Mirror_Update(const entity &ent)
+{
+	const size_t number = ent.s.number;
+
+	Mirror_Store(ent_mirror.origin_x, ent_mirror.origin_y, ent_mirror.origin_z, number, ent.s.origin);
+	Mirror_Store(ent_mirror.center_x, ent_mirror.center_y, ent_mirror.center_z, number, ent.s.origin + (ent.mins + ent.maxs) * 0.5f);
+	Mirror_Store(ent_mirror.absmin_x, ent_mirror.absmin_y, ent_mirror.absmin_z, number, ent.absmin);
+	Mirror_Store(ent_mirror.absmax_x, ent_mirror.absmax_y, ent_mirror.absmax_z, number, ent.absmax);
+
+	ent_mirror.flags[number] = Mirror_Flags(ent);
+	ent_mirror.solid[number] = ent.solid;
+	ent_mirror.svflags[number] = ent.svflags;
+	ent_mirror.movetype[number] = ent.g.movetype;
+}
+
+void Mirror_Rebuild()
+{
+	for (auto &e : entity_range(0, max_entities - 1))
+		Mirror_Update(e);
+}
+
+// bitwise, so a NaN still matches itself
+static inline bool Mirror_Same(const array<float, MAX_EDICTS> &x, const array<float, MAX_EDICTS> &y, const array<float, MAX_EDICTS> &z, const size_t &number, const vector &v)
+{
+	return std::bit_cast<uint32_t>(x[number]) == std::bit_cast<uint32_t>(v.x) &&
+		std::bit_cast<uint32_t>(y[number]) == std::bit_cast<uint32_t>(v.y) &&
+		std::bit_cast<uint32_t>(z[number]) == std::bit_cast<uint32_t>(v.z);
+}
+
+size_t Mirror_Check()
+{
+	enum : size_t
+	{
+		FIELD_ORIGIN,
+		FIELD_CENTER,
+		FIELD_ABSMIN,
+		FIELD_ABSMAX,
+		FIELD_FLAGS,
+		FIELD_SOLID,
+		FIELD_SVFLAGS,
+		FIELD_MOVETYPE,
+
+		FIELD_TOTAL
+	};
+
+	static constexpr stringlit field_names[FIELD_TOTAL] = {
+		"origin", "center", "absmin", "absmax", "flags", "solid", "svflags", "movetype"
+	};
+
+	// only list the first few; the totals cover the rest
+	constexpr size_t max_listed = 16;
+
+	array<size_t, FIELD_TOTAL> totals {};
+	size_t num_differ = 0;
+
+	for (auto &e : entity_range(0, max_entities - 1))
+	{
+		const size_t number = e.s.number;
+
+		const array<bool, FIELD_TOTAL> differs = {
+			!Mirror_Same(ent_mirror.origin_x, ent_mirror.origin_y, ent_mirror.origin_z, number, e.s.origin),
+			!Mirror_Same(ent_mirror.center_x, ent_mirror.center_y, ent_mirror.center_z, number, e.s.origin + (e.mins + e.maxs) * 0.5f),
+			!Mirror_Same(ent_mirror.absmin_x, ent_mirror.absmin_y, ent_mirror.absmin_z, number, e.absmin),
+			!Mirror_Same(ent_mirror.absmax_x, ent_mirror.absmax_y, ent_mirror.absmax_z, number, e.absmax),
+			ent_mirror.flags[number] != Mirror_Flags(e),
+			ent_mirror.solid[number] != e.solid,
+			ent_mirror.svflags[number] != e.svflags,
+			ent_mirror.movetype[number] != e.g.movetype
+		};
+
+		format_buffer<128> fields;
+
+		for (size_t i = 0; i < FIELD_TOTAL; i++)
+		{
+			if (!differs[i])
+				continue;
+
+			totals[i]++;
+			fields.append(" {}", field_names[i]);
+		}
+
+		if (!fields.size())
+			continue;
+
+		if (num_differ < max_listed)
+			gi.dprintf("%4u (type %u%s):%s\n", (uint32_t)number, (uint32_t)e.g.type, e.inuse ? "" : ", free", fields.ptr());
+
+		num_differ++;
+	}
+
+	if (num_differ > max_listed)
+		gi.dprintf("...and %u more\n", (uint32_t)(num_differ - max_listed));
+
+	gi.dprintf("mirror: %u of %u entities differ\n", (uint32_t)num_differ, (uint32_t)max_entities);
+
+	for (size_t i = 0; i < FIELD_TOTAL; i++)
+		if (totals[i])
+			gi.dprintf("  %-8s %u\n", field_names[i], (uint32_t)totals[i]);
+
+	return num_differ;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "types.h"
+#include "config_string.h"
+#include "entity.h"
+#include "vector_batch.h"
+
+/*
+==============
+entity mirror
+
+A packed copy of the few entity fields that whole-world scans filter and
+measure on, kept as parallel arrays indexed by entity number. An edict is
+several hundred bytes, so a loop over every entity that only wants a
+position drags at least a cache line per entity in; the mirror holds the
+same data in a few tens of kilobytes, laid out for the batch kernels.
+
+It's updated at the points these fields are meant to change: gi.linkentity,
+gi.unlinkentity and gi.setmodel (which links inline brush models itself),
+entity::__init and __free, and wherever inuse is set. Game code also
+changes solid and s.origin without relinking (bfg_touch, say), and the
+engine's traces read the live solid, so the mirror can lag behind an
+entity until its next link. Scans use it to narrow down candidates and
+then check the entity itself; "sv mirror" lists the ones that lag.
+
+"sv mirror" compares the mirror against every entity and lists anything
+that differs.
+==============
+*/
+
+enum mirror_flags : uint8_t
+{
+	MIRROR_NONE		= 0,
+	MIRROR_INUSE	= 1 << 0,
+	MIRROR_LINKED	= 1 << 1,
+	MIRROR_CLIENT	= 1 << 2
+};
+
+MAKE_ENUM_BITWISE(mirror_flags);
+
+struct entity_mirror
+{
+	alignas(16) array<float, MAX_EDICTS>	origin_x, origin_y, origin_z;
+	// s.origin + (mins + maxs) * 0.5, which is what findradius measures
+	alignas(16) array<float, MAX_EDICTS>	center_x, center_y, center_z;
+	alignas(16) array<float, MAX_EDICTS>	absmin_x, absmin_y, absmin_z;
+	alignas(16) array<float, MAX_EDICTS>	absmax_x, absmax_y, absmax_z;
+
+	array<mirror_flags, MAX_EDICTS>	flags;
+	array<solidity, MAX_EDICTS>		solid;
+	array<server_flags, MAX_EDICTS>	svflags;
+	array<move_type, MAX_EDICTS>	movetype;
+
+	// lanes over entities first up to (but not including) last
+
+	inline vector_lanes origins(const size_t &first, const size_t &last) { return { origin_x.data() + first, origin_y.data() + first, origin_z.data() + first, last - first }; }
+	inline vector_lanes centers(const size_t &first, const size_t &last) { return { center_x.data() + first, center_y.data() + first, center_z.data() + first, last - first }; }
+	inline vector_lanes absmins(const size_t &first, const size_t &last) { return { absmin_x.data() + first, absmin_y.data() + first, absmin_z.data() + first, last - first }; }
+	inline vector_lanes absmaxs(const size_t &first, const size_t &last) { return { absmax_x.data() + first, absmax_y.data() + first, absmax_z.data() + first, last - first }; }
+
+	inline bool has(const size_t &number, const mirror_flags &bits) const { return (flags[number] & bits) == bits; }
+};
+
+extern entity_mirror ent_mirror;
+
+// copy ent's fields into the mirror; call after changing any of them
+// outside of the usual choke points
+void Mirror_Update(const entity &ent);
+
+// copy every entity into the mirror
+void Mirror_Rebuild();
+
+// "sv mirror"; compare the mirror against every entity, listing the
+// ones that differ and how. returns the number that did.
+size_t Mirror_Check();
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "types.h"
+#include "vector.h"
+#include <format>
+#include <string_view>
+
+// default size of a strformat buffer
+constexpr size_t MAX_FORMAT_LENGTH = 1024;
+
+// a fixed-size, always null-terminated buffer that text can be
+// formatted into without touching the heap. anything that doesn't
+// fit is cut off.
+template<size_t N>
+class format_buffer
+{
+	static_assert(N > 0, "format_buffer needs room for a terminator");
+
+	array<char, N>	data;
+	size_t			len = 0;
+	bool			cut = false;
+
+public:
+	inline format_buffer()
+	{
+		data[0] = 0;
+	}
+
+	// format onto the end of the buffer. the format string is
+	// checked against the argument types at compile time.
+	template<typename ...TArgs>
+	format_buffer &append(std::format_string<TArgs...> fmt, TArgs &&...args)
+	{
+		const size_t room = N - 1 - len;
+		const auto result = std::format_to_n(data.data() + len, room, fmt, std::forward<TArgs>(args)...);
+
+		cut = cut || (size_t)result.size > room;
+		len = result.out - data.data();
+		data[len] = 0;
+		return *this;
+	}
+
+	inline stringlit ptr() const { return data.data(); }
+	inline size_t size() const { return len; }
+	inline std::string_view view() const { return { data.data(), len }; }
+
+	// whether any append didn't fit
+	inline bool truncated() const { return cut; }
+
+	inline explicit operator string() const { return string(data.data(), 0, len); }
+};
+
+// format into a new stack buffer
+template<size_t N = MAX_FORMAT_LENGTH, typename ...TArgs>
+inline format_buffer<N> strformat(std::format_string<TArgs...> fmt, TArgs &&...args)
+{
+	format_buffer<N> buffer;
+	buffer.append(fmt, std::forward<TArgs>(args)...);
+	return buffer;
+}
+
+// strings format as their text; a null string is empty
+template<>
+struct std::formatter<::string> : std::formatter<std::string_view>
+{
+	template<typename TContext>
+	auto format(const ::string &s, TContext &ctx) const
+	{
+		return std::formatter<std::string_view>::format(s ? std::string_view(s.ptr(), s.size()) : std::string_view(), ctx);
+	}
+};
+
+// vectors format as their three components separated by spaces,
+// each with the given float format; "{:.1f}" gives "1.0 2.0 3.0"
+template<>
+struct std::formatter<::vector> : std::formatter<float>
+{
+	template<typename TContext>
+	auto format(const ::vector &v, TContext &ctx) const
+	{
+		auto out = ctx.out();
+
+		for (size_t i = 0; i < ::vector::size; i++)
+		{
+			if (i)
+			{
+				*out++ = ' ';
+				ctx.advance_to(out);
+			}
+
+			out = std::formatter<float>::format(v[i], ctx);
+		}
+
+		return out;
+	}
+};
@@ -1,5 +1,7 @@
 #include "gi.h"
 #include "entity.h"
+#include "entity_mirror.h"
+#include <bit>
 
 game_import gi;
 
@@ -167,6 +169,26 @@ void game_import::centerprintf(const entity &ent, stringlit fmt, ...)
 	va_end(argptr);
 }
 
+void game_import::bprint(print_level printlevel, stringlit text)
+{
+	impl.bprintf(printlevel, "%s", text);
+}
+
+void game_import::dprint(stringlit text)
+{
+	impl.dprintf("%s", text);
+}
+
+void game_import::cprint(const entity &ent, print_level printlevel, stringlit text)
+{
+	impl.cprintf(const_cast<entity *>(&ent), printlevel, "%s", text);
+}
+
+void game_import::centerprint(const entity &ent, stringlit text)
+{
+	impl.centerprintf(const_cast<entity *>(&ent), "%s", text);
+}
+
 // sounds
 
 // fetch a sound index from the specified sound file
@@ -195,37 +217,409 @@ model_index game_import::modelindex(const stringref &name)
 	return (model_index)impl.modelindex(name.ptr());
 }
 	
+static void TraceCache_Link(const entity &ent);
+
 // set model to specified string value; use this for bmodels, also sets mins/maxs
 void game_import::setmodel(entity &ent, const stringref &name)
 {
 	impl.setmodel(&ent, name.ptr());
+	// inline brush models are linked by the engine here
+	TraceCache_Link(ent);
+	Mirror_Update(ent);
 }
 
 // images
 
+#ifdef ENGINE_CALL_STATS
+#include "map.h"
+#include <algorithm>
+#include <chrono>
+
+/*
+==============
+engine call accounting
+
+Every collision and linking call is charged to the source line that made it,
+so the report can say which trace in which function is eating the frame.
+Times are inclusive: a Pmove includes the traces it makes back into the game.
+==============
+*/
+
+enum engine_call_kind : uint8_t
+{
+	CALL_TRACE,
+	CALL_TRACELINE,
+	CALL_POINTCONTENTS,
+	CALL_INPVS,
+	CALL_INPHS,
+	CALL_LINKENTITY,
+	CALL_UNLINKENTITY,
+	CALL_BOXEDICTS,
+	CALL_PMOVE,
+
+	CALL_TOTAL
+};
+
+static constexpr stringlit engine_call_names[CALL_TOTAL] = {
+	"trace",
+	"traceline",
+	"pointcontents",
+	"inPVS",
+	"inPHS",
+	"linkentity",
+	"unlinkentity",
+	"BoxEdicts",
+	"Pmove"
+};
+
+struct engine_call_key
+{
+	// file_name() is a literal, so the pointer identifies the file
+	stringlit			file;
+	uint32_t			line;
+	engine_call_kind	kind;
+
+	bool operator==(const engine_call_key &) const = default;
+};
+
+template<>
+struct std::hash<engine_call_key>
+{
+	size_t operator()(const engine_call_key &key) const noexcept
+	{
+		return std::hash<stringlit>()(key.file) ^ ((size_t)key.line << 4) ^ key.kind;
+	}
+};
+
+struct engine_call_site
+{
+	stringlit	function;
+	uint64_t	calls, ns;
+	uint32_t	frame_calls, peak_calls;
+};
+
+static struct
+{
+	map<engine_call_key, engine_call_site>	sites;
+	uint64_t								frames;
+} engine_calls;
+
+class engine_call_timer
+{
+	const engine_call_kind							kind;
+	const std::source_location						&caller;
+	const std::chrono::steady_clock::time_point		start;
+
+public:
+	engine_call_timer(engine_call_kind kind, const std::source_location &caller) :
+		kind(kind),
+		caller(caller),
+		start(std::chrono::steady_clock::now())
+	{
+	}
+
+	~engine_call_timer()
+	{
+		const auto end = std::chrono::steady_clock::now();
+
+		engine_call_site &site = engine_calls.sites[{ caller.file_name(), caller.line(), kind }];
+
+		site.function = caller.function_name();
+		site.calls++;
+		site.frame_calls++;
+		site.ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	}
+};
+
+#define ENGINE_CALL(kind) \
+	const engine_call_timer engine_call_timer_(kind, caller)
+
+void EngineCalls_EndFrame()
+{
+	engine_calls.frames++;
+
+	for (auto &it : engine_calls.sites)
+	{
+		it.second.peak_calls = max(it.second.peak_calls, it.second.frame_calls);
+		it.second.frame_calls = 0;
+	}
+}
+
+void EngineCalls_Reset()
+{
+	engine_calls.sites.clear();
+	engine_calls.frames = 0;
+}
+
+void EngineCalls_Report(size_t count)
+{
+	if (!engine_calls.frames)
+	{
+		gi.dprintf("engcalls: no frames recorded\n");
+		return;
+	}
+
+	dynarray<const decltype(engine_calls.sites)::value_type *> sorted;
+	array<uint64_t, CALL_TOTAL> kind_calls {}, kind_ns {};
+	uint64_t total_ns = 0;
+
+	sorted.reserve(engine_calls.sites.size());
+
+	for (auto &it : engine_calls.sites)
+	{
+		sorted.push_back(&it);
+		kind_calls[it.first.kind] += it.second.calls;
+		kind_ns[it.first.kind] += it.second.ns;
+		total_ns += it.second.ns;
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](auto a, auto b) { return a->second.ns > b->second.ns; });
+
+	const double frames = (double)engine_calls.frames;
+
+	gi.dprintf("%u frames, %.3f ms per frame in the engine\n", (uint32_t)engine_calls.frames, total_ns / 1e6 / frames);
+	gi.dprintf("%-14s %10s %10s\n", "call", "calls", "ms");
+
+	for (size_t i = 0; i < CALL_TOTAL; i++)
+		if (kind_calls[i])
+			gi.dprintf("%-14s %10.1f %10.3f\n", engine_call_names[i], kind_calls[i] / frames, kind_ns[i] / 1e6 / frames);
+
+	gi.dprintf("\n%-14s %8s %6s %8s %5s  %s\n", "call", "calls", "peak", "ms", "%", "site");
+
+	for (size_t i = 0; i < min(count, sorted.size()); i++)
+	{
+		const engine_call_key &key = sorted[i]->first;
+		const engine_call_site &site = sorted[i]->second;
+		stringlit file = key.file;
+
+		for (stringlit c = key.file; *c; c++)
+			if (*c == '/' || *c == '\\')
+				file = c + 1;
+
+		gi.dprintf("%-14s %8.1f %6u %8.3f %5.1f  %s:%u (%s)\n", engine_call_names[key.kind], site.calls / frames, site.peak_calls,
+			site.ns / 1e6 / frames, total_ns ? site.ns * 100.0 / total_ns : 0.0, file, key.line, site.function);
+	}
+}
+#else
+#define ENGINE_CALL(kind)
+#endif
+
 // fetch a model index from the specified sound file
 image_index game_import::imageindex(const stringref &name)
 {
 	return (image_index)impl.imageindex(name.ptr());
 }
 
+// traces go through here so a traceline isn't also counted as a trace
+static ::trace TraceImpl(vector start, vector mins, vector maxs, vector end, entityref passent, content_flags contentmask)
+{
+	::trace tr = impl.trace(&start.x, &mins.x, &maxs.x, &end.x, passent, contentmask);
+
+	if (tr.fraction == 1.0f && &tr.surface == nullptr)
+	{
+		gi.dprintf("Q2PRO runaway trace trapped, re-tracing...\n");
+		tr = impl.trace(&start.x, &mins.x, &maxs.x, &end.x, passent, contentmask);
+	}
+
+	return tr;
+}
+
+/*
+==============
+trace cache
+
+An opt-in memo of line and box traces for the current frame. Bots and
+radius damage ask the same questions of the world many times a frame;
+call sites that only need the result of the trace can use the _cached
+variants to get repeats answered without going to the engine.
+
+Everything is dropped at the start of each frame. The whole cache is also
+dropped by any link, unlink or setmodel that changes how an entity blocks
+traces: where it is, its bounds, solidity, angles or model. That is every
+cached trace, not just the ones the entity could have touched. Nothing
+else drops it. A solid, clipmask or owner change made without a link in
+between goes unnoticed, so call sites that can see one must not use the
+cache.
+==============
+*/
+
+// must be a power of two
+constexpr size_t TRACE_CACHE_SIZE = 1024;
+
+struct trace_cache_key
+{
+	vector			start, mins, maxs, end;
+	entityref		passent;
+	content_flags	contentmask;
+
+	bool operator==(const trace_cache_key &) const = default;
+};
+
+struct trace_cache_entry
+{
+	uint32_t		generation;
+	trace_cache_key	key;
+	::trace			result;
+};
+
+// how each entity was last linked, if it blocks traces. a brush model
+// can turn or change model without its abs bounds changing, so the
+// origin, angles and model are kept along with the bounds.
+struct trace_cache_link
+{
+	bool		blocks;
+	vector		absmin, absmax;
+	solidity	solid;
+	vector		origin, angles;
+	model_index	modelindex;
+};
+
+static struct
+{
+	bool								enabled;
+	// entries from any other generation are stale
+	uint32_t							generation = 1;
+	// allocated on first use; traces can't be built before the world is
+	dynarray<trace_cache_entry>			entries;
+	array<trace_cache_link, MAX_EDICTS>	links;
+
+	uint64_t	frames, lookups, hits, invalidations;
+} trace_cache;
+
+static size_t TraceCache_Hash(const trace_cache_key &key)
+{
+	uint32_t h = 2166136261u;
+
+	for (const vector *v : { &key.start, &key.mins, &key.maxs, &key.end })
+		for (size_t i = 0; i < 3; i++)
+			h = (h ^ std::bit_cast<uint32_t>((*v)[i])) * 16777619u;
+
+	h = (h ^ (key.passent.has_value() ? key.passent->s.number + 1 : 0)) * 16777619u;
+	h = (h ^ (uint32_t)key.contentmask) * 16777619u;
+
+	return h & (TRACE_CACHE_SIZE - 1);
+}
+
+static void TraceCache_Invalidate()
+{
+	if (!trace_cache.enabled)
+		return;
+
+	trace_cache.generation++;
+	trace_cache.invalidations++;
+}
+
+// called after every link, unlink and setmodel. if the entity now blocks
+// traces differently to how it did at its last link, every cached trace
+// is dropped, whether it went near the entity or not.
+static void TraceCache_Link(const entity &ent)
+{
+	trace_cache_link &link = trace_cache.links[ent.s.number];
+	const bool blocks = ent.is_linked() && (ent.solid == SOLID_BBOX || ent.solid == SOLID_BSP);
+
+	if (!blocks && !link.blocks)
+		return;
+
+	if (blocks && link.blocks && link.solid == ent.solid && link.absmin == ent.absmin && link.absmax == ent.absmax &&
+		link.origin == ent.s.origin && link.angles == ent.s.angles && link.modelindex == ent.s.modelindex)
+		return;
+
+	link = { blocks, ent.absmin, ent.absmax, ent.solid, ent.s.origin, ent.s.angles, ent.s.modelindex };
+	TraceCache_Invalidate();
+}
+
+// find the slot for key; a hit if it already holds this frame's result
+static trace_cache_entry *TraceCache_Find(const trace_cache_key &key, bool &hit)
+{
+	hit = false;
+
+	if (!trace_cache.enabled)
+		return nullptr;
+
+	trace_cache_entry &entry = trace_cache.entries[TraceCache_Hash(key)];
+
+	trace_cache.lookups++;
+
+	if (entry.generation == trace_cache.generation && entry.key == key)
+	{
+		trace_cache.hits++;
+		hit = true;
+	}
+
+	return &entry;
+}
+
+static ::trace TraceCache_Store(trace_cache_entry *entry, const trace_cache_key &key, const ::trace &result)
+{
+	if (entry)
+	{
+		entry->key = key;
+		entry->result = result;
+		entry->generation = trace_cache.generation;
+	}
+
+	return result;
+}
+
+void TraceCache_BeginFrame(bool enabled)
+{
+	trace_cache.enabled = enabled;
+	trace_cache.generation++;
+
+	if (!enabled)
+		return;
+
+	if (trace_cache.entries.empty())
+		trace_cache.entries.resize(TRACE_CACHE_SIZE);
+
+	trace_cache.frames++;
+}
+
+void TraceCache_Reset()
+{
+	trace_cache.frames = trace_cache.lookups = trace_cache.hits = trace_cache.invalidations = 0;
+}
+
+void TraceCache_Report()
+{
+	if (!trace_cache.frames)
+	{
+		gi.dprintf("tracecache: no frames recorded; set g_trace_cache 1\n");
+		return;
+	}
+
+	const double frames = (double)trace_cache.frames;
+
+	gi.dprintf("%u frames\n", (uint32_t)trace_cache.frames);
+	gi.dprintf("lookups per frame:       %.1f\n", trace_cache.lookups / frames);
+	gi.dprintf("hits per frame:          %.1f (%.1f%%)\n", trace_cache.hits / frames, trace_cache.lookups ? trace_cache.hits * 100.0 / trace_cache.lookups : 0.0);
+	gi.dprintf("invalidations per frame: %.1f\n", trace_cache.invalidations / frames);
+}
+
 // entities
 	
 // an entity will never be sent to a client or used for collision
 // if it is not passed to linkentity.  If the size, position, or
 // solidity changes, it must be relinked.
-void game_import::linkentity(entity &ent)
+void game_import::linkentity(entity &ent ENGINE_CALLER_PARAM)
 {
+	ENGINE_CALL(CALL_LINKENTITY);
 	impl.linkentity(&ent);
+	TraceCache_Link(ent);
+	Mirror_Update(ent);
 }
 // call before removing an interactive edict
-void game_import::unlinkentity(entity &ent)
+void game_import::unlinkentity(entity &ent ENGINE_CALLER_PARAM)
 {
+	ENGINE_CALL(CALL_UNLINKENTITY);
 	impl.unlinkentity(&ent);
+	TraceCache_Link(ent);
+	Mirror_Update(ent);
 }
 // return entities within the specified box
-dynarray<entityref> game_import::BoxEdicts(vector mins, vector maxs, box_edicts_area areatype, uint32_t allocate)
+dynarray<entityref> game_import::BoxEdicts(vector mins, vector maxs, box_edicts_area areatype, uint32_t allocate ENGINE_CALLER_PARAM)
 {
+	ENGINE_CALL(CALL_BOXEDICTS);
 	dynarray<entityref> ents;
 	ents.reserve(allocate);
 	size_t size;
@@ -239,44 +633,68 @@ dynarray<entityref> game_import::BoxEdicts(vector mins, vector maxs, box_edicts_
 	return dynarray<entityref>(ents.data(), ents.data() + size);
 }
 // player movement code common with client prediction
-void game_import::Pmove(pmove_t &pmove)
+void game_import::Pmove(pmove_t &pmove ENGINE_CALLER_PARAM)
 {
+	ENGINE_CALL(CALL_PMOVE);
 	impl.Pmove(&pmove);
 }
 
 // collision
 	
 // perform a line trace
-[[nodiscard]] trace game_import::traceline(vector start, vector end, entityref passent, content_flags contentmask)
+[[nodiscard]] trace game_import::traceline(vector start, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_PARAM)
 {
-	return trace(start, vec3_origin, vec3_origin, end, passent, contentmask);
+	ENGINE_CALL(CALL_TRACELINE);
+	return TraceImpl(start, vec3_origin, vec3_origin, end, passent, contentmask);
 }
 // perform a box trace
-[[nodiscard]] trace game_import::trace(vector start, vector mins, vector maxs, vector end, entityref passent, content_flags contentmask)
+[[nodiscard]] trace game_import::trace(vector start, vector mins, vector maxs, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_PARAM)
 {
-	::trace tr = impl.trace(&start.x, &mins.x, &maxs.x, &end.x, passent, contentmask);
+	ENGINE_CALL(CALL_TRACE);
+	return TraceImpl(start, mins, maxs, end, passent, contentmask);
+}
+// perform a line trace that may be answered from this frame's trace cache
+[[nodiscard]] trace game_import::traceline_cached(vector start, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_PARAM)
+{
+	const trace_cache_key key { start, vec3_origin, vec3_origin, end, passent, contentmask };
+	bool hit;
+	trace_cache_entry *entry = TraceCache_Find(key, hit);
 
-	if (tr.fraction == 1.0f && &tr.surface == nullptr)
-	{
-		gi.dprintf("Q2PRO runaway trace trapped, re-tracing...\n");
-		tr = impl.trace(&start.x, &mins.x, &maxs.x, &end.x, passent, contentmask);
-	}
+	if (hit)
+		return entry->result;
 
-	return tr;
+	ENGINE_CALL(CALL_TRACELINE);
+	return TraceCache_Store(entry, key, TraceImpl(start, vec3_origin, vec3_origin, end, passent, contentmask));
+}
+// perform a box trace that may be answered from this frame's trace cache
+[[nodiscard]] trace game_import::trace_cached(vector start, vector mins, vector maxs, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_PARAM)
+{
+	const trace_cache_key key { start, mins, maxs, end, passent, contentmask };
+	bool hit;
+	trace_cache_entry *entry = TraceCache_Find(key, hit);
+
+	if (hit)
+		return entry->result;
+
+	ENGINE_CALL(CALL_TRACE);
+	return TraceCache_Store(entry, key, TraceImpl(start, mins, maxs, end, passent, contentmask));
 }
 // fetch the brush contents at the specified point
-[[nodiscard]] content_flags game_import::pointcontents(vector point)
+[[nodiscard]] content_flags game_import::pointcontents(vector point ENGINE_CALLER_PARAM)
 {
+	ENGINE_CALL(CALL_POINTCONTENTS);
 	return (content_flags)impl.pointcontents(&point.x);
 }
 // check whether the two vectors are in the same PVS
-[[nodiscard]] bool game_import::inPVS(vector p1, vector p2)
+[[nodiscard]] bool game_import::inPVS(vector p1, vector p2 ENGINE_CALLER_PARAM)
 {
+	ENGINE_CALL(CALL_INPVS);
 	return impl.inPVS(&p1.x, &p2.x);
 }
 // check whether the two vectors are in the same PHS
-[[nodiscard]] bool game_import::inPHS(vector p1, vector p2)
+[[nodiscard]] bool game_import::inPHS(vector p1, vector p2 ENGINE_CALLER_PARAM)
 {
+	ENGINE_CALL(CALL_INPHS);
 	return impl.inPHS(&p1.x, &p2.x);
 }
 // set the state of the specified area portal
@@ -378,11 +796,15 @@ void game_import::configstring(config_string num, const stringref &string)
 	
 cvar &game_import::cvar_forceset(stringlit var_name, const stringref &value)
 {
-	return *impl.cvar_forceset(var_name, value.ptr());
+	::cvar &cv = *impl.cvar_forceset(var_name, value.ptr());
+	Cvar_Refresh(cv);
+	return cv;
 }
 cvar &game_import::cvar_set(stringlit var_name, const stringref &value)
 {
-	return *impl.cvar_set(var_name, value.ptr());
+	::cvar &cv = *impl.cvar_set(var_name, value.ptr());
+	Cvar_Refresh(cv);
+	return cv;
 }
 cvar &game_import::cvar(stringlit var_name, const stringref &value, cvar_flags flags)
 {
@@ -3,6 +3,18 @@
 #include "types.h"
 #include "dynarray.h"
 
+#ifdef ENGINE_CALL_STATS
+#include <source_location>
+
+// collision and linking calls are charged to the line that made them;
+// the default argument captures it without touching any call site.
+#define ENGINE_CALLER_DECL , const std::source_location &caller = std::source_location::current()
+#define ENGINE_CALLER_PARAM , const std::source_location &caller
+#else
+#define ENGINE_CALLER_DECL
+#define ENGINE_CALLER_PARAM
+#endif
+
 // impl passed from engine.
 extern "C" struct game_import_impl;
 
@@ -13,9 +25,6 @@ extern "C" struct game_import_impl;
 // max bytes in a single message packet
 constexpr size_t MESSAGE_LIMIT = 1400;
 
-// max size of a Quake path
-constexpr size_t MAX_QPATH = 64;
-
 #include "config_string.h"
 #include "multicast_destination.h"
 #include "box_edicts_area.h"
@@ -480,6 +489,12 @@ struct game_import
 	// center print; prints on center of screen to client
 	void centerprintf(const entity &ent, stringlit fmt, ...);
 
+	// the above, for text that's already formatted
+	void bprint(print_level printlevel, stringlit text);
+	void dprint(stringlit text);
+	void cprint(const entity &ent, print_level printlevel, stringlit text);
+	void centerprint(const entity &ent, stringlit text);
+
 	// sounds
 
 	// fetch a sound index from the specified sound file
@@ -509,26 +524,32 @@ struct game_import
 	// an entity will never be sent to a client or used for collision
 	// if it is not passed to linkentity.  If the size, position, or
 	// solidity changes, it must be relinked.
-	void linkentity(entity &ent);
+	void linkentity(entity &ent ENGINE_CALLER_DECL);
 	// call before removing an interactive edict
-	void unlinkentity(entity &ent);
+	void unlinkentity(entity &ent ENGINE_CALLER_DECL);
 	// return entities within the specified box
-	dynarray<entityref> BoxEdicts(vector mins, vector maxs, box_edicts_area areatype, uint32_t allocate = 16);
+	dynarray<entityref> BoxEdicts(vector mins, vector maxs, box_edicts_area areatype, uint32_t allocate = 16 ENGINE_CALLER_DECL);
 	// player movement code common with client prediction
-	void Pmove(pmove_t &pmove);
+	void Pmove(pmove_t &pmove ENGINE_CALLER_DECL);
 
 	// collision
 	
 	// perform a line trace
-	[[nodiscard]] trace traceline(vector start, vector end, entityref passent, content_flags contentmask);
+	[[nodiscard]] trace traceline(vector start, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_DECL);
 	// perform a box trace
-	[[nodiscard]] trace trace(vector start, vector mins, vector maxs, vector end, entityref passent, content_flags contentmask);
+	[[nodiscard]] trace trace(vector start, vector mins, vector maxs, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_DECL);
+	// perform a line trace that may be answered from this frame's trace cache.
+	// only for call sites that need nothing from it but the result.
+	[[nodiscard]] ::trace traceline_cached(vector start, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_DECL);
+	// perform a box trace that may be answered from this frame's trace cache.
+	// only for call sites that need nothing from it but the result.
+	[[nodiscard]] ::trace trace_cached(vector start, vector mins, vector maxs, vector end, entityref passent, content_flags contentmask ENGINE_CALLER_DECL);
 	// fetch the brush contents at the specified point
-	[[nodiscard]] content_flags pointcontents(vector point);
+	[[nodiscard]] content_flags pointcontents(vector point ENGINE_CALLER_DECL);
 	// check whether the two vectors are in the same PVS
-	[[nodiscard]] bool inPVS(vector p1, vector p2);
+	[[nodiscard]] bool inPVS(vector p1, vector p2 ENGINE_CALLER_DECL);
 	// check whether the two vectors are in the same PHS
-	[[nodiscard]] bool inPHS(vector p1, vector p2);
+	[[nodiscard]] bool inPHS(vector p1, vector p2 ENGINE_CALLER_DECL);
 	// set the state of the specified area portal
 	void SetAreaPortalState(int32_t portalnum, bool open);
 	// check whether the two area indices are connected to each other
@@ -592,4 +613,25 @@ struct game_import
 	[[noreturn]] void error(stringlit fmt, ...);
 };
 
-extern game_import gi;
\ No newline at end of file
+extern game_import gi;
+
+// start a new frame of the trace cache, dropping last frame's traces.
+// while disabled, the _cached traces go straight to the engine.
+void TraceCache_BeginFrame(bool enabled);
+
+// clear the trace cache's hit counters
+void TraceCache_Reset();
+
+// print the trace cache's hit rates
+void TraceCache_Report();
+
+#ifdef ENGINE_CALL_STATS
+// close out the current frame's engine call accounting
+void EngineCalls_EndFrame();
+
+// forget all recorded call sites
+void EngineCalls_Reset();
+
+// print the call sites that spent the most time in the engine per frame
+void EngineCalls_Report(size_t count);
+#endif
@@ -1,5 +1,119 @@
 #include "info.h"
 
+static constexpr bool Info_IllegalChar(const char &c)
+{
+	return (c & 128) || !isprint(c) || c == '\"' || c == ';';
+}
+
+info_tokenizer::info_tokenizer(stringlit s) :
+	s(s ? s : "")
+{
+}
+
+bool info_tokenizer::next(info_pair &pair)
+{
+	if (done)
+		return false;
+
+	//
+	// key
+	//
+	if (s[offset] == '\\')
+	{
+		if (++total == MAX_INFO_STRING)
+			ok = false;   // oversize infostring
+
+		offset++;
+	}
+
+	if (!s[offset])
+	{
+		ok = false;   // missing key
+		done = true;
+		return false;
+	}
+
+	size_t start = offset, len = 0;
+
+	while (s[offset] && s[offset] != '\\')
+	{
+		const char c = s[offset++];
+
+		if (Info_IllegalChar(c))
+			ok = false;   // illegal characters
+		else if (++len == MAX_INFO_KEY)
+			ok = false;   // oversize key
+		else if (++total == MAX_INFO_STRING)
+			ok = false;   // oversize infostring
+	}
+
+	if (!s[offset])
+	{
+		ok = false;   // missing value
+		done = true;
+		return false;
+	}
+
+	pair.key = { s + start, offset - start };
+
+	//
+	// value
+	//
+	offset++;
+
+	if (++total == MAX_INFO_STRING)
+		ok = false;   // oversize infostring
+
+	start = offset;
+	len = 0;
+
+	if (!s[offset])
+		ok = false;   // missing value
+
+	while (s[offset] && s[offset] != '\\')
+	{
+		const char c = s[offset++];
+
+		if (Info_IllegalChar(c))
+			ok = false;   // illegal characters
+		else if (++len == MAX_INFO_VALUE)
+			ok = false;   // oversize value
+		else if (++total == MAX_INFO_STRING)
+			ok = false;   // oversize infostring
+	}
+
+	pair.value = { s + start, offset - start };
+
+	// end of string
+	if (!s[offset])
+		done = true;
+
+	return true;
+}
+
+template<typename T>
+static T Info_Number(const std::string_view &value, T (*parse)(stringlit))
+{
+	array<char, MAX_INFO_VALUE> buffer;
+	const size_t len = min(value.size(), buffer.size() - 1);
+
+	if (len)
+		memcpy(buffer.data(), value.data(), len);
+	buffer[len] = 0;
+
+	return parse(buffer.data());
+}
+
+float Info_Float(const std::string_view &value)
+{
+	return (float)Info_Number<double>(value, [](stringlit s) { return atof(s); });
+}
+
+int32_t Info_Int(const std::string_view &value)
+{
+	return Info_Number<int32_t>(value, [](stringlit s) { return (int32_t)atoi(s); });
+}
+
 /*
 ===============
 Info_ValueForKey
@@ -10,26 +124,42 @@ key and returns the associated value, or an empty string.
 */
 string Info_ValueForKey(const stringref &s, stringlit key)
 {
-	string key_string = va("\\%s\\", key);
-	size_t key_start = strstr(s, key_string);
-	
-	if (key_start == -1)
-		return "";
+	info_tokenizer tokens(s.ptr());
+	info_pair pair;
+
+	while (tokens.next(pair))
+		if (pair.key == key)
+			return Info_String(pair.value);
+
+	return "";
+};
+
+// write s out without any pair with the given key, and return how long
+// that is; out can be null to only measure it
+static size_t Info_Rebuild(stringlit s, stringlit key, char *out)
+{
+	info_tokenizer tokens(s);
+	info_pair pair;
+	size_t length = 0;
 
-	size_t value_start = key_start + strlen(key_string), value_end = value_start + 1;
-	
-	while (true)
+	while (tokens.next(pair))
 	{
-		char c = s[value_end];
-		
-		if (c == '\\' || !c)
-			break;
-		
-		value_end++;
+		if (pair.key == key)
+			continue;
+
+		if (out)
+		{
+			out[length] = '\\';
+			memcpy(out + length + 1, pair.key.data(), pair.key.size());
+			out[length + 1 + pair.key.size()] = '\\';
+			memcpy(out + length + 2 + pair.key.size(), pair.value.data(), pair.value.size());
+		}
+
+		length += pair.key.size() + pair.value.size() + 2;
 	}
 
-	return substr(s, value_start, value_end - value_start);
-};
+	return length;
+}
 
 /*
 ==================
@@ -38,34 +168,18 @@ Info_RemoveKey
 */
 string Info_RemoveKey(const stringref &s, stringlit key)
 {
-	string result = s;
-	string key_string = va("\\%s\\", key);
-	
-	size_t key_start;
-	while ((key_start = strstr(result, key_string)) != -1)
-	{
-		size_t value_end = key_start + strlen(key_string) + 1;
-		
-		while (true)
-		{
-			char c = result[value_end];
-			
-			if (c == '\\' || !c)
-				break;
-			
-			value_end++;
-		}
-		
-		string left = "", right = "";
-		
-		if (key_start != 0)
-			left = substr(result, 0, key_start);
-		if (value_end != strlen(result))
-			right = substr(result, value_end, strlen(result) - value_end);
-		
-		result = strconcat(left, right);
-	}
-	
+	// one walk to size it, one to fill it in
+	const size_t length = Info_Rebuild(s.ptr(), key, nullptr);
+
+	if (!length)
+		return "";
+
+	string result(length);
+	char *out = const_cast<char *>(result.ptr());
+
+	Info_Rebuild(s.ptr(), key, out);
+	out[length] = 0;
+
 	return result;
 }
 
@@ -80,62 +194,12 @@ Also checks the length of keys/values and the whole string.
 */
 bool Info_Validate(const stringref &s)
 {
-	size_t total = 0, offset = 0;
-
-	while (1)
-	{
-		//
-		// validate key
-		//
-		if (s[offset] == '\\')
-		{
-			if (++total == MAX_INFO_STRING)
-				return false;   // oversize infostring
+	info_tokenizer tokens(s.ptr());
+	info_pair pair;
 
-			offset++;
-		}
-		if (!s[offset])
-			return false;   // missing key
-
-		int len = 0;
-		while (s[offset] != '\\')
-		{
-			char c = s[offset++];
-			if (c & 128 || !isprint(c) || c == '\"' || c == ';')
-				return false;   // illegal characters
-			else if (++len == MAX_INFO_KEY)
-				return false;   // oversize key
-			else if (++total == MAX_INFO_STRING)
-				return false;   // oversize infostring
-			else if (!s[offset])
-				return false;   // missing value
-		}
+	while (tokens.valid() && tokens.next(pair)) ;
 
-		//
-		// validate value
-		//
-		offset++;
-		if (++total == MAX_INFO_STRING)
-			return false;   // oversize infostring
-		if (!s[offset])
-			return false;   // missing value
-
-		len = 0;
-		while (s[offset] != '\\')
-		{
-			int c = s[offset++];
-			if (c & 128 || !isprint(c) || c == '\"' || c == ';')
-				return false;   // illegal characters
-			else if (++len == MAX_INFO_VALUE)
-				return false;   // oversize value
-			else if (++total == MAX_INFO_STRING)
-				return false;   // oversize infostring
-			else if (!s[offset])
-				return true;    // end of string
-		}
-	}
-	
-	return true;
+	return tokens.valid();
 }
 
 /*
@@ -176,14 +240,27 @@ bool Info_SetValueForKey(string &s, stringlit key, stringlit value)
 	if (vl >= MAX_QPATH)
 		return false;
 
-	s = Info_RemoveKey(s, key);
-	if (!vl)
-		return true;
+	// drop the old value and append the new one in a single copy
+	const size_t l = Info_Rebuild(s.ptr(), key, nullptr);
 
-	size_t l = strlen(s);
-	if (l + kl + vl + 2 >= MAX_INFO_STRING)
-		return false;
-	
-	s = strconcat(s, "\\", key, "\\", value);
+	if (!vl || l + kl + vl + 2 >= MAX_INFO_STRING)
+	{
+		s = Info_RemoveKey(s, key);
+		return !vl;
+	}
+
+	string result(l + kl + vl + 2);
+	char *out = const_cast<char *>(result.ptr());
+
+	Info_Rebuild(s.ptr(), key, out);
+	out += l;
+	*out++ = '\\';
+	memcpy(out, key, kl);
+	out += kl;
+	*out++ = '\\';
+	memcpy(out, value, vl);
+	out[vl] = 0;
+
+	s = result;
 	return true;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gi.h"
+#include <string_view>
 
 constexpr bool isprint(const char &c)
 {
@@ -11,6 +12,53 @@ constexpr size_t MAX_INFO_KEY		= 64;
 constexpr size_t MAX_INFO_VALUE	= 64;
 constexpr size_t MAX_INFO_STRING	= 512;
 
+// one key/value pair of an info string; both point into the string
+struct info_pair
+{
+	std::string_view	key, value;
+};
+
+/*
+===============
+info_tokenizer
+
+Walks an info string once, handing out each key/value pair as views into
+the string without copying anything. It checks the string against the
+same rules as Info_Validate as it goes, so a single walk both reads and
+validates it.
+===============
+*/
+class info_tokenizer
+{
+	stringlit	s;
+	size_t		offset = 0;
+	size_t		total = 0;
+	bool		ok = true;
+	bool		done = false;
+
+public:
+	explicit info_tokenizer(stringlit s);
+
+	// fetch the next pair; false once the string is used up
+	bool next(info_pair &pair);
+
+	// whether everything walked so far is valid. once next() has
+	// returned false, this is what Info_Validate would return.
+	bool valid() const { return ok; }
+};
+
+// copy an info value out into a string
+inline string Info_String(const std::string_view &value)
+{
+	return value.empty() ? string() : string(value.data(), 0, value.size());
+}
+
+// read an info value as a number, the way atof would
+float Info_Float(const std::string_view &value);
+
+// read an info value as a number, the way atoi would
+int32_t Info_Int(const std::string_view &value);
+
 /*
 ===============
 Info_ValueForKey
@@ -1,48 +1,109 @@
 #include "random.h"
+#include "gi.h"
 #include <random>
+#include <chrono>
 #include <ctime>
 
-static std::mt19937 gen((uint32_t)time(nullptr));
+// the stream numbers Q_srand gives each stream
+enum rng_stream_id : uint64_t
+{
+	RNG_GAMEPLAY,
+	RNG_EFFECTS,
+	RNG_BOTS
+};
+
+rng_stream rng_gameplay((uint64_t)time(nullptr), RNG_GAMEPLAY);
+rng_stream rng_effects((uint64_t)time(nullptr), RNG_EFFECTS);
+rng_stream rng_bots((uint64_t)time(nullptr), RNG_BOTS);
 
-uint32_t Q_rand()
+// splitmix64, which spreads even a small seed across
+// all of xoshiro's state
+static uint64_t SplitMix64(uint64_t &state)
 {
-	return gen();
+	uint64_t z = (state += 0x9E3779B97F4A7C15);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+	return z ^ (z >> 31);
 }
 
-uint32_t Q_rand_uniform(const uint32_t &max)
+void rng_stream::seed(uint64_t seed, uint64_t stream)
 {
-	if (max <= 1)
-		return 0;
+	uint64_t state = seed ^ (stream * 0xD1B54A32D192ED03);
 
-	return std::uniform_int_distribution<uint32_t>(0, max - 1)(gen);
-}
+	const uint64_t a = SplitMix64(state), b = SplitMix64(state);
 
-float random()
-{
-	return std::uniform_real_distribution<float>()(gen);
+	s = { (uint32_t)a, (uint32_t)(a >> 32), (uint32_t)b, (uint32_t)(b >> 32) };
+
+	// all-zero state is the one xoshiro can't leave
+	if (!(s[0] | s[1] | s[2] | s[3]))
+		s[0] = 1;
 }
 
-float random(const float &max)
+void Q_srand(uint32_t seed)
 {
-	return std::uniform_real_distribution<float>(0.f, max)(gen);
+	rng_gameplay.seed(seed, RNG_GAMEPLAY);
+	rng_effects.seed(seed, RNG_EFFECTS);
+	rng_bots.seed(seed, RNG_BOTS);
 }
 
-float random(const float &min, const float &max)
+vector randomv(rng_stream &rng)
 {
-	return std::uniform_real_distribution<float>(min, max)(gen);
+	return { rng.random(), rng.random(), rng.random() };
 }
 
-vector randomv()
+vector randomv(const vector &max, rng_stream &rng)
 {
-	return { random(), random(), random() };
+	return { rng.random(max.x), rng.random(max.y), rng.random(max.z) };
 }
 
-vector randomv(const vector &max)
+vector randomv(const vector &min, const vector &max, rng_stream &rng)
 {
-	return { random(max), random(max), random(max) };
+	return { rng.random(min.x, max.x), rng.random(min.y, max.y), rng.random(min.z, max.z) };
 }
 
-vector randomv(const vector &min, const vector &max)
+void BenchmarkRandom(size_t count)
 {
-	return { random(min, max), random(min, max), random(min, max) };
-}
\ No newline at end of file
+	using clock = std::chrono::steady_clock;
+
+	std::mt19937 mt(1);
+	rng_stream rng(1);
+
+	// sums keep the loops from being optimized away
+	uint64_t int_sum[2] = {};
+	double float_sum[2] = {};
+
+	auto ns_per = [count](clock::time_point start) {
+		return std::chrono::duration<double, std::nano>(clock::now() - start).count() / count;
+	};
+
+	// bounded ints, with a bound that isn't a power of two
+	// so the distributions have rejection work to do
+	constexpr uint32_t bound = 1000;
+
+	auto start = clock::now();
+	for (size_t i = 0; i < count; i++)
+		int_sum[0] += std::uniform_int_distribution<uint32_t>(0, bound - 1)(mt);
+	const double mt_int = ns_per(start);
+
+	start = clock::now();
+	for (size_t i = 0; i < count; i++)
+		int_sum[1] += rng.uniform(bound);
+	const double rng_int = ns_per(start);
+
+	start = clock::now();
+	for (size_t i = 0; i < count; i++)
+		float_sum[0] += std::uniform_real_distribution<float>(-1.f, 1.f)(mt);
+	const double mt_float = ns_per(start);
+
+	start = clock::now();
+	for (size_t i = 0; i < count; i++)
+		float_sum[1] += rng.random(-1.f, 1.f);
+	const double rng_float = ns_per(start);
+
+	gi.dprintf("random, %u draws each; ns per draw (mean of draws)\n", (uint32_t)count);
+	gi.dprintf("%-10s %8s %8s\n", "", "mt19937", "xoshiro");
+	gi.dprintf("%-10s %8.2f %8.2f   (%.1f, %.1f; expect %.1f)\n", "int<1000", mt_int, rng_int,
+		(double)int_sum[0] / count, (double)int_sum[1] / count, (bound - 1) / 2.0);
+	gi.dprintf("%-10s %8.2f %8.2f   (%.3f, %.3f; expect 0)\n", "float", mt_float, rng_float,
+		float_sum[0] / count, float_sum[1] / count);
+}
@@ -1,42 +1,160 @@
 #pragma once
 
 #include "types.h"
+#include <bit>
 
 // randomness!
 
+/*
+random streams
+
+Each stream is its own xoshiro128** generator: 16 bytes of state and a
+handful of shifts and xors per number. Gameplay, effects and bots draw
+from separate streams so that, for instance, how many gibs a death
+throws can't change where the next shotgun pellet lands, and a level's
+seed reproduces all three.
+*/
+class rng_stream
+{
+	array<uint32_t, 4>	s;
+
+public:
+	explicit rng_stream(uint64_t seed = 0, uint64_t stream = 0)
+	{
+		this->seed(seed, stream);
+	}
+
+	// reseed; different stream numbers with the same seed
+	// give unrelated sequences
+	void seed(uint64_t seed, uint64_t stream = 0);
+
+	// return a random unsigned integer between [0, UINT_MAX], inclusive
+	inline uint32_t operator()()
+	{
+		const uint32_t result = std::rotl(s[1] * 5, 7) * 9;
+		const uint32_t t = s[1] << 9;
+
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = std::rotl(s[3], 11);
+
+		return result;
+	}
+
+	// return a random unsigned integer between [0, max), exclusive,
+	// without modulo bias. if max is zero, always returns 0.
+	inline uint32_t uniform(uint32_t max)
+	{
+		if (max <= 1)
+			return 0;
+
+		// Lemire's multiply-and-shift; only the rare draws that
+		// land in the short leftover range are rejected
+		uint64_t m = (uint64_t)(*this)() * max;
+
+		if ((uint32_t)m < max)
+		{
+			const uint32_t threshold = (0u - max) % max;
+
+			while ((uint32_t)m < threshold)
+				m = (uint64_t)(*this)() * max;
+		}
+
+		return (uint32_t)(m >> 32);
+	}
+
+	// return a random float between [0, 1), exclusive
+	inline float random()
+	{
+		// 24 bits is all a float's mantissa holds
+		return ((*this)() >> 8) * (1.f / (1 << 24));
+	}
+
+	// return a random float between [0, max), exclusive
+	inline float random(const float &max)
+	{
+		return random() * max;
+	}
+
+	// return a random float between [min, max), exclusive
+	inline float random(const float &min, const float &max)
+	{
+		return min + random() * (max - min);
+	}
+
+	// return a random float between [-1, 1), exclusive
+	inline float crandom()
+	{
+		return random(-1.f, 1.f);
+	}
+};
+
+// the streams; Q_srand seeds them all
+extern rng_stream rng_gameplay;
+extern rng_stream rng_effects;
+extern rng_stream rng_bots;
+
+// reseed the generators; levels are seeded through this so
+// that replays can reproduce them
+void Q_srand(uint32_t seed);
+
+// the functions below all draw from the gameplay stream
+
 // return a random unsigned integer between [0, UINT_MAX], inclusive
-uint32_t Q_rand();
+inline uint32_t Q_rand()
+{
+	return rng_gameplay();
+}
 
 // return a random unsigned integer between [0, max), exclusive.
 // if max is zero, always returns 0.
-uint32_t Q_rand_uniform(const uint32_t &max);
+inline uint32_t Q_rand_uniform(const uint32_t &max)
+{
+	return rng_gameplay.uniform(max);
+}
 
 // return a random float between [0, 1), exclusive
-float random();
+inline float random()
+{
+	return rng_gameplay.random();
+}
 
 // return a random float between [0, max), exclusive
-float random(const float &max);
+inline float random(const float &max)
+{
+	return rng_gameplay.random(max);
+}
 
 // return a random float between [min, max), exclusive
-float random(const float &min, const float &max);
+inline float random(const float &min, const float &max)
+{
+	return rng_gameplay.random(min, max);
+}
 
 #include "vector.h"
 
 // return a random vector between [0, 1), exclusive
-vector randomv();
+vector randomv(rng_stream &rng = rng_gameplay);
 
 // return a random vector between [0, max), exclusive
-vector randomv(const vector &max);
+vector randomv(const vector &max, rng_stream &rng = rng_gameplay);
 
 // return a random vector between [min, max), exclusive
-vector randomv(const vector &min, const vector &max);
+vector randomv(const vector &min, const vector &max, rng_stream &rng = rng_gameplay);
 
 inline float crandom()
 {
 	return random(-1.f, 1.f);
 }
 
-inline vector crandomv()
+inline vector crandomv(rng_stream &rng = rng_gameplay)
 {
-	return randomv({ -1, -1, -1 }, { 1, 1, 1 });
-}
\ No newline at end of file
+	return randomv({ -1, -1, -1 }, { 1, 1, 1 }, rng);
+}
+
+// time the streams against std::mt19937 and the
+// standard distributions, over count numbers each
+void BenchmarkRandom(size_t count);
@@ -7,4 +7,11 @@ trace::trace() :
 	contents(CONTENTS_NONE),
 	ent(world)
 {
+}
+
+trace::trace(const ::surface &surf, entity &hit) :
+	surface(surf),
+	contents(CONTENTS_NONE),
+	ent(hit)
+{
 }
\ No newline at end of file
@@ -9,6 +9,9 @@ struct entity;
 struct trace
 {
 	trace();
+	// a trace that hit nothing, but reports the given surface and entity;
+	// for rebuilding traces that were logged by number
+	trace(const ::surface &surf, entity &hit);
 	trace(const trace &tr) :
 		allsolid(tr.allsolid),
 		startsolid(tr.startsolid),
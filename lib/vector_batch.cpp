@@ -0,0 +1,404 @@
+#include "vector_batch.h"
+#include "dynarray.h"
+#include "gi.h"
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+#if defined(SIMD_VECTORS) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#define VECTOR_BATCH_SSE2
+#include <emmintrin.h>
+#elif defined(SIMD_VECTORS) && (defined(_M_ARM64) || (defined(__ARM_NEON) && defined(__aarch64__)))
+#define VECTOR_BATCH_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+==============
+scalar kernels
+
+These are the reference versions; the SIMD kernels run them over
+whatever doesn't fill a group of four, and benchvec checks against them.
+==============
+*/
+static void DistanceSquared_Scalar(const vector_lanes &v, const vector &point, float *out, size_t i)
+{
+	for (; i < v.count; i++)
+		out[i] = (point - vector { v.x[i], v.y[i], v.z[i] }).LengthSquared();
+}
+
+static size_t FindInRadius_Scalar(const vector_lanes &v, const vector &point, const float &radius, const bool &ignore_height, size_t i)
+{
+	for (; i < v.count; i++)
+	{
+		vector eorg = point - vector { v.x[i], v.y[i], v.z[i] };
+
+		if (ignore_height)
+			eorg.z = 0;
+
+		if (VectorLength(eorg) > radius)
+			continue;
+
+		return i;
+	}
+
+	return v.count;
+}
+
+static size_t BoxesOverlap_Scalar(const vector_lanes &mins, const vector_lanes &maxs, const vector &box_mins, const vector &box_maxs, uint8_t *overlaps, size_t i)
+{
+	size_t num = 0;
+
+	for (; i < mins.count; i++)
+	{
+		overlaps[i] = !(mins.x[i] >= box_maxs.x
+			|| mins.y[i] >= box_maxs.y
+			|| mins.z[i] >= box_maxs.z
+			|| maxs.x[i] <= box_mins.x
+			|| maxs.y[i] <= box_mins.y
+			|| maxs.z[i] <= box_mins.z);
+		num += overlaps[i];
+	}
+
+	return num;
+}
+
+static void Normalize_Scalar(const vector_lanes &v, float *lengths, size_t i)
+{
+	for (; i < v.count; i++)
+	{
+		vector n { v.x[i], v.y[i], v.z[i] };
+		const float length = n.Normalize();
+
+		v.x[i] = n.x;
+		v.y[i] = n.y;
+		v.z[i] = n.z;
+
+		if (lengths)
+			lengths[i] = length;
+	}
+}
+
+/*
+==============
+four-lane operations
+
+Just enough of SSE2 and NEON behind one set of names that each kernel
+is only written once.
+==============
+*/
+#if defined(VECTOR_BATCH_SSE2)
+#define VECTOR_BATCH_LANES
+
+using lane4 = __m128;
+using mask4 = __m128;
+
+static inline lane4 Lane_Load(const float *p) { return _mm_loadu_ps(p); }
+static inline void Lane_Store(float *p, const lane4 &v) { _mm_storeu_ps(p, v); }
+static inline lane4 Lane_Splat(const float &f) { return _mm_set1_ps(f); }
+static inline lane4 Lane_Add(const lane4 &a, const lane4 &b) { return _mm_add_ps(a, b); }
+static inline lane4 Lane_Sub(const lane4 &a, const lane4 &b) { return _mm_sub_ps(a, b); }
+static inline lane4 Lane_Mul(const lane4 &a, const lane4 &b) { return _mm_mul_ps(a, b); }
+static inline lane4 Lane_Div(const lane4 &a, const lane4 &b) { return _mm_div_ps(a, b); }
+static inline lane4 Lane_Sqrt(const lane4 &a) { return _mm_sqrt_ps(a); }
+static inline mask4 Lane_Greater(const lane4 &a, const lane4 &b) { return _mm_cmpgt_ps(a, b); }
+static inline mask4 Lane_GreaterEqual(const lane4 &a, const lane4 &b) { return _mm_cmpge_ps(a, b); }
+static inline mask4 Lane_LessEqual(const lane4 &a, const lane4 &b) { return _mm_cmple_ps(a, b); }
+// true for NaN as well, like a float's truthiness
+static inline mask4 Lane_NonZero(const lane4 &a) { return _mm_cmpneq_ps(a, _mm_setzero_ps()); }
+static inline mask4 Mask_Or(const mask4 &a, const mask4 &b) { return _mm_or_ps(a, b); }
+static inline lane4 Mask_Select(const mask4 &m, const lane4 &a, const lane4 &b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+// one bit per lane, lane 0 in bit 0
+static inline uint32_t Mask_Bits(const mask4 &m) { return (uint32_t)_mm_movemask_ps(m); }
+
+#elif defined(VECTOR_BATCH_NEON)
+#define VECTOR_BATCH_LANES
+
+using lane4 = float32x4_t;
+using mask4 = uint32x4_t;
+
+static inline lane4 Lane_Load(const float *p) { return vld1q_f32(p); }
+static inline void Lane_Store(float *p, const lane4 &v) { vst1q_f32(p, v); }
+static inline lane4 Lane_Splat(const float &f) { return vdupq_n_f32(f); }
+static inline lane4 Lane_Add(const lane4 &a, const lane4 &b) { return vaddq_f32(a, b); }
+static inline lane4 Lane_Sub(const lane4 &a, const lane4 &b) { return vsubq_f32(a, b); }
+static inline lane4 Lane_Mul(const lane4 &a, const lane4 &b) { return vmulq_f32(a, b); }
+static inline lane4 Lane_Div(const lane4 &a, const lane4 &b) { return vdivq_f32(a, b); }
+static inline lane4 Lane_Sqrt(const lane4 &a) { return vsqrtq_f32(a); }
+static inline mask4 Lane_Greater(const lane4 &a, const lane4 &b) { return vcgtq_f32(a, b); }
+static inline mask4 Lane_GreaterEqual(const lane4 &a, const lane4 &b) { return vcgeq_f32(a, b); }
+static inline mask4 Lane_LessEqual(const lane4 &a, const lane4 &b) { return vcleq_f32(a, b); }
+// true for NaN as well, like a float's truthiness
+static inline mask4 Lane_NonZero(const lane4 &a) { return vmvnq_u32(vceqq_f32(a, vdupq_n_f32(0))); }
+static inline mask4 Mask_Or(const mask4 &a, const mask4 &b) { return vorrq_u32(a, b); }
+static inline lane4 Mask_Select(const mask4 &m, const lane4 &a, const lane4 &b) { return vbslq_f32(m, a, b); }
+// one bit per lane, lane 0 in bit 0
+static inline uint32_t Mask_Bits(const mask4 &m)
+{
+	static constexpr uint32_t weights[4] = { 1, 2, 4, 8 };
+	return vaddvq_u32(vandq_u32(m, vld1q_u32(weights)));
+}
+#endif
+
+/*
+==============
+kernels
+==============
+*/
+void VectorBatch_DistanceSquared(const vector_lanes &v, const vector &point, float *out)
+{
+	size_t i = 0;
+
+#ifdef VECTOR_BATCH_LANES
+	const lane4 px = Lane_Splat(point.x), py = Lane_Splat(point.y), pz = Lane_Splat(point.z);
+
+	for (; i + 4 <= v.count; i += 4)
+	{
+		const lane4 dx = Lane_Sub(px, Lane_Load(v.x + i));
+		const lane4 dy = Lane_Sub(py, Lane_Load(v.y + i));
+		const lane4 dz = Lane_Sub(pz, Lane_Load(v.z + i));
+
+		Lane_Store(out + i, Lane_Add(Lane_Add(Lane_Mul(dx, dx), Lane_Mul(dy, dy)), Lane_Mul(dz, dz)));
+	}
+#endif
+
+	DistanceSquared_Scalar(v, point, out, i);
+}
+
+size_t VectorBatch_FindInRadius(const vector_lanes &v, const vector &point, const float &radius, const bool &ignore_height)
+{
+	size_t i = 0;
+
+#ifdef VECTOR_BATCH_LANES
+	const lane4 px = Lane_Splat(point.x), py = Lane_Splat(point.y), pz = Lane_Splat(point.z);
+	const lane4 r = Lane_Splat(radius);
+
+	for (; i + 4 <= v.count; i += 4)
+	{
+		const lane4 dx = Lane_Sub(px, Lane_Load(v.x + i));
+		const lane4 dy = Lane_Sub(py, Lane_Load(v.y + i));
+		lane4 d = Lane_Add(Lane_Mul(dx, dx), Lane_Mul(dy, dy));
+
+		// a zeroed z adds +0, which never changes the sum
+		if (!ignore_height)
+		{
+			const lane4 dz = Lane_Sub(pz, Lane_Load(v.z + i));
+			d = Lane_Add(d, Lane_Mul(dz, dz));
+		}
+
+		// the scalar test is "skip if length > radius", so
+		// anything that isn't greater (NaN included) is a hit
+		const uint32_t hits = ~Mask_Bits(Lane_Greater(Lane_Sqrt(d), r)) & 15;
+
+		if (hits)
+			return i + std::countr_zero(hits);
+	}
+#endif
+
+	return FindInRadius_Scalar(v, point, radius, ignore_height, i);
+}
+
+size_t VectorBatch_BoxesOverlap(const vector_lanes &mins, const vector_lanes &maxs, const vector &box_mins, const vector &box_maxs, uint8_t *overlaps)
+{
+	size_t i = 0, num = 0;
+
+#ifdef VECTOR_BATCH_LANES
+	const lane4 bminx = Lane_Splat(box_mins.x), bminy = Lane_Splat(box_mins.y), bminz = Lane_Splat(box_mins.z);
+	const lane4 bmaxx = Lane_Splat(box_maxs.x), bmaxy = Lane_Splat(box_maxs.y), bmaxz = Lane_Splat(box_maxs.z);
+
+	for (; i + 4 <= mins.count; i += 4)
+	{
+		const mask4 apart = Mask_Or(
+			Mask_Or(
+				Mask_Or(Lane_GreaterEqual(Lane_Load(mins.x + i), bmaxx), Lane_GreaterEqual(Lane_Load(mins.y + i), bmaxy)),
+				Mask_Or(Lane_GreaterEqual(Lane_Load(mins.z + i), bmaxz), Lane_LessEqual(Lane_Load(maxs.x + i), bminx))),
+			Mask_Or(Lane_LessEqual(Lane_Load(maxs.y + i), bminy), Lane_LessEqual(Lane_Load(maxs.z + i), bminz)));
+		const uint32_t hits = ~Mask_Bits(apart) & 15;
+
+		for (size_t l = 0; l < 4; l++)
+			overlaps[i + l] = (hits >> l) & 1;
+
+		num += std::popcount(hits);
+	}
+#endif
+
+	return num + BoxesOverlap_Scalar(mins, maxs, box_mins, box_maxs, overlaps, i);
+}
+
+void VectorBatch_Normalize(const vector_lanes &v, float *lengths)
+{
+	size_t i = 0;
+
+#ifdef VECTOR_BATCH_LANES
+	const lane4 one = Lane_Splat(1.f);
+
+	for (; i + 4 <= v.count; i += 4)
+	{
+		const lane4 x = Lane_Load(v.x + i), y = Lane_Load(v.y + i), z = Lane_Load(v.z + i);
+		const lane4 length_sq = Lane_Add(Lane_Add(Lane_Mul(x, x), Lane_Mul(y, y)), Lane_Mul(z, z));
+		const lane4 length = Lane_Sqrt(length_sq);
+		const lane4 scale = Lane_Div(one, length);
+
+		// zero vectors are left alone, and their length is sqrt(0)
+		const mask4 nonzero = Lane_NonZero(length_sq);
+
+		Lane_Store(v.x + i, Mask_Select(nonzero, Lane_Mul(x, scale), x));
+		Lane_Store(v.y + i, Mask_Select(nonzero, Lane_Mul(y, scale), y));
+		Lane_Store(v.z + i, Mask_Select(nonzero, Lane_Mul(z, scale), z));
+
+		if (lengths)
+			Lane_Store(lengths + i, length);
+	}
+#endif
+
+	Normalize_Scalar(v, lengths, i);
+}
+
+/*
+==============
+BenchmarkVectorBatch
+==============
+*/
+struct bench_lanes
+{
+	dynarray<float> x, y, z;
+
+	inline bench_lanes(const size_t &count) :
+		x(count),
+		y(count),
+		z(count)
+	{
+	}
+
+	inline operator vector_lanes() { return { x.data(), y.data(), z.data(), x.size() }; }
+};
+
+void BenchmarkVectorBatch(size_t count)
+{
+	using clock = std::chrono::steady_clock;
+
+	// a private stream, so benchmarking doesn't disturb the game's
+	rng_stream rng(1);
+
+	bench_lanes points(count), mins(count), maxs(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		// some exact zeroes for normalize to skip
+		if (!(i % 97))
+			points.x[i] = points.y[i] = points.z[i] = 0;
+		else
+		{
+			points.x[i] = rng.random(-4096.f, 4096.f);
+			points.y[i] = rng.random(-4096.f, 4096.f);
+			points.z[i] = rng.random(-4096.f, 4096.f);
+		}
+
+		const vector size { rng.random(8.f, 128.f), rng.random(8.f, 128.f), rng.random(8.f, 128.f) };
+		mins.x[i] = points.x[i] - size.x;
+		mins.y[i] = points.y[i] - size.y;
+		mins.z[i] = points.z[i] - size.z;
+		maxs.x[i] = points.x[i] + size.x;
+		maxs.y[i] = points.y[i] + size.y;
+		maxs.z[i] = points.z[i] + size.z;
+	}
+
+	const vector point { 100.f, -250.f, 32.f };
+	const vector box_mins { -512.f, -512.f, -128.f }, box_maxs { 512.f, 512.f, 128.f };
+	constexpr float radius = 512.f;
+
+	auto us = [](clock::time_point start) {
+		return std::chrono::duration<double, std::micro>(clock::now() - start).count();
+	};
+	auto same = [](const dynarray<float> &a, const dynarray<float> &b) {
+		return !memcmp(a.data(), b.data(), a.size() * sizeof(float));
+	};
+
+	gi.dprintf("vector batch, %u vectors, %s; microseconds\n", (uint32_t)count,
+#if defined(VECTOR_BATCH_SSE2)
+		"SSE2"
+#elif defined(VECTOR_BATCH_NEON)
+		"NEON"
+#else
+		"scalar only"
+#endif
+	);
+	gi.dprintf("%-14s %10s %10s  %s\n", "", "scalar", "batch", "match");
+
+	// distance squared
+	{
+		dynarray<float> scalar(count), batch(count);
+
+		auto start = clock::now();
+		DistanceSquared_Scalar(points, point, scalar.data(), 0);
+		const double scalar_us = us(start);
+
+		start = clock::now();
+		VectorBatch_DistanceSquared(points, point, batch.data());
+		const double batch_us = us(start);
+
+		gi.dprintf("%-14s %10.1f %10.1f  %s\n", "distance sq", scalar_us, batch_us, same(scalar, batch) ? "yes" : "NO");
+	}
+
+	// radius search, walked like a findradius loop, in 3d and 2d
+	for (const bool ignore_height : { false, true })
+	{
+		const vector_lanes lanes = points;
+		dynarray<size_t> scalar, batch;
+
+		auto start = clock::now();
+		for (size_t i = FindInRadius_Scalar(lanes, point, radius, ignore_height, 0); i < count; i = FindInRadius_Scalar(lanes, point, radius, ignore_height, i + 1))
+			scalar.push_back(i);
+		const double scalar_us = us(start);
+
+		start = clock::now();
+		for (size_t i = 0; ; i++)
+		{
+			const vector_lanes rest { lanes.x + i, lanes.y + i, lanes.z + i, count - i };
+			const size_t found = VectorBatch_FindInRadius(rest, point, radius, ignore_height);
+
+			if (found == rest.count)
+				break;
+
+			i += found;
+			batch.push_back(i);
+		}
+		const double batch_us = us(start);
+
+		gi.dprintf("%-14s %10.1f %10.1f  %s (%u hits)\n", ignore_height ? "in radius 2d" : "in radius", scalar_us, batch_us,
+			scalar == batch ? "yes" : "NO", (uint32_t)scalar.size());
+	}
+
+	// box overlap
+	{
+		dynarray<uint8_t> scalar(count), batch(count);
+
+		auto start = clock::now();
+		const size_t scalar_num = BoxesOverlap_Scalar(mins, maxs, box_mins, box_maxs, scalar.data(), 0);
+		const double scalar_us = us(start);
+
+		start = clock::now();
+		const size_t batch_num = VectorBatch_BoxesOverlap(mins, maxs, box_mins, box_maxs, batch.data());
+		const double batch_us = us(start);
+
+		gi.dprintf("%-14s %10.1f %10.1f  %s (%u hits)\n", "box overlap", scalar_us, batch_us,
+			(scalar == batch && scalar_num == batch_num) ? "yes" : "NO", (uint32_t)scalar_num);
+	}
+
+	// normalize; works on copies, since it's in place
+	{
+		bench_lanes scalar = points, batch = points;
+		dynarray<float> scalar_lengths(count), batch_lengths(count);
+
+		auto start = clock::now();
+		Normalize_Scalar(scalar, scalar_lengths.data(), 0);
+		const double scalar_us = us(start);
+
+		start = clock::now();
+		VectorBatch_Normalize(batch, batch_lengths.data());
+		const double batch_us = us(start);
+
+		const bool match = same(scalar.x, batch.x) && same(scalar.y, batch.y) && same(scalar.z, batch.z) && same(scalar_lengths, batch_lengths);
+		gi.dprintf("%-14s %10.1f %10.1f  %s\n", "normalize", scalar_us, batch_us, match ? "yes" : "NO");
+	}
+}
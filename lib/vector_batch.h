@@ -0,0 +1,74 @@
+#pragma once
+
+#include "types.h"
+
+/*
+==============
+batch vector kernels
+
+These run one operation over many vectors at a time, four lanes at once
+with SSE2 or NEON when SIMD_VECTORS is enabled. The vectors are kept as
+separate x, y and z lanes so four of each load straight into a register
+instead of being shuffled out of 12-byte vectors.
+
+Each kernel does the same float operations in the same order as the scalar
+code it stands in for; sqrt and divide are correctly rounded in both, so as
+long as the compiler isn't allowed to contract multiplies and adds into
+FMAs (MSVC doesn't by default) the results are bit-identical to the scalar
+path. "sv benchvec" checks that and times the two.
+==============
+*/
+
+// a view of vectors stored as lanes
+struct vector_lanes
+{
+	float	*x, *y, *z;
+	size_t	count;
+};
+
+// fixed-capacity batch of vectors stored as lanes. push vectors
+// until it's full, then hand it to the kernels.
+template<size_t N>
+struct vector_batch
+{
+	static_assert(N && !(N % 4), "batch capacity must be a multiple of 4");
+
+	alignas(16) array<float, N>	x, y, z;
+	size_t						count = 0;
+
+	inline bool full() const { return count == N; }
+	inline void clear() { count = 0; }
+
+	inline void push(const vector &v)
+	{
+		x[count] = v.x;
+		y[count] = v.y;
+		z[count] = v.z;
+		count++;
+	}
+
+	inline vector operator[](const size_t &index) const { return { x[index], y[index], z[index] }; }
+
+	inline operator vector_lanes() { return { x.data(), y.data(), z.data(), count }; }
+};
+
+// store the squared distance between each vector and point in out
+void VectorBatch_DistanceSquared(const vector_lanes &v, const vector &point, float *out);
+
+// fetch the index of the first vector within radius of point, testing
+// the distance the way findradius does, or v.count if none are.
+// ignore_height measures in the XY plane only, making it a cylinder.
+size_t VectorBatch_FindInRadius(const vector_lanes &v, const vector &point, const float &radius, const bool &ignore_height = false);
+
+// store in overlaps whether each box (mins, maxs) overlaps the box
+// (box_mins, box_maxs); boxes that only touch don't count. returns
+// the number of boxes that overlap.
+size_t VectorBatch_BoxesOverlap(const vector_lanes &mins, const vector_lanes &maxs, const vector &box_mins, const vector &box_maxs, uint8_t *overlaps);
+
+// normalize each vector in place like vector::Normalize, storing
+// their old lengths in lengths if it's not null
+void VectorBatch_Normalize(const vector_lanes &v, float *lengths = nullptr);
+
+// "sv benchvec [count]"; checks the kernels against their scalar
+// versions and times both
+void BenchmarkVectorBatch(size_t count);
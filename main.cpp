@@ -2,11 +2,15 @@
 #include "lib/gi.h"
 #include "lib/entity.h"
 #include "lib/info.h"
+#include "lib/entity_mirror.h"
 #include "game/player.h"
 #include "game/game.h"
 #include "game/cmds.h"
 #include "game/svcmds.h"
 #include "game/spawn.h"
+#include "game/replay.h"
+#include "game/profile.h"
+#include "lib/random.h"
 
 static void WipeEntities()
 {
@@ -32,6 +36,11 @@ extern "C" struct game_export
 
 		WipeEntities();
 
+		bool fixed_seed;
+		const uint32_t seed = Replay_LevelSeed(fixed_seed);
+		Q_srand(seed);
+		Replay_SpawnEntities(seed, fixed_seed, mapname, entstring, spawnpoint);
+
 		::SpawnEntities(mapname, entstring, spawnpoint);
 	};
 
@@ -57,6 +66,8 @@ extern "C" struct game_export
 
 	qboolean (*ClientConnect)(entity *ent, char *userinfo) = [](entity *ent, char *userinfo)
 	{
+		Replay_ClientConnect(*ent, userinfo);
+
 		string ui(userinfo);
 		
 		const qboolean success = ::ClientConnect(*ent, ui);
@@ -67,28 +78,40 @@ extern "C" struct game_export
 	};
 	void (*ClientBegin)(entity *ent) = [](entity *ent)
 	{
+		Replay_ClientBegin(*ent);
 		::ClientBegin(*ent);
 	};
 	void (*ClientUserinfoChanged)(entity *ent, char *userinfo) = [](entity *ent, char *userinfo)
 	{
+		Replay_ClientUserinfoChanged(*ent, userinfo);
 		::ClientUserinfoChanged(*ent, userinfo);
 	};
 	void (*ClientDisconnect)(entity *ent) = [](entity *ent)
 	{
+		Replay_ClientDisconnect(*ent);
 		::ClientDisconnect(*ent);
 	};
 	void (*ClientCommand)(entity *ent) = [](entity *ent)
 	{
+		Replay_ClientCommand(*ent);
 		::ClientCommand(*ent);
 	};
 	void (*ClientThink)(entity *ent, usercmd *cmd) = [](entity *ent, usercmd *cmd)
 	{
+		Replay_ClientThink(*ent, *cmd);
 		::ClientThink(*ent, *cmd);
 	};
 
 	void (*RunFrame)() = []()
 	{
+		Replay_RunFrame();
 		::RunFrame();
+#ifdef PROFILE
+		Profile_EndFrame();
+#endif
+#ifdef ENGINE_CALL_STATS
+		EngineCalls_EndFrame();
+#endif
 	};
 
 	// ServerCommand will be called when an "sv <command>" command is issued on the
@@ -97,6 +120,7 @@ extern "C" struct game_export
 	// of the parameters
 	void (*ServerCommand)() = []()
 	{
+		Replay_ServerCommand();
 		::ServerCommand();
 	};
 
@@ -123,6 +147,7 @@ void entity::__init()
 	new(this) entity();
 	this->s.number = this - ge.edicts;
 	this->client = cl;
+	Mirror_Update(*this);
 }
 
 void entity::__free()
@@ -132,6 +157,7 @@ void entity::__free()
 	memset(this, 0, sizeof(*this));
 	this->s.number = this - ge.edicts;
 	this->client = cl;
+	Mirror_Update(*this);
 }
 
 entity &itoe(size_t index)